@@ -31,6 +31,8 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/unistd.h>
@@ -42,6 +44,13 @@
 #define DAQ_NAME "file"
 #define DAQ_TYPE (DAQ_TYPE_FILE_CAPABLE|DAQ_TYPE_INTF_CAPABLE|DAQ_TYPE_MULTI_INSTANCE)
 #define FILE_BUF_SZ 16384
+#define READAHEAD_SZ (4 * 1024 * 1024)
+
+// pcap file format; see pcap-savefile(5)
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+#define PCAP_FILE_HDR_SZ 24
+#define PCAP_REC_HDR_SZ 16
 
 typedef struct {
     char* name;
@@ -53,6 +62,22 @@ typedef struct {
 
     unsigned snaplen;
 
+    // mmap mode: packets point into the mapping instead of buf
+    int use_mmap;
+    int pcap;
+    int swapped;
+    int nsec;
+    int dlt;
+
+    const uint8_t* map;
+    size_t map_sz;
+    size_t pos;
+    size_t advised;
+    size_t readahead;
+
+    const uint8_t* data;
+    DAQ_PktHdr_t hdr;
+
     uint8_t* buf;
     char error[DAQ_ERRBUF_SIZE];
 
@@ -65,8 +90,122 @@ typedef struct {
 // file functions
 //-------------------------------------------------------------------------
 
+static uint32_t get32(const FileImpl* impl, const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return impl->swapped ? __builtin_bswap32(v) : v;
+}
+
+static int pcap_setup(FileImpl* impl)
+{
+    uint32_t magic;
+
+    if ( impl->map_sz < PCAP_FILE_HDR_SZ )
+    {
+        DPE(impl->error, "%s: %s is not a pcap file\n", DAQ_NAME, impl->name);
+        return -1;
+    }
+    memcpy(&magic, impl->map, sizeof(magic));
+
+    if ( magic == PCAP_MAGIC || magic == PCAP_MAGIC_NSEC )
+        impl->swapped = 0;
+
+    else if ( __builtin_bswap32(magic) == PCAP_MAGIC ||
+        __builtin_bswap32(magic) == PCAP_MAGIC_NSEC )
+    {
+        impl->swapped = 1;
+        magic = __builtin_bswap32(magic);
+    }
+    else
+    {
+        DPE(impl->error, "%s: %s is not a pcap file\n", DAQ_NAME, impl->name);
+        return -1;
+    }
+    impl->nsec = (magic == PCAP_MAGIC_NSEC);
+    impl->dlt = (int)get32(impl, impl->map + 20);
+    impl->pos = PCAP_FILE_HDR_SZ;
+
+    return 0;
+}
+
+static int map_setup(FileImpl* impl)
+{
+    struct stat st;
+
+    if ( fstat(impl->fid, &st) )
+    {
+        DPE(impl->error, "%s: can't stat file (%s)\n", DAQ_NAME, strerror(errno));
+        return -1;
+    }
+    impl->map_sz = (size_t)st.st_size;
+    impl->pos = impl->advised = 0;
+
+    // mmap rejects zero length; an empty file is just eof
+    if ( impl->map_sz )
+    {
+        void* p = mmap(NULL, impl->map_sz, PROT_READ, MAP_PRIVATE, impl->fid, 0);
+
+        if ( p == MAP_FAILED )
+        {
+            DPE(impl->error, "%s: can't map file (%s)\n", DAQ_NAME, strerror(errno));
+            return -1;
+        }
+        impl->map = (const uint8_t*)p;
+
+        // advice is best effort; the kernel may not support huge pages for files
+        madvise(p, impl->map_sz, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+        madvise(p, impl->map_sz, MADV_HUGEPAGE);
+#endif
+    }
+
+    // the mapping holds its own reference to the file
+    close(impl->fid);
+    impl->fid = -1;
+
+    if ( impl->pcap && pcap_setup(impl) )
+        return -1;
+
+    return 0;
+}
+
+static void map_cleanup(FileImpl* impl)
+{
+    if ( impl->map )
+        munmap((void*)impl->map, impl->map_sz);
+
+    impl->map = NULL;
+    impl->map_sz = 0;
+}
+
+// keep the next window faulted in ahead of the cursor
+static void map_readahead(FileImpl* impl)
+{
+    if ( !impl->readahead || impl->advised >= impl->map_sz ||
+        impl->pos + impl->readahead / 2 < impl->advised )
+        return;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t off = impl->advised > impl->pos ? impl->advised : impl->pos;
+    off &= ~(page - 1);
+
+    size_t len = impl->readahead;
+
+    if ( off + len > impl->map_sz )
+        len = impl->map_sz - off;
+
+    madvise((void*)(impl->map + off), len, MADV_WILLNEED);
+    impl->advised = off + len;
+}
+
 static int file_setup(FileImpl* impl)
 {
+    if ( impl->use_mmap && !strcmp(impl->name, "tty") )
+    {
+        DPE(impl->error, "%s: can't map tty\n", DAQ_NAME);
+        return -1;
+    }
     if ( !strcmp(impl->name, "tty") )
     {
         impl->fid = STDIN_FILENO;
@@ -79,6 +218,9 @@ static int file_setup(FileImpl* impl)
     }
     impl->start = 1;
 
+    if ( impl->use_mmap )
+        return map_setup(impl);
+
     return 0;
 }
 
@@ -88,6 +230,7 @@ static void file_cleanup(FileImpl* impl)
         close(impl->fid);
 
     impl->fid = -1;
+    map_cleanup(impl);
 }
 
 static int file_read(FileImpl* impl)
@@ -113,21 +256,89 @@ static int file_read(FileImpl* impl)
         }
         return DAQ_ERROR;
     }
+    impl->data = impl->buf;
     return n;
 }
 
+// same chunking and eof semantics as file_read w/o the copy
+static int file_map_read(FileImpl* impl)
+{
+    static const uint8_t eof_byte = 0;
+
+    if ( impl->pos >= impl->map_sz )
+    {
+        if ( !impl->eof )
+        {
+            impl->eof = 1;
+
+            if ( !impl->data )
+                impl->data = &eof_byte;
+
+            return 1;
+        }
+        return DAQ_READFILE_EOF;
+    }
+    size_t n = impl->map_sz - impl->pos;
+
+    if ( n > impl->snaplen )
+        n = impl->snaplen;
+
+    impl->data = impl->map + impl->pos;
+    impl->pos += n;
+
+    return (int)n;
+}
+
+static int pcap_map_read(FileImpl* impl)
+{
+    if ( impl->pos + PCAP_REC_HDR_SZ > impl->map_sz )
+        return DAQ_READFILE_EOF;
+
+    const uint8_t* rec = impl->map + impl->pos;
+    uint32_t caplen = get32(impl, rec + 8);
+
+    if ( caplen > impl->map_sz - impl->pos - PCAP_REC_HDR_SZ )
+    {
+        // truncated trailing record, as when a capture is cut short
+        impl->pos = impl->map_sz;
+        return DAQ_READFILE_EOF;
+    }
+    DAQ_PktHdr_t* phdr = &impl->hdr;
+
+    phdr->ts.tv_sec = get32(impl, rec);
+    phdr->ts.tv_usec = get32(impl, rec + 4);
+
+    if ( impl->nsec )
+        phdr->ts.tv_usec /= 1000;
+
+    phdr->pktlen = get32(impl, rec + 12);
+    phdr->caplen = caplen < impl->snaplen ? caplen : impl->snaplen;
+
+    impl->data = rec + PCAP_REC_HDR_SZ;
+    impl->pos += PCAP_REC_HDR_SZ + caplen;
+
+    return phdr->caplen ? (int)phdr->caplen : 1;
+}
+
 //-------------------------------------------------------------------------
 // daq utilities
 //-------------------------------------------------------------------------
 
 static void set_pkt_hdr(FileImpl* impl, DAQ_PktHdr_t* phdr, ssize_t len)
 {
-    struct timeval t;
-    gettimeofday(&t, NULL);
+    if ( !impl->pcap )
+    {
+        // mmap mode stamps once per acquire batch
+        if ( !impl->use_mmap )
+        {
+            struct timeval t;
+            gettimeofday(&t, NULL);
 
-    phdr->ts.tv_sec = t.tv_sec;
-    phdr->ts.tv_usec = t.tv_usec;
-    phdr->caplen = phdr->pktlen = len;
+            phdr->ts.tv_sec = t.tv_sec;
+            phdr->ts.tv_usec = t.tv_usec;
+        }
+        phdr->caplen = phdr->pktlen = len;
+    }
 
     phdr->ingress_index = phdr->egress_index = -1;
     phdr->ingress_group = phdr->egress_group = -1;
@@ -136,6 +347,12 @@ static void set_pkt_hdr(FileImpl* impl, DAQ_PktHdr_t* phdr, ssize_t len)
     phdr->address_space_id = 0;
     phdr->opaque = 0;
 
+    if ( impl->pcap )
+    {
+        phdr->priv_ptr = NULL;
+        return;
+    }
+
     if ( impl->start )
     {
         impl->pci.flags = DAQ_USR_FLAG_START_FLOW;
@@ -153,14 +370,26 @@ static void set_pkt_hdr(FileImpl* impl, DAQ_PktHdr_t* phdr, ssize_t len)
 static int file_daq_process(
     FileImpl* impl, DAQ_Analysis_Func_t cb, void* user)
 {
-    DAQ_PktHdr_t hdr;
-    int n = file_read(impl);
+    DAQ_PktHdr_t* hdr = &impl->hdr;
+    int n;
+
+    if ( impl->use_mmap )
+        map_readahead(impl);
+
+    if ( impl->pcap )
+        n = pcap_map_read(impl);
+
+    else if ( impl->use_mmap )
+        n = file_map_read(impl);
+
+    else
+        n = file_read(impl);
 
     if ( n < 1 )
         return n;
 
-    set_pkt_hdr(impl, &hdr, n);
-    DAQ_Verdict verdict = cb(user, &hdr, impl->buf);
+    set_pkt_hdr(impl, hdr, n);
+    DAQ_Verdict verdict = cb(user, hdr, impl->data);
 
     if ( verdict >= MAX_DAQ_VERDICT )
         verdict = DAQ_VERDICT_BLOCK;
@@ -173,6 +402,41 @@ static int file_daq_process(
 // daq
 //-------------------------------------------------------------------------
 
+static int get_vars (
+    FileImpl* impl, const DAQ_Config_t* cfg, char* errBuf, size_t errMax
+) {
+    DAQ_Dict* entry;
+
+    for ( entry = cfg->values; entry; entry = entry->next)
+    {
+        if ( !strcmp(entry->key, "mmap") )
+            impl->use_mmap = 1;
+
+        else if ( !strcmp(entry->key, "pcap") )
+            impl->use_mmap = impl->pcap = 1;
+
+        else if ( !strcmp(entry->key, "readahead") )
+        {
+            char* end = NULL;
+            unsigned long n = entry->value ? strtoul(entry->value, &end, 0) : 0;
+
+            if ( !entry->value || *end )
+            {
+                snprintf(errBuf, errMax, "%s: bad readahead (%s)", DAQ_NAME,
+                    entry->value ? entry->value : "");
+                return 0;
+            }
+            impl->readahead = n;
+        }
+        else
+        {
+            snprintf(errBuf, errMax, "%s: unknown var (%s)", DAQ_NAME, entry->key);
+            return 0;
+        }
+    }
+    return 1;
+}
+
 static void file_daq_shutdown (void* handle)
 {
     FileImpl* impl = (FileImpl*)handle;
@@ -202,6 +466,14 @@ static int file_daq_initialize (
     impl->fid = -1;
     impl->start = impl->stop = 0;
     impl->snaplen = cfg->snaplen ? cfg->snaplen : FILE_BUF_SZ;
+    impl->readahead = READAHEAD_SZ;
+    impl->dlt = DLT_USER;
+
+    if ( !get_vars(impl, cfg, errBuf, errMax) )
+    {
+        free(impl);
+        return DAQ_ERROR;
+    }
 
     if ( cfg->name )
     {
@@ -213,7 +485,7 @@ static int file_daq_initialize (
         }
     }
 
-    if ( !(impl->buf = malloc(impl->snaplen)) )
+    if ( !impl->use_mmap && !(impl->buf = malloc(impl->snaplen)) )
     {
         snprintf(errBuf, errMax, "%s: failed to allocate the ipfw buffer", DAQ_NAME);
         file_daq_shutdown(impl);
@@ -272,6 +544,15 @@ static int file_daq_acquire (
     int hit = 0, miss = 0;
     impl->stop = 0;
 
+    if ( impl->use_mmap && !impl->pcap )
+    {
+        // no syscalls per packet; raw chunks share the batch timestamp
+        struct timeval t;
+        gettimeofday(&t, NULL);
+        impl->hdr.ts.tv_sec = t.tv_sec;
+        impl->hdr.ts.tv_usec = t.tv_usec;
+    }
+
     while ( (hit < cnt || cnt <= 0) && !impl->stop )
     {
         int status = file_daq_process(impl, callback, user);
@@ -333,8 +614,8 @@ static uint32_t file_daq_get_capabilities (void* handle)
 
 static int file_daq_get_datalink_type(void *handle)
 {
-    (void)handle;
-    return DLT_USER;
+    FileImpl* impl = (FileImpl*)handle;
+    return impl->dlt;
 }
 
 static const char* file_daq_get_errbuf (void* handle)
@@ -0,0 +1,751 @@
+/*--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+*/
+/* daq_shard.c */
+
+/*
+ * reads one pcap with one reader thread and spreads the packets across
+ * all packet threads by a symmetric hash of the addresses (and optionally
+ * the ports).  each instance is fed through its own single producer single
+ * consumer ring so all packets of a flow are processed in capture order by
+ * the same thread.  when the reader hits the end of the file, each instance
+ * drains its ring and then returns DAQ_READFILE_EOF.
+ *
+ * usage: snort --daq shard -i <file.pcap> -z <threads>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <daq_api.h>
+#include <pcap.h>
+#include <sfbpf_dlt.h>
+
+#define DAQ_MOD_VERSION 0
+#define DAQ_NAME "shard"
+#define DAQ_TYPE (DAQ_TYPE_INTF_CAPABLE|DAQ_TYPE_MULTI_INSTANCE)
+
+#define DEF_DEPTH 1024      /* packets per ring, must be a power of 2 */
+#define DEF_TIMEOUT 1000    /* msecs */
+#define IDLE_USECS 50
+#define CACHE_LINE 64
+
+#ifndef DLT_IPV4
+#define DLT_IPV4 228
+#endif
+#ifndef DLT_IPV6
+#define DLT_IPV6 229
+#endif
+
+typedef struct {
+    DAQ_PktHdr_t hdr;
+    uint8_t* data;
+} ShardPkt;
+
+/* head is only written by the reader and tail only by the instance */
+typedef struct {
+    unsigned head;
+    char pad1[CACHE_LINE - sizeof(unsigned)];
+    unsigned tail;
+    char pad2[CACHE_LINE - sizeof(unsigned)];
+    unsigned mask;
+    ShardPkt* slots;
+    uint8_t* bufs;
+} ShardRing;
+
+/* shared by all instances */
+typedef struct {
+    char* name;
+    pcap_t* pcap;
+    int dlt;
+
+    unsigned shards;
+    unsigned depth;
+    unsigned snaplen;
+    bool hash_ports;
+
+    ShardRing* rings;
+
+    unsigned refs;
+    unsigned started;
+
+    pthread_t reader;
+    bool running;
+    bool failed;
+    int eof;
+    int quit;
+
+    char error[DAQ_ERRBUF_SIZE];
+} ShardReader;
+
+typedef struct {
+    ShardReader* reader;
+    ShardRing* ring;
+    unsigned id;
+    unsigned timeout;
+    int stop;
+    char error[DAQ_ERRBUF_SIZE];
+    DAQ_State state;
+    DAQ_Stats_t stats;
+} ShardImpl;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static ShardReader* s_reader = NULL;
+
+//-------------------------------------------------------------------------
+// flow hash
+//-------------------------------------------------------------------------
+
+static uint32_t hash_bytes(uint32_t h, const uint8_t* p, unsigned n)
+{
+    unsigned i;
+
+    for ( i = 0; i < n; ++i )
+        h = (h ^ p[i]) * 16777619;
+
+    return h;
+}
+
+/* hash the endpoints in a fixed order so both directions match */
+static uint32_t hash_flow(
+    const uint8_t* a, const uint8_t* b, unsigned n, const uint8_t* ports, uint8_t proto)
+{
+    uint32_t h = 2166136261u;
+    int swap = memcmp(a, b, n) > 0;
+
+    if ( !swap && ports && memcmp(a, b, n) == 0 )
+        swap = memcmp(ports, ports + 2, 2) > 0;
+
+    h = hash_bytes(h, swap ? b : a, n);
+    h = hash_bytes(h, swap ? a : b, n);
+
+    if ( ports )
+    {
+        h = hash_bytes(h, swap ? ports + 2 : ports, 2);
+        h = hash_bytes(h, swap ? ports : ports + 2, 2);
+    }
+    h = hash_bytes(h, &proto, 1);
+
+    /* fnv leaves the low bits poorly mixed */
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    return h ^ (h >> 16);
+}
+
+static bool has_ports(uint8_t proto)
+{ return proto == 6 || proto == 17 || proto == 132; }
+
+static uint32_t hash_ip(ShardReader* r, const uint8_t* p, unsigned len)
+{
+    if ( len < 1 )
+        return 0;
+
+    if ( (p[0] >> 4) == 4 )
+    {
+        unsigned hlen = (p[0] & 0x0F) * 4;
+
+        if ( len < 20 || hlen < 20 )
+            return 0;
+
+        uint8_t proto = p[9];
+        bool frag = ((p[6] << 8) | p[7]) & 0x3FFF;
+        const uint8_t* ports = NULL;
+
+        if ( r->hash_ports && !frag && has_ports(proto) && len >= hlen + 4 )
+            ports = p + hlen;
+
+        return hash_flow(p + 12, p + 16, 4, ports, proto);
+    }
+    if ( (p[0] >> 4) == 6 )
+    {
+        if ( len < 40 )
+            return 0;
+
+        /* extension headers (including fragments) are hashed by address */
+        uint8_t proto = p[6];
+        const uint8_t* ports = NULL;
+
+        if ( r->hash_ports && has_ports(proto) && len >= 44 )
+            ports = p + 40;
+
+        return hash_flow(p + 8, p + 24, 16, ports, proto);
+    }
+    return 0;
+}
+
+static uint32_t hash_packet(ShardReader* r, const uint8_t* p, unsigned len)
+{
+    unsigned off;
+    uint16_t type;
+
+    switch ( r->dlt )
+    {
+    case DLT_EN10MB:
+        off = 12;
+
+        for ( ;; )
+        {
+            if ( len < off + 2 )
+                return 0;
+
+            type = (p[off] << 8) | p[off + 1];
+
+            if ( type != 0x8100 && type != 0x88A8 && type != 0x9100 )
+                break;
+
+            off += 4;
+        }
+        off += 2;
+        break;
+
+    case DLT_LINUX_SLL:
+        if ( len < 16 )
+            return 0;
+
+        type = (p[14] << 8) | p[15];
+        off = 16;
+        break;
+
+    case DLT_NULL:
+    case DLT_LOOP:
+        return len > 4 ? hash_ip(r, p + 4, len - 4) : 0;
+
+    case DLT_RAW:
+    case DLT_IPV4:
+    case DLT_IPV6:
+        return hash_ip(r, p, len);
+
+    default:
+        return 0;
+    }
+
+    if ( type != 0x0800 && type != 0x86DD )
+        return 0;
+
+    return hash_ip(r, p + off, len - off);
+}
+
+//-------------------------------------------------------------------------
+// reader
+//-------------------------------------------------------------------------
+
+static void* reader_main(void* arg)
+{
+    ShardReader* r = (ShardReader*)arg;
+    struct pcap_pkthdr* ph;
+    const u_char* data;
+    int rval = 0;
+
+    while ( !__atomic_load_n(&r->quit, __ATOMIC_ACQUIRE) &&
+        (rval = pcap_next_ex(r->pcap, &ph, &data)) >= 0 )
+    {
+        if ( !rval )
+            continue;
+
+        ShardRing* ring = r->rings + (hash_packet(r, data, ph->caplen) % r->shards);
+        unsigned head = ring->head;
+
+        /* wait for room rather than drop so results are repeatable */
+        while ( head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) > ring->mask )
+        {
+            if ( __atomic_load_n(&r->quit, __ATOMIC_ACQUIRE) )
+                break;
+
+            usleep(IDLE_USECS);
+        }
+        if ( __atomic_load_n(&r->quit, __ATOMIC_ACQUIRE) )
+            break;
+
+        ShardPkt* pkt = ring->slots + (head & ring->mask);
+        unsigned caplen = ph->caplen < r->snaplen ? ph->caplen : r->snaplen;
+
+        memcpy(pkt->data, data, caplen);
+
+        pkt->hdr.ts = ph->ts;
+        pkt->hdr.caplen = caplen;
+        pkt->hdr.pktlen = ph->len;
+
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    if ( rval == -1 )
+    {
+        DPE(r->error, "%s: can't read %s (%s)\n", DAQ_NAME, r->name, pcap_geterr(r->pcap));
+        r->failed = true;
+    }
+
+    /* all packets are visible before eof */
+    __atomic_store_n(&r->eof, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void reader_free(ShardReader* r)
+{
+    unsigned i;
+
+    if ( r->running )
+    {
+        __atomic_store_n(&r->quit, 1, __ATOMIC_RELEASE);
+        pthread_join(r->reader, NULL);
+    }
+    if ( r->rings )
+    {
+        for ( i = 0; i < r->shards; ++i )
+        {
+            free(r->rings[i].slots);
+            free(r->rings[i].bufs);
+        }
+        free(r->rings);
+    }
+    if ( r->pcap )
+        pcap_close(r->pcap);
+
+    free(r->name);
+    free(r);
+}
+
+static int get_vars(ShardReader* r, const DAQ_Config_t* cfg, char* errBuf, size_t errMax)
+{
+    DAQ_Dict* entry;
+
+    for ( entry = cfg->values; entry; entry = entry->next)
+    {
+        if ( !strcmp(entry->key, "shards") && entry->value )
+            r->shards = strtoul(entry->value, NULL, 0);
+
+        else if ( !strcmp(entry->key, "depth") && entry->value )
+            r->depth = strtoul(entry->value, NULL, 0);
+
+        else if ( !strcmp(entry->key, "hash") && entry->value && !strcmp(entry->value, "flow") )
+            r->hash_ports = true;
+
+        else if ( !strcmp(entry->key, "hash") && entry->value && !strcmp(entry->value, "ip") )
+            r->hash_ports = false;
+
+        else
+        {
+            snprintf(errBuf, errMax, "%s: unknown var (%s)", DAQ_NAME, entry->key);
+            return 0;
+        }
+    }
+    if ( !r->shards )
+    {
+        snprintf(errBuf, errMax, "%s: shards must be set", DAQ_NAME);
+        return 0;
+    }
+    if ( !r->depth || (r->depth & (r->depth - 1)) )
+    {
+        snprintf(errBuf, errMax, "%s: depth must be a power of 2", DAQ_NAME);
+        return 0;
+    }
+    return 1;
+}
+
+static ShardReader* reader_new(const DAQ_Config_t* cfg, char* errBuf, size_t errMax)
+{
+    char pcap_err[PCAP_ERRBUF_SIZE];
+    unsigned i;
+
+    ShardReader* r = calloc(1, sizeof(*r));
+
+    if ( !r )
+    {
+        snprintf(errBuf, errMax, "%s: failed to allocate the reader", DAQ_NAME);
+        return NULL;
+    }
+    r->depth = DEF_DEPTH;
+    r->snaplen = cfg->snaplen;
+
+    if ( !get_vars(r, cfg, errBuf, errMax) )
+    {
+        reader_free(r);
+        return NULL;
+    }
+    if ( !(r->name = strdup(cfg->name)) )
+    {
+        snprintf(errBuf, errMax, "%s: failed to allocate the filename", DAQ_NAME);
+        reader_free(r);
+        return NULL;
+    }
+    if ( !(r->pcap = pcap_open_offline(r->name, pcap_err)) )
+    {
+        snprintf(errBuf, errMax, "%s: can't open %s (%s)", DAQ_NAME, r->name, pcap_err);
+        reader_free(r);
+        return NULL;
+    }
+    r->dlt = pcap_datalink(r->pcap);
+
+    if ( !(r->rings = calloc(r->shards, sizeof(*r->rings))) )
+    {
+        snprintf(errBuf, errMax, "%s: failed to allocate the rings", DAQ_NAME);
+        reader_free(r);
+        return NULL;
+    }
+    for ( i = 0; i < r->shards; ++i )
+    {
+        ShardRing* ring = r->rings + i;
+        unsigned j;
+
+        ring->mask = r->depth - 1;
+        ring->slots = calloc(r->depth, sizeof(*ring->slots));
+        ring->bufs = malloc((size_t)r->depth * r->snaplen);
+
+        if ( !ring->slots || !ring->bufs )
+        {
+            snprintf(errBuf, errMax, "%s: failed to allocate the rings", DAQ_NAME);
+            reader_free(r);
+            return NULL;
+        }
+        for ( j = 0; j < r->depth; ++j )
+        {
+            DAQ_PktHdr_t* h = &ring->slots[j].hdr;
+            ring->slots[j].data = ring->bufs + (size_t)j * r->snaplen;
+
+            h->ingress_index = h->egress_index = -1;
+            h->ingress_group = h->egress_group = -1;
+        }
+    }
+    return r;
+}
+
+//-------------------------------------------------------------------------
+// daq
+//-------------------------------------------------------------------------
+
+static void shard_daq_shutdown (void* handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+
+    pthread_mutex_lock(&s_lock);
+
+    if ( impl->reader && !--impl->reader->refs )
+    {
+        reader_free(impl->reader);
+        s_reader = NULL;
+    }
+    pthread_mutex_unlock(&s_lock);
+    free(impl);
+}
+
+//-------------------------------------------------------------------------
+
+static int shard_daq_initialize (
+    const DAQ_Config_t* cfg, void** handle, char* errBuf, size_t errMax)
+{
+    if ( !cfg->name || !*cfg->name )
+    {
+        snprintf(errBuf, errMax, "%s: a pcap file is required", DAQ_NAME);
+        return DAQ_ERROR_INVAL;
+    }
+
+    ShardImpl* impl = calloc(1, sizeof(*impl));
+
+    if ( !impl )
+    {
+        snprintf(errBuf, errMax, "%s: failed to allocate the shard context", DAQ_NAME);
+        return DAQ_ERROR_NOMEM;
+    }
+    impl->timeout = cfg->timeout ? cfg->timeout : DEF_TIMEOUT;
+
+    pthread_mutex_lock(&s_lock);
+
+    if ( !s_reader && !(s_reader = reader_new(cfg, errBuf, errMax)) )
+    {
+        pthread_mutex_unlock(&s_lock);
+        free(impl);
+        return DAQ_ERROR;
+    }
+    if ( strcmp(s_reader->name, cfg->name) || s_reader->refs >= s_reader->shards )
+    {
+        snprintf(errBuf, errMax, "%s: all instances must read the same file "
+            "and there must be no more than %u", DAQ_NAME, s_reader->shards);
+        pthread_mutex_unlock(&s_lock);
+        free(impl);
+        return DAQ_ERROR_INVAL;
+    }
+    impl->reader = s_reader;
+    impl->id = s_reader->refs++;
+    impl->ring = s_reader->rings + impl->id;
+
+    pthread_mutex_unlock(&s_lock);
+
+    impl->state = DAQ_STATE_INITIALIZED;
+    *handle = impl;
+
+    return DAQ_SUCCESS;
+}
+
+//-------------------------------------------------------------------------
+
+static int shard_daq_start (void* handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    ShardReader* r = impl->reader;
+    int rval = DAQ_SUCCESS;
+
+    pthread_mutex_lock(&s_lock);
+
+    /* the hash depends on every shard being present */
+    if ( ++r->started == r->shards )
+    {
+        if ( pthread_create(&r->reader, NULL, reader_main, r) )
+        {
+            DPE(impl->error, "%s: can't start reader (%s)\n", DAQ_NAME, strerror(errno));
+            rval = DAQ_ERROR;
+        }
+        else
+            r->running = true;
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    if ( rval == DAQ_SUCCESS )
+        impl->state = DAQ_STATE_STARTED;
+
+    return rval;
+}
+
+static int shard_daq_stop (void* handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+
+    /* any early exit ends the file for everyone instead of stalling the reader */
+    __atomic_store_n(&impl->reader->quit, 1, __ATOMIC_RELEASE);
+    impl->state = DAQ_STATE_STOPPED;
+
+    return DAQ_SUCCESS;
+}
+
+//-------------------------------------------------------------------------
+
+static int shard_daq_inject (
+    void* handle, const DAQ_PktHdr_t* hdr, const uint8_t* buf, uint32_t len,
+    int rev)
+{
+    (void)handle;
+    (void)hdr;
+    (void)buf;
+    (void)len;
+    (void)rev;
+    return DAQ_ERROR;
+}
+
+//-------------------------------------------------------------------------
+
+static int shard_daq_acquire (
+    void* handle, int cnt, DAQ_Analysis_Func_t callback, DAQ_Meta_Func_t meta, void* user)
+{
+    (void)meta;
+
+    ShardImpl* impl = (ShardImpl*)handle;
+    ShardReader* r = impl->reader;
+    ShardRing* ring = impl->ring;
+    unsigned idle = 0;
+    int hit = 0;
+
+    impl->stop = 0;
+
+    while ( (hit < cnt || cnt <= 0) && !impl->stop )
+    {
+        unsigned tail = ring->tail;
+
+        if ( tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) )
+        {
+            if ( __atomic_load_n(&r->eof, __ATOMIC_ACQUIRE) )
+            {
+                if ( tail != __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) )
+                    continue;
+
+                if ( r->failed )
+                {
+                    DPE(impl->error, "%s", r->error);
+                    return DAQ_ERROR;
+                }
+                return DAQ_READFILE_EOF;
+            }
+            /* return periodically so the caller can do idle processing */
+            if ( ++idle * IDLE_USECS >= impl->timeout * 1000 )
+                break;
+
+            usleep(IDLE_USECS);
+            continue;
+        }
+        idle = 0;
+
+        ShardPkt* pkt = ring->slots + (tail & ring->mask);
+        DAQ_Verdict verdict = callback(user, &pkt->hdr, pkt->data);
+
+        if ( verdict >= MAX_DAQ_VERDICT )
+            verdict = DAQ_VERDICT_BLOCK;
+
+        impl->stats.verdicts[verdict]++;
+        impl->stats.hw_packets_received++;
+        impl->stats.packets_received++;
+
+        __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+        hit++;
+    }
+    return DAQ_SUCCESS;
+}
+
+//-------------------------------------------------------------------------
+
+static int shard_daq_breakloop (void* handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    impl->stop = 1;
+    return DAQ_SUCCESS;
+}
+
+static DAQ_State shard_daq_check_status (void* handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    return impl->state;
+}
+
+static int shard_daq_get_stats (void* handle, DAQ_Stats_t* stats)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    *stats = impl->stats;
+    return DAQ_SUCCESS;
+}
+
+static void shard_daq_reset_stats (void* handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    memset(&impl->stats, 0, sizeof(impl->stats));
+}
+
+static int shard_daq_get_snaplen (void* handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    return impl->reader->snaplen;
+}
+
+static uint32_t shard_daq_get_capabilities (void* handle)
+{
+    (void)handle;
+    return DAQ_CAPA_BLOCK | DAQ_CAPA_REPLACE | DAQ_CAPA_BREAKLOOP | DAQ_CAPA_UNPRIV_START |
+        DAQ_CAPA_BPF;
+}
+
+static int shard_daq_get_datalink_type(void *handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    return impl->reader->dlt;
+}
+
+static const char* shard_daq_get_errbuf (void* handle)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    return impl->error;
+}
+
+static void shard_daq_set_errbuf (void* handle, const char* s)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    DPE(impl->error, "%s", s ? s : "");
+}
+
+static int shard_daq_get_device_index(void* handle, const char* device)
+{
+    (void)handle;
+    (void)device;
+    return DAQ_ERROR_NOTSUP;
+}
+
+/* the filter applies to the shared reader so it can only be set before start */
+static int shard_daq_set_filter (void* handle, const char* filter)
+{
+    ShardImpl* impl = (ShardImpl*)handle;
+    ShardReader* r = impl->reader;
+    struct bpf_program fcode;
+    int rval = DAQ_SUCCESS;
+
+    pthread_mutex_lock(&s_lock);
+
+    if ( r->running )
+    {
+        DPE(impl->error, "%s: can't change the filter while reading\n", DAQ_NAME);
+        rval = DAQ_ERROR;
+    }
+    else if ( pcap_compile(r->pcap, &fcode, filter, 1, PCAP_NETMASK_UNKNOWN) < 0 )
+    {
+        DPE(impl->error, "%s: can't compile filter (%s)\n", DAQ_NAME, pcap_geterr(r->pcap));
+        rval = DAQ_ERROR;
+    }
+    else
+    {
+        if ( pcap_setfilter(r->pcap, &fcode) < 0 )
+        {
+            DPE(impl->error, "%s: can't set filter (%s)\n", DAQ_NAME, pcap_geterr(r->pcap));
+            rval = DAQ_ERROR;
+        }
+        pcap_freecode(&fcode);
+    }
+    pthread_mutex_unlock(&s_lock);
+    return rval;
+}
+
+//-------------------------------------------------------------------------
+
+#ifdef BUILDING_SO
+DAQ_SO_PUBLIC DAQ_Module_t DAQ_MODULE_DATA =
+#else
+DAQ_Module_t shard_daq_module_data =
+#endif
+{
+    .api_version = DAQ_API_VERSION,
+    .module_version = DAQ_MOD_VERSION,
+    .name = DAQ_NAME,
+    .type = DAQ_TYPE,
+    .initialize = shard_daq_initialize,
+    .set_filter = shard_daq_set_filter,
+    .start = shard_daq_start,
+    .acquire = shard_daq_acquire,
+    .inject = shard_daq_inject,
+    .breakloop = shard_daq_breakloop,
+    .stop = shard_daq_stop,
+    .shutdown = shard_daq_shutdown,
+    .check_status = shard_daq_check_status,
+    .get_stats = shard_daq_get_stats,
+    .reset_stats = shard_daq_reset_stats,
+    .get_snaplen = shard_daq_get_snaplen,
+    .get_capabilities = shard_daq_get_capabilities,
+    .get_datalink_type = shard_daq_get_datalink_type,
+    .get_errbuf = shard_daq_get_errbuf,
+    .set_errbuf = shard_daq_set_errbuf,
+    .get_device_index = shard_daq_get_device_index,
+    .modify_flow = NULL,
+    .hup_prep = NULL,
+    .hup_apply = NULL,
+    .hup_post = NULL,
+    .dp_add_dc = NULL,
+    .query_flow = NULL
+};
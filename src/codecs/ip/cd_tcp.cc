@@ -22,6 +22,8 @@
 #include "config.h"
 #endif
 
+#include <daq_common.h>
+
 #include "codecs/codec_module.h"
 #include "framework/codec.h"
 #include "log/log.h"
@@ -56,6 +58,8 @@ const PegInfo pegs[]
 {
     { CountType::SUM, "bad_tcp4_checksum", "nonzero tcp over ip checksums" },
     { CountType::SUM, "bad_tcp6_checksum", "nonzero tcp over ipv6 checksums" },
+    { CountType::SUM, "checksums_computed", "tcp checksums evaluated in software" },
+    { CountType::SUM, "checksums_skipped", "tcp checksums trusted from hardware" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -63,6 +67,8 @@ struct Stats
 {
     PegCount bad_ip4_cksum;
     PegCount bad_ip6_cksum;
+    PegCount cksum_computed;
+    PegCount cksum_skipped;
 };
 
 static THREAD_LOCAL Stats stats;
@@ -171,11 +177,20 @@ bool TcpCodec::decode(const RawData& raw, CodecData& codec, DecodeData& snort)
     /* Checksum code moved in front of the other decoder alerts.
        If it's a bad checksum (maybe due to encrypted ESP traffic), the other
        alerts could be false positives. */
-    if ( SnortConfig::tcp_checksums() )
+    // the hardware only verifies the outermost tcp header
+    if ( SnortConfig::tcp_checksums() and SnortConfig::tcp_checksum_trust() and
+        (raw.pkth->flags & DAQ_PKT_FLAG_HW_TCP_CS_GOOD) and
+        codec.ip_layer_cnt == 1 and !codec.is_cooked() )
+    {
+        stats.cksum_skipped++;
+    }
+    else if ( SnortConfig::tcp_checksums() )
     {
         uint16_t csum;
         PegCount* bad_cksum_cnt;
 
+        stats.cksum_computed++;
+
         if (snort.ip_api.is_ip4())
         {
             bad_cksum_cnt = &(stats.bad_ip4_cksum);
@@ -21,6 +21,11 @@
 #define CODECS_CHECKSUM_H
 
 #include <cstddef>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
 
 #include <protocols/protocol_ids.h>
 
@@ -87,83 +92,103 @@ struct Psuedoheader6Union
     };
 };
 
-inline uint16_t cksum_add(const uint16_t* buf, std::size_t len, uint32_t cksum)
+// the ones complement sum is computed 32 bits at a time into a 64 bit
+// accumulator and folded at the end which gives the same result as adding
+// 16 bit words (RFC 1071).  larger buffers use avx2 when the cpu has it.
+
+inline uint64_t add_words(const uint8_t* sp, std::size_t len, uint64_t sum)
 {
-    const uint16_t* sp = buf;
+    uint32_t w[4];
 
-    if (len > 1 )
+    while ( len >= sizeof(w) )
     {
-        std::size_t sn = ((len / 2) & 0xF);  // == len/2 % 16
-        std::size_t n = (((len / 2) + 15) / 16);   // ceiling of (len / 2) / 16
+        memcpy(w, sp, sizeof(w));
+        sum += w[0];
+        sum += w[1];
+        sum += w[2];
+        sum += w[3];
+        sp += sizeof(w);
+        len -= sizeof(w);
+    }
 
-        switch (sn)
-        {
-        case 0:
-            sn = 16;
-            cksum += sp[15];    // fallthrough
-        case 15:
-            cksum += sp[14];    // fallthrough
-        case 14:
-            cksum += sp[13];    // fallthrough
-        case 13:
-            cksum += sp[12];    // fallthrough
-        case 12:
-            cksum += sp[11];    // fallthrough
-        case 11:
-            cksum += sp[10];    // fallthrough
-        case 10:
-            cksum += sp[9];     // fallthrough
-        case 9:
-            cksum += sp[8];     // fallthrough
-        case 8:
-            cksum  += sp[7];    // fallthrough
-        case 7:
-            cksum += sp[6];     // fallthrough
-        case 6:
-            cksum += sp[5];     // fallthrough
-        case 5:
-            cksum += sp[4];     // fallthrough
-        case 4:
-            cksum += sp[3];     // fallthrough
-        case 3:
-            cksum += sp[2];     // fallthrough
-        case 2:
-            cksum += sp[1];     // fallthrough
-        case 1:
-            cksum += sp[0];
-        }
-        sp += sn;
+    while ( len >= 2 )
+    {
+        uint16_t h;
+        memcpy(&h, sp, sizeof(h));
+        sum += h;
+        sp += 2;
+        len -= 2;
+    }
+
+    if (len & 1)
+        sum += *sp;
+
+    return sum;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CKSUM_AVX2
+
+// buffers shorter than this aren't worth the setup
+static const std::size_t avx2_min_len = 256;
+
+__attribute__((target("avx2")))
+inline uint64_t add_words_avx2(const uint8_t* sp, std::size_t len, uint64_t sum)
+{
+    const __m256i zero = _mm256_setzero_si256();
 
-        /* XXX - unroll loop using Duff's device. */
-        while (--n > 0)
+    while ( len >= 32 )
+    {
+        // each 32 bit lane takes 2 16 bit words per iteration so limit
+        // the block size to stay well clear of overflow
+        std::size_t n = len / 32;
+
+        if ( n > 4096 )
+            n = 4096;
+
+        __m256i acc = zero;
+
+        for ( std::size_t i = 0; i < n; ++i, sp += 32 )
         {
-            cksum += sp[0];
-            cksum += sp[1];
-            cksum += sp[2];
-            cksum += sp[3];
-            cksum += sp[4];
-            cksum += sp[5];
-            cksum += sp[6];
-            cksum += sp[7];
-            cksum += sp[8];
-            cksum += sp[9];
-            cksum += sp[10];
-            cksum += sp[11];
-            cksum += sp[12];
-            cksum += sp[13];
-            cksum += sp[14];
-            cksum += sp[15];
-            sp += 16;
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sp));
+            acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(v, zero));
+            acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(v, zero));
         }
+        len -= n * 32;
+
+        alignas(32) uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+
+        for ( auto l : lanes )
+            sum += l;
     }
 
-    if (len & 1)
-        cksum += (*(const unsigned char*)sp);
+    return add_words(sp, len, sum);
+}
+
+inline bool use_avx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+#endif
+
+inline uint16_t cksum_add(const uint16_t* buf, std::size_t len, uint32_t cksum)
+{
+    const uint8_t* sp = reinterpret_cast<const uint8_t*>(buf);
+    uint64_t sum;
+
+#ifdef CKSUM_AVX2
+    if ( len >= avx2_min_len and use_avx2() )
+        sum = add_words_avx2(sp, len, cksum);
+    else
+#endif
+    sum = add_words(sp, len, cksum);
 
-    cksum  = (cksum >> 16) + (cksum & 0x0000ffff);
-    cksum += (cksum >> 16);
+    while ( sum >> 16 )
+        sum = (sum >> 16) + (sum & 0x0000ffff);
 
-    return (uint16_t)(~cksum);
+    return (uint16_t)(~sum);
 }
 
 inline void add_ipv4_pseudoheader(const Pseudoheader* const ph4,
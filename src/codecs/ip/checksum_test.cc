@@ -0,0 +1,132 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// checksum_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <vector>
+
+#include "catch/snort_catch.h"
+
+#include "checksum.h"
+
+using namespace checksum;
+
+// RFC 1071 reference: 16 bit words in memory order, odd tail byte as the
+// low order byte of a word like the kernels do
+static uint16_t ref_cksum(const uint8_t* sp, std::size_t len, uint32_t init = 0)
+{
+    uint64_t sum = init;
+
+    for ( ; len >= 2; sp += 2, len -= 2 )
+    {
+        uint16_t h;
+        memcpy(&h, sp, sizeof(h));
+        sum += h;
+    }
+
+    if ( len )
+        sum += *sp;
+
+    while ( sum >> 16 )
+        sum = (sum >> 16) + (sum & 0xffff);
+
+    return (uint16_t)~sum;
+}
+
+static uint16_t fold(uint64_t sum)
+{
+    while ( sum >> 16 )
+        sum = (sum >> 16) + (sum & 0xffff);
+
+    return (uint16_t)~sum;
+}
+
+static std::vector<uint8_t> get_data(std::size_t len, int fill)
+{
+    std::vector<uint8_t> v(len);
+
+    for ( auto& b : v )
+        b = (fill < 0) ? (uint8_t)rand() : (uint8_t)fill;
+
+    return v;
+}
+
+TEST_CASE("scalar checksum", "[checksum]")
+{
+    srand(1071);
+
+    for ( int fill : { -1, 0xff } )
+    {
+        auto v = get_data(1200, fill);
+
+        for ( std::size_t off = 0; off < 4; ++off )
+        {
+            for ( std::size_t len = 0; len + off <= v.size(); ++len )
+            {
+                const uint8_t* sp = v.data() + off;
+                uint16_t ref = ref_cksum(sp, len, 0x1234);
+
+                CHECK(fold(detail::add_words(sp, len, 0x1234)) == ref);
+                CHECK(detail::cksum_add((const uint16_t*)sp, len, 0x1234) == ref);
+            }
+        }
+    }
+}
+
+#ifdef CKSUM_AVX2
+TEST_CASE("avx2 checksum", "[checksum]")
+{
+    if ( !detail::use_avx2() )
+        return;
+
+    srand(1071);
+
+    for ( int fill : { -1, 0xff } )
+    {
+        auto v = get_data(1200, fill);
+
+        // odd alignments and every tail length across several 32 byte blocks
+        for ( std::size_t off = 0; off < 4; ++off )
+        {
+            for ( std::size_t len = 0; len + off <= v.size(); ++len )
+            {
+                // the unfolded sums differ since the kernels add different
+                // word sizes; only the folded results must match
+                const uint8_t* sp = v.data() + off;
+                uint16_t avx2 = fold(detail::add_words_avx2(sp, len, 0x1234));
+
+                CHECK(avx2 == fold(detail::add_words(sp, len, 0x1234)));
+                CHECK(avx2 == ref_cksum(sp, len, 0x1234));
+            }
+        }
+    }
+
+    // more than one accumulator block of all ones
+    for ( std::size_t len : { 4096u * 32, 4096u * 32 + 31, 300001u } )
+    {
+        auto v = get_data(len + 1, 0xff);
+
+        CHECK(fold(detail::add_words_avx2(v.data() + 1, len, 0)) ==
+            ref_cksum(v.data() + 1, len));
+    }
+}
+#endif
@@ -29,6 +29,7 @@
 #include "filters/sfthreshold.h"
 #include "framework/endianness.h"
 #include "helpers/ring.h"
+#include "latency/latency_histogram.h"
 #include "latency/packet_latency.h"
 #include "main/modules.h"
 #include "main/snort.h"
@@ -321,6 +322,7 @@ bool DetectionEngine::detect(Packet* p, bool offload_ok)
 {
     assert(p);
     Profile profile(detectPerfStats);
+    LatencyHistograms::Context detect_latency(LatencyHistograms::DETECT);
 
     if ( !p->ptrs.ip_api.is_valid() )
         return false;
@@ -497,6 +499,7 @@ static int log_events(void* event, void* user)
 int DetectionEngine::log_events(Packet* p)
 {
     Profile profile(eventqPerfStats);
+    LatencyHistograms::Context log_latency(LatencyHistograms::LOG);
     SF_EVENTQ* pq = p->context->equeue;
     sfeventq_action(pq, ::log_events, (void*)p);
     return 0;
@@ -731,15 +731,25 @@ struct node_profile_stats
     uint64_t latency_suspends;
 };
 
+// totals node stats for instances [first, last) into the otn state for
+// this thread or, if given, the otn state in the map
+struct OtnStatsScope
+{
+    unsigned first;
+    unsigned last;
+    OtnStatsMap* map;
+};
+
 static void detection_option_node_update_otn_stats(detection_option_tree_node_t* node,
-    node_profile_stats* stats, uint64_t checks, uint64_t timeouts, uint64_t suspends)
+    node_profile_stats* stats, uint64_t checks, uint64_t timeouts, uint64_t suspends,
+    const OtnStatsScope& scope)
 {
     node_profile_stats local_stats; /* cumulative stats for this node */
     node_profile_stats node_stats;  /* sum of all instances */
 
     memset(&node_stats, 0, sizeof(node_stats));
 
-    for ( unsigned i = 0; i < ThreadConfig::get_instance_max(); ++i )
+    for ( unsigned i = scope.first; i < scope.last; ++i )
     {
         node_stats.elapsed += node->state[i].elapsed;
         node_stats.elapsed_match += node->state[i].elapsed_match;
@@ -778,7 +788,7 @@ static void detection_option_node_update_otn_stats(detection_option_tree_node_t*
         // Right now, it looks like we're missing out on some stats although it's possible
         // that this is "corrected" in the profiler code
         auto* otn = (OptTreeNode*)node->option_data;
-        auto& state = otn->state[get_instance_id()];
+        auto& state = scope.map ? (*scope.map)[otn] : otn->state[get_instance_id()];
 
         state.elapsed += local_stats.elapsed;
         state.elapsed_match += local_stats.elapsed_match;
@@ -795,14 +805,12 @@ static void detection_option_node_update_otn_stats(detection_option_tree_node_t*
     {
         for ( int i=0; i < node->num_children; ++i )
             detection_option_node_update_otn_stats(node->children[i], &local_stats, checks,
-                timeouts, suspends);
+                timeouts, suspends, scope);
     }
 }
 
-void detection_option_tree_update_otn_stats(XHash* doth)
+static void detection_option_tree_update_otn_stats(XHash* doth, const OtnStatsScope& scope)
 {
-    if ( !doth )
-        return;
 
     for ( auto hnode = xhash_findfirst(doth); hnode; hnode = xhash_findnext(doth) )
     {
@@ -813,7 +821,7 @@ void detection_option_tree_update_otn_stats(XHash* doth)
         uint64_t timeouts = 0;
         uint64_t suspends = 0;
 
-        for ( unsigned i = 0; i < ThreadConfig::get_instance_max(); ++i )
+        for ( unsigned i = scope.first; i < scope.last; ++i )
         {
             checks += node->state[i].checks;
             timeouts += node->state[i].latency_timeouts;
@@ -821,7 +829,32 @@ void detection_option_tree_update_otn_stats(XHash* doth)
         }
 
         if ( checks )
-            detection_option_node_update_otn_stats(node, nullptr, checks, timeouts, suspends);
+            detection_option_node_update_otn_stats(node, nullptr, checks, timeouts, suspends, scope);
+    }
+}
+
+void detection_option_tree_update_otn_stats(XHash* doth)
+{
+    if ( !doth )
+        return;
+
+    OtnStatsScope scope { 0, ThreadConfig::get_instance_max(), nullptr };
+    detection_option_tree_update_otn_stats(doth, scope);
+}
+
+// FIXIT-L the hash cursor is shared so callers must serialize
+void detection_option_tree_get_otn_stats(XHash* doth, unsigned instance, OtnStatsMap& map)
+{
+    if ( !doth )
+        return;
+
+    OtnStatsScope scope { instance, instance + 1, &map };
+    detection_option_tree_update_otn_stats(doth, scope);
+
+    for ( auto& it : map )
+    {
+        it.second.matches = it.first->state[instance].matches;
+        it.second.alerts = it.first->state[instance].alerts;
     }
 }
 
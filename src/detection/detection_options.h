@@ -33,6 +33,8 @@
 
 #include <sys/time.h>
 
+#include <unordered_map>
+
 #include "detection/rule_option_types.h"
 #include "time/clock_defs.h"
 
@@ -44,6 +46,8 @@ namespace snort
 struct Packet;
 struct SnortConfig;
 }
+struct OptTreeNode;
+struct OtnState;
 struct RuleLatencyState;
 struct XHash;
 
@@ -130,6 +134,11 @@ void DetectionTreeHashTableFree(XHash*);
 void print_option_tree(detection_option_tree_node_t*, int level);
 void detection_option_tree_update_otn_stats(XHash*);
 
+// live per rule stats of the calling packet thread; the otn states and
+// tree nodes are not changed
+using OtnStatsMap = std::unordered_map<OptTreeNode*, OtnState>;
+void detection_option_tree_get_otn_stats(XHash*, unsigned instance, OtnStatsMap&);
+
 detection_option_tree_root_t* new_root(OptTreeNode*);
 void free_detection_option_root(void** existing_tree);
 
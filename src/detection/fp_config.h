@@ -98,6 +98,12 @@ public:
     bool get_split_any_any()
     { return split_any_any; }
 
+    void set_compile_threads(unsigned n)
+    { compile_threads = n; }
+
+    unsigned get_compile_threads()
+    { return compile_threads; }
+
     void set_single_rule_group()
     { portlists_flags |= PL_SINGLE_RULE_GROUP; }
 
@@ -158,6 +164,7 @@ private:
 
     unsigned max_queue_events = 5;
     unsigned bleedover_port_limit = 1024;
+    unsigned compile_threads = 0;
 
     int search_opt = 0;
     int portlists_flags = 0;
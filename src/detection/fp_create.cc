@@ -34,6 +34,12 @@
 
 #include "fp_create.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
 #include "framework/mpse.h"
 #include "hash/ghash.h"
 #include "log/messages.h"
@@ -61,6 +67,37 @@ using namespace std;
 static unsigned mpse_count = 0;
 static const char* s_group = "";
 
+// with search_engine.compile_threads set, engines that support it are
+// queued by fpFinishPortGroup() and compiled on a pool of threads after
+// all groups are created.  the trees are then built serially in queue
+// order so the detection option tables come out as in a serial build.
+struct MpseJob
+{
+    Mpse* mpse;
+    string group;
+    double secs = 0.0;
+    int rval = 0;
+
+    MpseJob(Mpse* m, const char* g, int pmt) : mpse(m), group(g)
+    {
+        group += ".";
+        group += pm_type_strings[pmt];
+    }
+};
+
+static vector<MpseJob> s_jobs;
+static unsigned s_compile_threads = 0;
+
+// groups often end up with identical fast pattern sets, eg service rules
+// with any ports or the same rules on several http ports.  each engine's
+// patterns are fingerprinted as they are added and an engine identical
+// to a prior one is replaced with a reference to that one.  the user data
+// is part of the fingerprint so the shared engine runs the same trees.
+static unordered_map<Mpse*, vector<string>> s_prints;
+static unordered_map<string, Mpse*> s_engines;
+static unordered_map<Mpse*, unsigned> s_shared;
+static unsigned s_dedups = 0;
+
 static void fpDeletePMX(void* data);
 
 static int fpGetFinalPattern(
@@ -366,6 +403,57 @@ static int pmx_create_tree(SnortConfig* sc, void* id, void** existing_tree)
     return otn_create_tree(otn, existing_tree);
 }
 
+static void fpAddPattern(
+    SnortConfig* sc, PortGroup* pg, OptTreeNode* otn, PatternMatchData* pmd,
+    const char* pattern, int pattern_length)
+{
+    PMX* pmx = (PMX*)snort_calloc(sizeof(PMX));
+    pmx->rule_node.rnRuleData = otn;
+    pmx->pmd = pmd;
+
+    Mpse::PatternDescriptor desc(
+        pmd->is_no_case(), pmd->is_negated(), pmd->is_literal(), pmd->mpse_flags);
+
+    Mpse* mpse = pg->mpse[pmd->pm_type];
+    mpse->add_pattern(sc, (const uint8_t*)pattern, pattern_length, desc, pmx);
+
+    // the fingerprint is the pattern with everything the match depends on
+    string print((const char*)&otn, sizeof(otn));
+    print.append((const char*)&pmd, sizeof(pmd));
+    print += desc.no_case ? '1' : '0';
+    print += desc.negated ? '1' : '0';
+    print += desc.literal ? '1' : '0';
+    print.append((const char*)&desc.flags, sizeof(desc.flags));
+    print.append(pattern, pattern_length);
+
+    s_prints[mpse].emplace_back(move(print));
+}
+
+// returns an equivalent engine already built or nullptr if this one is new
+static Mpse* fpGetSharedEngine(Mpse* mpse)
+{
+    auto it = s_prints.find(mpse);
+
+    if ( it == s_prints.end() )
+        return nullptr;
+
+    vector<string>& prints = it->second;
+    sort(prints.begin(), prints.end());
+
+    string key(mpse->get_method());
+
+    for ( auto& print : prints )
+    {
+        uint32_t len = print.size();
+        key.append((const char*)&len, sizeof(len));
+        key += print;
+    }
+    s_prints.erase(it);
+
+    auto res = s_engines.emplace(move(key), mpse);
+    return res.second ? nullptr : res.first->second;
+}
+
 static int fpFinishPortGroupRule(
     SnortConfig* sc, PortGroup* pg,
     OptTreeNode* otn, PatternMatchData* pmd, FastPatternConfig* fp)
@@ -412,15 +500,7 @@ static int fpFinishPortGroupRule(
     if ( fp->get_debug_print_fast_patterns() )
         print_fp_info(s_group, otn, pmd, pattern, pattern_length);
 
-    PMX* pmx = (PMX*)snort_calloc(sizeof(PMX));
-    pmx->rule_node.rnRuleData = otn;
-    pmx->pmd = pmd;
-
-    Mpse::PatternDescriptor desc(
-        pmd->is_no_case(), pmd->is_negated(), pmd->is_literal(), pmd->mpse_flags);
-
-    pg->mpse[pmd->pm_type]->add_pattern(sc, (const uint8_t*)pattern, pattern_length, desc, pmx);
-
+    fpAddPattern(sc, pg, otn, pmd, pattern, pattern_length);
     return 0;
 }
 
@@ -439,18 +519,37 @@ static int fpFinishPortGroup(
         {
             if (pg->mpse[i]->get_pattern_count() != 0)
             {
+                if ( Mpse* shared = fpGetSharedEngine(pg->mpse[i]) )
+                {
+                    MpseManager::delete_search_engine(pg->mpse[i]);
+                    MpseManager::share_search_engine(shared);
+                    pg->mpse[i] = shared;
+                    ++s_shared[shared];
+                    ++s_dedups;
+                    rules = 1;
+                    continue;
+                }
+                bool queued = false;
+
                 if ( !sc->test_mode() or sc->mem_check() )
                 {
-                    if ( pg->mpse[i]->prep_patterns(sc) != 0 )
+                    if ( s_compile_threads and
+                        MpseManager::parallel_compiles(pg->mpse[i]->get_api()) )
+                    {
+                        s_jobs.emplace_back(pg->mpse[i], s_group, i);
+                        queued = true;
+                    }
+                    else if ( pg->mpse[i]->prep_patterns(sc) != 0 )
                         FatalError("Failed to compile port group patterns.\n");
                 }
 
-                if (fp->get_debug_mode())
+                if ( fp->get_debug_mode() and !queued )
                     pg->mpse[i]->print_info();
                 rules = 1;
             }
             else
             {
+                s_prints.erase(pg->mpse[i]);
                 MpseManager::delete_search_engine(pg->mpse[i]);
                 pg->mpse[i] = nullptr;
             }
@@ -489,15 +588,7 @@ static void fpAddAlternatePatterns(SnortConfig* sc, PortGroup* pg,
     if ( fp->get_debug_print_fast_patterns() )
         print_fp_info(s_group, otn, pmd, pmd->pattern_buf, pmd->pattern_size);
 
-    PMX* pmx = (PMX*)snort_calloc(sizeof(PMX));
-    pmx->rule_node.rnRuleData = otn;
-    pmx->pmd = pmd;
-
-    Mpse::PatternDescriptor desc(
-        pmd->is_no_case(), pmd->is_negated(), pmd->is_literal(), pmd->mpse_flags);
-
-    pg->mpse[pmd->pm_type]->add_pattern(
-        sc, (const uint8_t*)pmd->pattern_buf, pmd->pattern_size, desc, pmx);
+    fpAddPattern(sc, pg, otn, pmd, pmd->pattern_buf, pmd->pattern_size);
 }
 
 static int fpAddPortGroupRule(
@@ -1508,6 +1599,92 @@ static int fpCreateServicePortGroups(SnortConfig* sc)
     return 0;
 }
 
+static void fpCompileJobs(SnortConfig* sc, unsigned nthreads)
+{
+    atomic<unsigned> next { 0 };
+
+    auto worker = [&]()
+    {
+        unsigned idx;
+
+        while ( (idx = next++) < s_jobs.size() )
+        {
+            MpseJob& job = s_jobs[idx];
+            auto start = chrono::steady_clock::now();
+
+            job.rval = job.mpse->compile(sc);
+
+            chrono::duration<double> secs = chrono::steady_clock::now() - start;
+            job.secs = secs.count();
+        }
+    };
+
+    vector<thread> pool;
+
+    for ( unsigned i = 0; i < nthreads; ++i )
+        pool.emplace_back(worker);
+
+    for ( auto& t : pool )
+        t.join();
+}
+
+static void fpFinishCompiles(SnortConfig* sc, FastPatternConfig* fp)
+{
+    if ( s_jobs.empty() )
+        return;
+
+    unsigned nthreads = min(s_compile_threads, (unsigned)s_jobs.size());
+    auto start = chrono::steady_clock::now();
+
+    fpCompileJobs(sc, nthreads);
+
+    chrono::duration<double> wall = chrono::steady_clock::now() - start;
+    const MpseJob* slowest = nullptr;
+    double total = 0.0;
+
+    for ( auto& job : s_jobs )
+    {
+        if ( job.rval or job.mpse->build_trees(sc) )
+            FatalError("Failed to compile %s group patterns.\n", job.group.c_str());
+
+        if ( fp->get_debug_mode() )
+            job.mpse->print_info();
+
+        if ( fp->get_debug_print_rule_group_build_details() )
+            LogMessage("%s group compiled in %.6f seconds\n", job.group.c_str(), job.secs);
+
+        if ( !slowest or job.secs > slowest->secs )
+            slowest = &job;
+
+        total += job.secs;
+    }
+
+    LogLabel("search engine compiles");
+    LogMessage("%25.25s: %-12zu\n", "groups", s_jobs.size());
+    LogMessage("%25.25s: %-12u\n", "threads", nthreads);
+    LogMessage("%25.25s: %-12.3f\n", "compile seconds", total);
+    LogMessage("%25.25s: %-12.3f\n", "elapsed seconds", wall.count());
+    LogMessage("%25.25s: %s (%.3f)\n", "slowest group", slowest->group.c_str(), slowest->secs);
+
+    s_jobs.clear();
+    s_jobs.shrink_to_fit();
+}
+
+// the saved memory is that of the compiled engines that weren't built
+static size_t fpFinishSharing()
+{
+    size_t saved = 0;
+
+    for ( auto& p : s_shared )
+        saved += p.first->get_memory_used() * p.second;
+
+    s_prints.clear();
+    s_engines.clear();
+    s_shared.clear();
+
+    return saved;
+}
+
 /*
 *  Port list version
 *
@@ -1533,6 +1710,8 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
     }
 
     mpse_count = 0;
+    s_dedups = 0;
+    s_compile_threads = fp->get_compile_threads();
 
     MpseManager::start_search_engine(fp->get_search_api());
 
@@ -1570,6 +1749,9 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
     if (fp->get_debug_print_rule_group_build_details())
         LogMessage("Service Based Rule Maps Done....\n");
 
+    fpFinishCompiles(sc, fp);
+    size_t saved = fpFinishSharing();
+
     fp_print_port_groups(port_tables);
     fp_print_service_groups(sc->spgmmTable);
 
@@ -1585,6 +1767,12 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
     if ( fp->get_num_patterns_trimmed() )
         LogMessage("%25.25s: %-12u\n", "prefix trims", fp->get_num_patterns_trimmed());
 
+    if ( s_dedups )
+    {
+        LogMessage("%25.25s: %-12u\n", "shared engines", s_dedups);
+        LogMessage("%25.25s: %-12zu\n", "shared KB saved", saved / 1024);
+    }
+
     MpseManager::setup_search_engine(fp->get_search_api(), sc);
 
     return 0;
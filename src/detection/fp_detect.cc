@@ -345,6 +345,9 @@ static int detection_option_tree_evaluate(detection_option_tree_root_t* root,
     }
     clear_trace_cursor_info();
 
+    if ( rval )
+        RuleLatency::matched();
+
     return rval;
 }
 
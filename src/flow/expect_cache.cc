@@ -32,15 +32,20 @@
 #include "stream/stream.h"      // FIXIT-M bad dependency
 #include "time/packet_time.h"
 
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
 using namespace snort;
 
-/* Reasonably small, and prime */
-// FIXIT-L size based on max_tcp + max_udp?
-#define MAX_HASH 1021
+// ZHash masks with rows - 1 so rows must be a power of 2
+#define MAX_HASH 1024
 #define MAX_LIST    8
 #define MAX_DATA    4
 #define MAX_WAIT  300
-#define MAX_PRUNE   5
+
+// one slot per second; must be a power of 2 greater than MAX_WAIT
+#define WHEEL_SLOTS 512
 
 static THREAD_LOCAL std::vector<ExpectFlow*>* packet_expect_flows = nullptr;
 
@@ -106,6 +111,13 @@ struct ExpectNode
     ExpectFlow* head = nullptr;
     ExpectFlow* tail = nullptr;
 
+    // timer wheel slot list
+    ExpectNode* wnext = nullptr;
+    ExpectNode* wprev = nullptr;
+
+    FlowKey key;
+    unsigned form = 0;
+
     void clear(ExpectFlow*&);
 };
 
@@ -127,26 +139,102 @@ void ExpectNode::clear(ExpectFlow*& list)
 // private ExpectCache methods
 //-------------------------------------------------------------------------
 
-// Clean the hash table of at most MAX_PRUNE expired nodes
-void ExpectCache::prune()
+void ExpectCache::wheel_link(ExpectNode* node)
 {
-    time_t now = packet_time();
+    ExpectNode*& slot = wheel[node->expires & (WHEEL_SLOTS - 1)];
+
+    node->wprev = nullptr;
+    node->wnext = slot;
+
+    if ( slot )
+        slot->wprev = node;
+
+    slot = node;
+}
+
+void ExpectCache::wheel_unlink(ExpectNode* node)
+{
+    ExpectNode*& slot = wheel[node->expires & (WHEEL_SLOTS - 1)];
+
+    if ( node->wprev )
+        node->wprev->wnext = node->wnext;
+
+    else if ( slot == node )
+        slot = node->wnext;
+
+    else
+        return;  // not linked; don't clobber the slot
+
+    if ( node->wnext )
+        node->wnext->wprev = node->wprev;
+
+    node->wnext = node->wprev = nullptr;
+}
 
-    for (unsigned i = 0; i < MAX_PRUNE; ++i )
+void ExpectCache::add_node(ExpectNode* node, const FlowKey& key)
+{
+    node->key = key;
+
+    if ( key.port_l && key.port_h )
+        node->form = EXACT;
+    else
+        node->form = key.port_l ? WILD_HI : WILD_LO;
+
+    ++forms[node->form];
+
+    // expires on the next tick unless an expect is added
+    node->expires = packet_time();
+    wheel_link(node);
+}
+
+void ExpectCache::remove_node(ExpectNode* node)
+{
+    node->clear(free_list);
+    wheel_unlink(node);
+
+    assert(forms[node->form]);
+    --forms[node->form];
+    hash_table->remove(&node->key);
+}
+
+// Remove nodes that expired since the last call.  Each elapsed second is
+// one wheel slot; all slots are checked if more than a full turn elapsed.
+void ExpectCache::expire(time_t now)
+{
+    if ( now < wheel_time || !hash_table->get_count() )
     {
-        ExpectNode* node = (ExpectNode*)hash_table->first();
+        wheel_time = now;
+        return;
+    }
 
-        if ( !node || now <= node->expires )
-            break;
+    time_t ticks = now - wheel_time;
 
-        node->clear(free_list);
-        hash_table->remove();
-        ++prunes;
+    if ( ticks > WHEEL_SLOTS )
+        ticks = WHEEL_SLOTS;
+
+    for ( time_t t = wheel_time; t < wheel_time + ticks; ++t )
+    {
+        ExpectNode* node = wheel[t & (WHEEL_SLOTS - 1)];
+
+        while ( node )
+        {
+            ExpectNode* next = node->wnext;
+
+            if ( node->expires < now )
+            {
+                remove_node(node);
+                ++prunes;
+            }
+            node = next;
+        }
     }
+    wheel_time = now;
 }
 
 ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
 {
+    expire(p->pkth->ts.tv_sec);
+
     if (!hash_table->get_count())
         return nullptr;
 
@@ -167,46 +255,40 @@ ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
             2. Unknown (zeroed) source port.
             3. Unknown (zeroed) destination port.
         If the client/server addresses were reversed during key creation, the
-        source port will be in port_l.
+        source port will be in port_l.  Forms with no nodes are not probed.
     */
-    // FIXIT-P X This should be optimized to only do full matches when full keys
-    //      are present, likewise for partial keys.
-    ExpectNode* node = (ExpectNode*) hash_table->find(&key);
-    if (!node)
+    // FIXIT-M X This logic could fail if IPs were equal because the original key
+    // would always have been created with a 0 for src or dst port and put the
+    // known port in port_h.
+    const uint16_t port_l = key.port_l;
+    const uint16_t port_h = key.port_h;
+    const KeyForm wild[] =
     {
-        // FIXIT-M X This logic could fail if IPs were equal because the original key
-        // would always have been created with a 0 for src or dst port and put the
-        // known port in port_h.
-        uint16_t port1;
-        uint16_t port2;
+        reversed_key ? WILD_LO : WILD_HI,
+        reversed_key ? WILD_HI : WILD_LO
+    };
 
-        if (reversed_key)
-        {
-            port1 = key.port_l;
-            port2 = 0;
-            key.port_l = 0;
-        }
-        else
-        {
-            port1 = 0;
-            port2 = key.port_h;
-            key.port_h = 0;
-        }
+    ExpectNode* node = nullptr;
+
+    if (forms[EXACT])
+        node = (ExpectNode*) hash_table->find(&key);
+
+    for (unsigned i = 0; !node && i < 2; ++i)
+    {
+        if (!forms[wild[i]])
+            continue;
+
+        key.port_l = (wild[i] == WILD_LO) ? 0 : port_l;
+        key.port_h = (wild[i] == WILD_HI) ? 0 : port_h;
         node = (ExpectNode*) hash_table->find(&key);
-        if (!node)
-        {
-            key.port_l = port1;
-            key.port_h = port2;
-            node = (ExpectNode*) hash_table->find(&key);
-            if (!node)
-                return nullptr;
-        }
     }
+
+    if (!node)
+        return nullptr;
+
     if (!node->head || (p->pkth->ts.tv_sec > node->expires))
     {
-        if (node->head)
-            node->clear(free_list);
-        hash_table->remove(&key);
+        remove_node(node);
         return nullptr;
     }
     /* Make sure the packet direction is correct */
@@ -225,7 +307,7 @@ ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
     return node;
 }
 
-bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Flow* lws)
+bool ExpectCache::process_expected(ExpectNode* node, Packet* p, Flow* lws)
 {
     ExpectFlow* head;
     FlowData* fd;
@@ -257,7 +339,7 @@ bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Fl
         lws->ssn_state.snort_protocol_id = node->snort_protocol_id;
 
     if (!node->count)
-        hash_table->remove(&key);
+        remove_node(node);
 
     return ignoring;
 }
@@ -268,10 +350,16 @@ bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Fl
 
 ExpectCache::ExpectCache(uint32_t max)
 {
-    // -size forces use of abs(size) ie w/o bumping up
-    hash_table = new ZHash(-MAX_HASH, sizeof(FlowKey));
+    // rows are rounded up to a power of 2
+    hash_table = new ZHash(max > MAX_HASH ? max : MAX_HASH, sizeof(FlowKey));
     hash_table->set_keyops(FlowKey::hash, FlowKey::compare);
 
+    wheel = new ExpectNode*[WHEEL_SLOTS]();
+    wheel_time = 0;
+
+    for (unsigned i = 0; i < MAX_FORM; ++i)
+        forms[i] = 0;
+
     nodes = new ExpectNode[max];
     for (unsigned i = 0; i < max; ++i)
         hash_table->push(nodes+i);
@@ -290,8 +378,8 @@ ExpectCache::ExpectCache(uint32_t max)
         free_list = p;
     }
 
-    expects = realized = 0;
-    prunes = overflows = 0;
+    reset_stats();
+
     if (packet_expect_flows == nullptr)
         packet_expect_flows = new std::vector<ExpectFlow*>;
 }
@@ -299,12 +387,20 @@ ExpectCache::ExpectCache(uint32_t max)
 ExpectCache::~ExpectCache()
 {
     delete hash_table;
+    delete[] wheel;
     delete[] nodes;
     delete[] pool;
     delete packet_expect_flows;
     packet_expect_flows = nullptr;
 }
 
+void ExpectCache::reset_stats()
+{
+    expects = realized = 0;
+    prunes = overflows = 0;
+    exact_hits = wild_hits = 0;
+}
+
 /**Either expect or expect future session.
  *
  * Preprocessors may add sessions to be expected altogether or to be associated
@@ -343,19 +439,20 @@ int ExpectCache::add_flow(const Packet *ctrlPkt,
     ExpectFlow* last;
     bool new_node = false;
 
+    expire(packet_time());
+
     node = (ExpectNode*) hash_table->get(&key, &new_node);
-    if (!node)
+
+    if (node && new_node)
+        add_node(node, key);
+
+    /* The flow free list should never be empty if there was a node
+        to be (re-)used unless we managed to leak some.  Check just
+        in case.  Maybe assert instead? */
+    if (!node || !free_list)
     {
-        prune();
-        node = (ExpectNode*) hash_table->get(&key, &new_node);
-        /* The flow free list should never be empty if there was a node
-            to be (re-)used unless we managed to leak some.  Check just
-            in case.  Maybe assert instead? */
-        if (!node || !free_list)
-        {
-            ++overflows;
-            return -1;
-        }
+        ++overflows;
+        return -1;
     }
 
     /* If the node is past its expiration date, whack it and reuse it. */
@@ -429,7 +526,11 @@ int ExpectCache::add_flow(const Packet *ctrlPkt,
         new_expect_flow = true;
     }
     last->add_flow_data(fd);
+
+    wheel_unlink(node);
     node->expires = packet_time() + MAX_WAIT;
+    wheel_link(node);
+
     ++expects;
     if (new_expect_flow)
     {
@@ -456,6 +557,174 @@ bool ExpectCache::check(Packet* p, Flow* lws)
     if (!node)
         return false;
 
-    return process_expected(node, key, p, lws);
+    if (node->form == EXACT)
+        ++exact_hits;
+    else
+        ++wild_hits;
+
+    return process_expected(node, p, lws);
+}
+
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+struct ExpectCacheTest
+{
+    ExpectCache ec { 8 };
+
+    ExpectNode* add(uint16_t port_l, uint16_t port_h, time_t expires)
+    {
+        FlowKey key;
+        memset(&key, 0, sizeof(key));
+        key.port_l = port_l;
+        key.port_h = port_h;
+
+        bool new_node = false;
+        ExpectNode* node = (ExpectNode*)ec.hash_table->get(&key, &new_node);
+
+        REQUIRE(node);
+        REQUIRE(new_node);
+
+        ec.add_node(node, key);
+        ec.wheel_unlink(node);
+        node->expires = expires;
+        ec.wheel_link(node);
+
+        return node;
+    }
+
+    void expire(time_t now)
+    { ec.expire(now); }
+
+    void link(ExpectNode* node)
+    { ec.wheel_link(node); }
+
+    void unlink(ExpectNode* node)
+    { ec.wheel_unlink(node); }
+
+    unsigned nodes()
+    { return ec.hash_table->get_count(); }
+
+    unsigned exact()
+    { return ec.forms[ExpectCache::EXACT]; }
+
+    unsigned wild()
+    { return ec.forms[ExpectCache::WILD_LO] + ec.forms[ExpectCache::WILD_HI]; }
+
+    bool linked(ExpectNode* node)
+    {
+        for ( ExpectNode* n = ec.wheel[node->expires & (WHEEL_SLOTS - 1)]; n; n = n->wnext )
+            if ( n == node )
+                return true;
+        return false;
+    }
+};
+
+TEST_CASE("expect wheel expiry", "[expect_cache]")
+{
+    ExpectCacheTest t;
+    t.expire(1000);
+
+    SECTION("same slot next turn")
+    {
+        t.add(1, 0, 1010);
+        ExpectNode* later = t.add(2, 0, 1010 + WHEEL_SLOTS);
+
+        t.expire(1010);
+        CHECK(t.nodes() == 2);
+
+        t.expire(1011);
+        CHECK(t.nodes() == 1);
+        CHECK(t.ec.get_prunes() == 1);
+        CHECK(t.linked(later));
+
+        t.expire(1011 + WHEEL_SLOTS);
+        CHECK(t.nodes() == 0);
+        CHECK(t.ec.get_prunes() == 2);
+    }
+
+    SECTION("more than a full turn")
+    {
+        t.add(1, 0, 1005);
+        t.add(2, 0, 1300);
+
+        t.expire(1000 + 4 * WHEEL_SLOTS);
+        CHECK(t.nodes() == 0);
+        CHECK(t.ec.get_prunes() == 2);
+    }
+
+    SECTION("time moves backward")
+    {
+        t.add(1, 0, 1005);
+
+        t.expire(500);
+        CHECK(t.nodes() == 1);
+
+        t.expire(1005);
+        CHECK(t.nodes() == 1);
+
+        t.expire(1006);
+        CHECK(t.nodes() == 0);
+    }
 }
 
+TEST_CASE("expect key forms", "[expect_cache]")
+{
+    ExpectCacheTest t;
+    t.expire(1000);
+
+    t.add(1, 2, 1001);
+    t.add(0, 2, 1001);
+    t.add(1, 0, 1002);
+
+    CHECK(t.exact() == 1);
+    CHECK(t.wild() == 2);
+
+    t.expire(1002);
+    CHECK(t.exact() == 0);
+    CHECK(t.wild() == 1);
+
+    // counts are unsigned so an underflow would show up as huge
+    t.expire(1003);
+    CHECK(t.exact() == 0);
+    CHECK(t.wild() == 0);
+    CHECK(t.nodes() == 0);
+}
+
+TEST_CASE("expect wheel unlink", "[expect_cache]")
+{
+    ExpectCacheTest t;
+    t.expire(1000);
+
+    ExpectNode* node = t.add(1, 0, 1001);
+    ExpectNode stray;
+    stray.expires = node->expires;
+
+    SECTION("never linked")
+    {
+        t.unlink(&stray);
+        CHECK(t.linked(node));
+    }
+
+    SECTION("unlinked twice")
+    {
+        ExpectNode* other = t.add(2, 0, 1001);
+
+        t.unlink(other);
+        t.unlink(other);
+        CHECK(t.linked(node));
+        CHECK_FALSE(t.linked(other));
+
+        t.link(other);
+        CHECK(t.linked(other));
+    }
+
+    t.expire(1002);
+    CHECK(t.nodes() == 0);
+}
+
+#endif
@@ -54,6 +54,11 @@
 // -- new list structs are appended to node's list struct chain
 // -- matching expected sessions are pulled off from the head of the node's
 //    list struct chain
+// -- nodes are counted by key form (exact, low port wild, high port wild)
+//    so lookups only probe the forms that are present; usually just one
+// -- nodes are also linked into a timer wheel by expiration second; expired
+//    nodes are removed as the wheel is advanced to the current packet time
+//    so the cost is proportional to the number expired
 //
 // FIXIT-M expiration is by node struct but should be by list struct, ie
 //    individual sessions, not all sessions to a given 3-tuple
@@ -103,27 +108,48 @@ public:
     bool is_expected(snort::Packet*);
     bool check(snort::Packet*, snort::Flow*);
 
-    unsigned long get_expects() { return expects; }
-    unsigned long get_realized() { return realized; }
-    unsigned long get_prunes() { return prunes; }
-    unsigned long get_overflows() { return overflows; }
+    unsigned long get_expects() const { return expects; }
+    unsigned long get_realized() const { return realized; }
+    unsigned long get_prunes() const { return prunes; }
+    unsigned long get_overflows() const { return overflows; }
+    unsigned long get_exact_hits() const { return exact_hits; }
+    unsigned long get_wild_hits() const { return wild_hits; }
+
+    void reset_stats();
 
 private:
-    void prune();
+    enum KeyForm { EXACT, WILD_LO, WILD_HI, MAX_FORM };
+
+    void expire(time_t);
+
+    void add_node(ExpectNode*, const snort::FlowKey&);
+    void remove_node(ExpectNode*);
+
+    void wheel_link(ExpectNode*);
+    void wheel_unlink(ExpectNode*);
 
     ExpectNode* get_node(snort::FlowKey&, bool&);
     snort::ExpectFlow* get_flow(ExpectNode*, uint32_t, int16_t);
     bool set_data(ExpectNode*, snort::ExpectFlow*&, snort::FlowData*);
     ExpectNode* find_node_by_packet(snort::Packet*, snort::FlowKey&);
-    bool process_expected(ExpectNode*, snort::FlowKey&, snort::Packet*, snort::Flow*);
+    bool process_expected(ExpectNode*, snort::Packet*, snort::Flow*);
 
 private:
     class ZHash* hash_table;
     ExpectNode* nodes;
     snort::ExpectFlow* pool, * free_list;
 
+    ExpectNode** wheel;
+    time_t wheel_time;
+    unsigned forms[MAX_FORM];
+
     unsigned long expects, realized;
     unsigned long prunes, overflows;
+    unsigned long exact_hits, wild_hits;
+
+#ifdef UNIT_TEST
+    friend struct ExpectCacheTest;
+#endif
 };
 
 #endif
@@ -317,6 +317,8 @@ public:  // FIXIT-M privatize if possible
     // these fields are always set; not zeroed
     uint64_t flow_flags;  // FIXIT-H required to ensure atomic?
     Flow* prev, * next;
+    Flow* wheel_prev, * wheel_next;  // FlowCache timeout wheel
+    long wheel_time;
     Inspector* ssn_client;
     Inspector* ssn_server;
 
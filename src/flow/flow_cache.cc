@@ -38,6 +38,10 @@ using namespace snort;
 
 #define SESSION_CACHE_FLAG_PURGING  0x01
 
+// one slot per second; a power of 2 that covers the default idle timeouts.
+// flows due further out are checked and put back once per turn.
+#define WHEEL_SLOTS 4096
+
 //-------------------------------------------------------------------------
 // FlowCache stuff
 //-------------------------------------------------------------------------
@@ -56,6 +60,9 @@ FlowCache::FlowCache (const FlowConfig& cfg) : config(cfg)
     uni_count = 0;
     flags = 0x0;
 
+    wheel = new Flow*[WHEEL_SLOTS]();
+    wheel_time = 0;
+
     assert(prune_stats.get_total() == 0);
 }
 
@@ -68,6 +75,7 @@ FlowCache::~FlowCache ()
     delete uni_tail;
 
     delete hash_table;
+    delete[] wheel;
 }
 
 void FlowCache::push(Flow* flow)
@@ -122,10 +130,50 @@ void FlowCache::unlink_uni(Flow* flow)
     flow->next = flow->prev = nullptr;
 }
 
+// flows are filed by the time they are due to be checked; flows that see
+// more traffic are not moved until then
+void FlowCache::wheel_link(Flow* flow, time_t due)
+{
+    // slots up to wheel_time have been checked
+    if ( due <= wheel_time )
+        due = wheel_time + 1;
+
+    Flow*& slot = wheel[due & (WHEEL_SLOTS - 1)];
+
+    flow->wheel_time = due;
+    flow->wheel_prev = nullptr;
+    flow->wheel_next = slot;
+
+    if ( slot )
+        slot->wheel_prev = flow;
+
+    slot = flow;
+}
+
+void FlowCache::wheel_unlink(Flow* flow)
+{
+    Flow*& slot = wheel[flow->wheel_time & (WHEEL_SLOTS - 1)];
+
+    if ( flow->wheel_prev )
+        flow->wheel_prev->wheel_next = flow->wheel_next;
+
+    else if ( slot == flow )
+        slot = flow->wheel_next;
+
+    else
+        return;  // not linked
+
+    if ( flow->wheel_next )
+        flow->wheel_next->wheel_prev = flow->wheel_prev;
+
+    flow->wheel_prev = flow->wheel_next = nullptr;
+}
+
 Flow* FlowCache::get(const FlowKey* key)
 {
     time_t timestamp = packet_time();
-    Flow* flow = (Flow*)hash_table->get(key);
+    bool new_node = false;
+    Flow* flow = (Flow*)hash_table->get(key, &new_node);
 
     if ( !flow )
     {
@@ -135,13 +183,16 @@ Flow* FlowCache::get(const FlowKey* key)
                 prune_excess(nullptr);
         }
 
-        flow = (Flow*)hash_table->get(key);
+        flow = (Flow*)hash_table->get(key, &new_node);
 
         assert(flow);
         flow->reset();
         link_uni(flow);
     }
 
+    if ( new_node )
+        wheel_link(flow, timestamp + config.nominal_timeout);
+
     flow->last_data_seen = timestamp;
 
     return flow;
@@ -159,6 +210,7 @@ int FlowCache::remove(Flow* flow)
     if ( flow->next )
         unlink_uni(flow);
 
+    wheel_unlink(flow);
     return hash_table->remove(flow->key);
 }
 
@@ -288,36 +340,66 @@ bool FlowCache::prune_one(PruneReason reason, bool do_cleanup)
     return true;
 }
 
+// check the slots for each second after the last call; flows that are idle
+// are released and the rest are filed again by their current due time.
+// if more than a full turn has elapsed every slot is checked once.  at most
+// num_flows are released per call; the rest wait for the next call from
+// the first slot not finished.  the wheel never moves back since flows
+// filed while it was ahead are only in the slots after wheel_time.
 unsigned FlowCache::timeout(unsigned num_flows, time_t thetime)
 {
-    // FIXIT-H should Active be suspended here too?
-    unsigned retired = 0;
+    if ( thetime <= wheel_time )
+        return 0;
 
-    auto flow = static_cast<Flow*>(hash_table->current());
+    if ( !hash_table->get_count() )
+    {
+        wheel_time = thetime;
+        return 0;
+    }
 
-    if ( !flow )
-        flow = static_cast<Flow*>(hash_table->first());
+    time_t ticks = thetime - wheel_time;
 
-    while ( flow and (retired < num_flows) )
+    if ( ticks > WHEEL_SLOTS )
+        ticks = WHEEL_SLOTS;
+
+    time_t start = wheel_time + 1;
+    unsigned retired = 0;
+
+    for ( time_t t = start; t < start + ticks; ++t )
     {
-        if ( flow->last_data_seen + config.nominal_timeout > thetime )
-            break;
+        // slots before this one are done
+        wheel_time = t - 1;
+        Flow* flow = wheel[t & (WHEEL_SLOTS - 1)];
 
-        if ( HighAvailabilityManager::in_standby(flow) or
-            flow->is_offloaded() )
+        while ( flow )
         {
-            flow = static_cast<Flow*>(hash_table->next());
-            continue;
+            Flow* next = flow->wheel_next;
+            time_t due = flow->last_data_seen + config.nominal_timeout;
+
+            if ( due > thetime )
+            {
+                wheel_unlink(flow);
+                wheel_link(flow, due);
+            }
+            else if ( HighAvailabilityManager::in_standby(flow) or flow->is_offloaded() )
+            {
+                wheel_unlink(flow);
+                wheel_link(flow, thetime + config.nominal_timeout);
+            }
+            else if ( retired < num_flows )
+            {
+                flow->ssn_state.session_flags |= SSNFLAG_TIMEDOUT;
+                release(flow, PruneReason::IDLE);
+                ++retired;
+            }
+            else
+                return retired;
+
+            flow = next;
         }
-
-        flow->ssn_state.session_flags |= SSNFLAG_TIMEDOUT;
-        release(flow, PruneReason::IDLE);
-
-        ++retired;
-
-        flow = static_cast<Flow*>(hash_table->current());
     }
 
+    wheel_time = thetime;
     return retired;
 }
 
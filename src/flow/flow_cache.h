@@ -24,6 +24,7 @@
 
 // there is a FlowCache instance for each protocol.
 // Flows are stored in a ZHash instance by FlowKey.
+// Idle timeouts are driven by a timer wheel with one second slots.
 
 #include <ctime>
 #include <type_traits>
@@ -59,6 +60,10 @@ public:
     bool prune_one(PruneReason, bool do_cleanup);
     unsigned timeout(unsigned num_flows, time_t cur_time);
 
+    // true if idle flows due by cur_time are still waiting for a timeout
+    bool timeout_pending(time_t cur_time) const
+    { return wheel_time < cur_time; }
+
     unsigned purge();
     unsigned get_count();
 
@@ -80,6 +85,9 @@ private:
     void link_uni(snort::Flow*);
     int remove(snort::Flow*);
 
+    void wheel_link(snort::Flow*, time_t);
+    void wheel_unlink(snort::Flow*);
+
 private:
     static const unsigned cleanup_flows = 1;
     const FlowConfig config;
@@ -88,6 +96,9 @@ private:
 
     class ZHash* hash_table;
     snort::Flow* uni_head, * uni_tail;
+
+    snort::Flow** wheel;
+    time_t wheel_time;
     PruneStats prune_stats;
 };
 
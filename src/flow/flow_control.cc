@@ -79,6 +79,9 @@ void FlowControl::clear_counts()
 
         proto[i].num_flows = 0;
     }
+
+    if ( exp_cache )
+        exp_cache->reset_stats();
 }
 
 //-------------------------------------------------------------------------
@@ -133,19 +136,55 @@ bool FlowControl::prune_one(PruneReason reason, bool do_cleanup)
     return cache ? cache->prune_one(reason, do_cleanup) : false;
 }
 
+// packet time drives the wheels.  the wall clock is noted when the packet
+// second changes so idle ticks can tell how long it has been quiet.
 void FlowControl::timeout_flows(time_t cur_time)
 {
-    if ( types.empty() )
+    if ( cur_time > pkt_time )
+    {
+        pkt_time = cur_time;
+        pkt_wall_time = time(nullptr);
+    }
+    timeout_caches(cur_time, max_timeouts);
+}
+
+// idle ticks only advance the wheels by the wall time elapsed since the
+// last packet, so they never get ahead of where packet time would be.
+// when reading files the wall clock says nothing about packet time and
+// idle ticks are ignored.  idle calls release at most one flow per cache
+// since they can come much more often than once per second.
+void FlowControl::idle_timeout_flows(time_t wall_time)
+{
+    if ( SnortConfig::read_mode() or !pkt_time or wall_time <= pkt_wall_time )
+        return;
+
+    timeout_caches(pkt_time + (wall_time - pkt_wall_time), max_idle_timeouts);
+}
+
+// the caches time out flows in whole seconds so there is nothing to do
+// until the second changes or a cache has flows left over from the last
+// call.
+void FlowControl::timeout_caches(time_t cur_time, unsigned max_flows)
+{
+    if ( types.empty() or (cur_time <= last_timeout and !timeouts_pending) )
         return;
 
+    if ( cur_time > last_timeout )
+        last_timeout = cur_time;
+
+    timeouts_pending = false;
     Active::suspend();
-    FlowCache* fc = get_cache(types[next]);
 
-    if ( ++next >= types.size() )
-        next = 0;
+    for ( auto type : types )
+    {
+        if ( FlowCache* fc = get_cache(type) )
+        {
+            fc->timeout(max_flows, cur_time);
 
-    if ( fc )
-        fc->timeout(1, cur_time);
+            if ( fc->timeout_pending(cur_time) )
+                timeouts_pending = true;
+        }
+    }
 
     Active::resume();
 }
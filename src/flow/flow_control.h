@@ -66,6 +66,7 @@ public:
     bool prune_one(PruneReason, bool do_cleanup);
 
     void timeout_flows(time_t cur_time);
+    void idle_timeout_flows(time_t wall_time);
 
     bool expected_flow(snort::Flow*, snort::Packet*);
     bool is_expected(snort::Packet*);
@@ -90,6 +91,9 @@ public:
 
     void clear_counts();
 
+    const class ExpectCache* get_exp_cache() const
+    { return exp_cache; }
+
 private:
     FlowCache* get_cache(PktType pt)
     { return proto[to_utype(pt)].cache; }
@@ -98,6 +102,7 @@ private:
     { return proto[to_utype(pt)].cache; }
 
     void set_key(snort::FlowKey*, snort::Packet*);
+    void timeout_caches(time_t cur_time, unsigned max_flows);
 
     unsigned process(snort::Flow*, snort::Packet*);
     void preemptive_cleanup();
@@ -115,7 +120,16 @@ private:
     PktType last_pkt_type = PktType::NONE;
 
     std::vector<PktType> types;
-    unsigned next = 0;
+    time_t last_timeout = 0;
+    bool timeouts_pending = false;
+
+    // latest packet time and the wall clock when it was seen
+    time_t pkt_time = 0;
+    time_t pkt_wall_time = 0;
+
+    // idle flows released per cache per packet or idle call
+    static const unsigned max_timeouts = 16;
+    static const unsigned max_idle_timeouts = 1;
 };
 
 #endif
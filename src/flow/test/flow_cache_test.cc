@@ -0,0 +1,228 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// flow_cache_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "flow/flow_cache.h"
+
+#include "flow/flow.h"
+#include "flow/flow_key.h"
+#include "flow/ha.h"
+#include "main/snort_config.h"
+#include "packet_io/active.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+#define MAX_FLOWS 32
+#define TIMEOUT 10
+
+static time_t s_packet_time = 1000;
+static bool s_standby = false;
+
+//-------------------------------------------------------------------------
+// stubs
+//-------------------------------------------------------------------------
+
+time_t packet_time() { return s_packet_time; }
+
+char* snort_strdup(const char* str) { return strdup(str); }
+
+SnortConfig* SnortConfig::get_conf() { return nullptr; }
+
+void Active::suspend() { }
+void Active::resume() { }
+
+bool HighAvailabilityManager::in_standby(Flow*) { return s_standby; }
+
+Flow::Flow() { memset((void*)this, 0, sizeof(*this)); }
+void Flow::reset(bool) { }
+void Flow::term() { }
+
+//-------------------------------------------------------------------------
+// tests
+//-------------------------------------------------------------------------
+
+TEST_GROUP(flow_cache_timeout)
+{
+    FlowConfig config;
+    FlowCache* cache = nullptr;
+    Flow* flows = nullptr;
+    FlowKey keys[MAX_FLOWS];
+
+    void setup() override
+    {
+        config.max_sessions = MAX_FLOWS;
+        config.nominal_timeout = TIMEOUT;
+        config.pruning_timeout = 3 * TIMEOUT;
+
+        cache = new FlowCache(config);
+        flows = new Flow[MAX_FLOWS];
+
+        for ( unsigned i = 0; i < MAX_FLOWS; ++i )
+            cache->push(flows + i);
+
+        // only the ports differ
+        memset(keys, 0, sizeof(keys));
+
+        for ( unsigned i = 0; i < MAX_FLOWS; ++i )
+        {
+            keys[i].port_l = 53;
+            keys[i].port_h = 1000 + i;
+            keys[i].pkt_type = PktType::UDP;
+        }
+
+        s_packet_time = 1000;
+        s_standby = false;
+        cache->timeout(MAX_FLOWS, s_packet_time);
+    }
+
+    void teardown() override
+    {
+        delete cache;
+        delete[] flows;
+    }
+
+    void add(unsigned n)
+    {
+        for ( unsigned i = 0; i < n; ++i )
+            CHECK(cache->get(keys + i));
+    }
+};
+
+TEST(flow_cache_timeout, idle_flows_expire)
+{
+    add(4);
+
+    CHECK(cache->timeout(MAX_FLOWS, 1000 + TIMEOUT - 1) == 0);
+    CHECK(cache->get_count() == 4);
+
+    CHECK(cache->timeout(MAX_FLOWS, 1000 + TIMEOUT) == 4);
+    CHECK(cache->get_count() == 0);
+    CHECK(cache->get_prunes(PruneReason::IDLE) == 4);
+}
+
+TEST(flow_cache_timeout, active_flows_are_relinked)
+{
+    add(2);
+
+    s_packet_time = 1000 + TIMEOUT - 2;
+    CHECK(cache->find(keys));
+
+    // the active flow is filed again by its new due time
+    CHECK(cache->timeout(MAX_FLOWS, 1000 + TIMEOUT) == 1);
+    CHECK(cache->get_count() == 1);
+
+    CHECK(cache->timeout(MAX_FLOWS, s_packet_time + TIMEOUT - 1) == 0);
+    CHECK(cache->timeout(MAX_FLOWS, s_packet_time + TIMEOUT) == 1);
+    CHECK(cache->get_count() == 0);
+}
+
+TEST(flow_cache_timeout, standby_flows_are_kept)
+{
+    add(2);
+    s_standby = true;
+
+    CHECK(cache->timeout(MAX_FLOWS, 1000 + TIMEOUT) == 0);
+    CHECK(cache->get_count() == 2);
+
+    s_standby = false;
+
+    CHECK(cache->timeout(MAX_FLOWS, 1000 + 2 * TIMEOUT - 1) == 0);
+    CHECK(cache->timeout(MAX_FLOWS, 1000 + 2 * TIMEOUT) == 2);
+}
+
+TEST(flow_cache_timeout, releases_are_bounded)
+{
+    add(20);
+
+    time_t now = 1000 + TIMEOUT;
+
+    CHECK(cache->timeout(8, now) == 8);
+    CHECK(cache->timeout_pending(now));
+
+    // the rest carry over, even within the same second
+    CHECK(cache->timeout(8, now) == 8);
+    CHECK(cache->timeout_pending(now));
+
+    CHECK(cache->timeout(8, now) == 4);
+    CHECK_FALSE(cache->timeout_pending(now));
+    CHECK(cache->get_count() == 0);
+}
+
+TEST(flow_cache_timeout, bounded_over_a_full_turn)
+{
+    add(20);
+
+    // like an idle tick with the wall clock far ahead of packet time
+    time_t now = 1000 + 100000;
+    unsigned retired = 0;
+    unsigned calls = 0;
+
+    do
+    {
+        retired += cache->timeout(8, now);
+        ++calls;
+    }
+    while ( cache->timeout_pending(now) and calls < 10 );
+
+    CHECK(retired == 20);
+    CHECK(calls == 3);
+    CHECK(cache->get_count() == 0);
+}
+
+TEST(flow_cache_timeout, time_moves_backward)
+{
+    add(4);
+
+    CHECK(cache->timeout(MAX_FLOWS, 500) == 0);
+    CHECK(cache->get_count() == 4);
+
+    CHECK(cache->timeout(MAX_FLOWS, 1000 + TIMEOUT) == 4);
+    CHECK(cache->get_count() == 0);
+}
+
+TEST(flow_cache_timeout, filed_while_wheel_is_ahead)
+{
+    // an idle tick moved the wheel a few seconds past packet time
+    time_t ahead = 1000 + TIMEOUT + 5;
+    CHECK(cache->timeout(MAX_FLOWS, ahead) == 0);
+
+    s_packet_time = 1002;
+    add(2);
+
+    // packets behind the wheel neither move it back nor release early
+    CHECK(cache->timeout(MAX_FLOWS, s_packet_time + TIMEOUT) == 0);
+    CHECK_FALSE(cache->timeout_pending(ahead));
+    CHECK(cache->get_count() == 2);
+
+    // the flows were filed in the next slot the wheel checks
+    CHECK(cache->timeout(MAX_FLOWS, ahead + 1) == 2);
+    CHECK(cache->get_count() == 0);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
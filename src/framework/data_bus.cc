@@ -29,6 +29,8 @@
 
 using namespace snort;
 
+static unsigned s_subscriptions = 0;
+
 static DataBus& get_data_bus()
 { return snort::get_inspection_policy()->dbus; }
 
@@ -137,6 +139,12 @@ void DataBus::_subscribe(const char* key, DataHandler* h)
 {
     DataList& v = map[key];
     v.push_back(h);
+    ++s_subscriptions;
+}
+
+unsigned DataBus::get_subscriptions()
+{
+    return s_subscriptions;
 }
 
 void DataBus::_unsubscribe(const char* key, DataHandler* h)
@@ -86,6 +86,10 @@ public:
     static void unsubscribe_default(const char* key, DataHandler*);
     static void publish(const char* key, DataEvent&, Flow* = nullptr);
 
+    // total subscriptions made to any bus; lets callers tell whether
+    // constructing or configuring something subscribed
+    static unsigned get_subscriptions();
+
     // convenience methods
     static void publish(const char* key, const uint8_t*, unsigned, Flow* = nullptr);
     static void publish(const char* key, Packet*, Flow* = nullptr);
@@ -69,6 +69,11 @@ public:
     // access external dependencies here
     // return verification status
     virtual bool configure(SnortConfig*) { return true; }
+
+    // set what this instance puts in the config; called after configure()
+    // and again for each config that reuses the instance on reload
+    virtual void apply(SnortConfig*) { }
+
     virtual void show(SnortConfig*) { }
     virtual void update(SnortConfig*, const char*) { }
 
@@ -63,6 +63,13 @@ public:
 
     virtual int prep_patterns(SnortConfig*) = 0;
 
+    // engines flagged MPSE_MTBLD split prep_patterns() in two:  compile()
+    // builds the state machine and may run on any thread concurrently
+    // with other instances; build_trees() must then be called serially
+    // on the main thread since it updates the shared detection config.
+    virtual int compile(SnortConfig*) { return 0; }
+    virtual int build_trees(SnortConfig*) { return 0; }
+
     int search(
         const uint8_t* T, int n, MpseMatch, void* context, int* current_state);
 
@@ -72,6 +79,7 @@ public:
     virtual void set_opt(int) { }
     virtual int print_info() { return 0; }
     virtual int get_pattern_count() { return 0; }
+    virtual size_t get_memory_used() { return 0; }
 
     const char* get_method() { return method.c_str(); }
     void set_verbose(bool b = true) { verbose = b; }
@@ -104,6 +112,7 @@ typedef void (* MpseDelFunc)(Mpse*);
 #define MPSE_BASE   0x00
 #define MPSE_TRIM   0x01
 #define MPSE_REGEX  0x02
+#define MPSE_MTBLD  0x04
 
 struct MpseApi
 {
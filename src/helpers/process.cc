@@ -24,7 +24,7 @@
 
 #include <fcntl.h>
 
-#if defined(HAVE_MALLINFO) || defined(HAVE_MALLOC_TRIM)
+#if defined(HAVE_MALLINFO) || defined(HAVE_MALLINFO2) || defined(HAVE_MALLOC_TRIM)
 #include <malloc.h>
 #endif
 
@@ -376,6 +376,20 @@ void trim_heap()
 #endif
 }
 
+// mallinfo's int fields wrap past 2 GB so mallinfo2 is preferred
+uint64_t get_heap_usage()
+{
+#if defined(HAVE_MALLINFO2)
+    struct mallinfo2 mi = mallinfo2();
+    return (uint64_t)mi.uordblks + (uint64_t)mi.hblkhd;
+#elif defined(HAVE_MALLINFO)
+    struct mallinfo mi = mallinfo();
+    return (uint64_t)(unsigned)mi.uordblks + (unsigned)mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
 void log_malloc_info()
 {
 #ifdef HAVE_MALLINFO
@@ -21,6 +21,8 @@
 
 // process oriented services like signal handling, heap info, etc.
 
+#include <cstdint>
+
 enum PigSignal
 {
     PIG_SIG_NONE,
@@ -47,6 +49,7 @@ void set_main_thread();
 
 void trim_heap();
 void log_malloc_info();
+uint64_t get_heap_usage();  // bytes in use or 0 if unknown
 
 #endif
 
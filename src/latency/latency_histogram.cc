@@ -0,0 +1,227 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// latency_histogram.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "latency_histogram.h"
+
+#include <cmath>
+#include <mutex>
+
+#include "log/messages.h"
+#include "main/snort_config.h"
+#include "utils/stats.h"
+
+#include "latency_config.h"
+
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
+using namespace snort;
+
+// -----------------------------------------------------------------------------
+// histogram
+// -----------------------------------------------------------------------------
+
+void LatencyHistogram::merge(const LatencyHistogram& rhs)
+{
+    for ( unsigned i = 0; i < num_buckets; ++i )
+        buckets[i] += rhs.buckets[i];
+
+    count += rhs.count;
+
+    if ( rhs.max > max )
+        max = rhs.max;
+}
+
+void LatencyHistogram::reset()
+{
+    for ( unsigned i = 0; i < num_buckets; ++i )
+        buckets[i] = 0;
+
+    count = max = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double pct) const
+{
+    if ( !count )
+        return 0;
+
+    uint64_t rank = (uint64_t)std::ceil(pct / 100.0 * count);
+
+    if ( !rank )
+        rank = 1;
+
+    uint64_t sum = 0;
+
+    for ( unsigned i = 0; i < num_buckets; ++i )
+    {
+        sum += buckets[i];
+
+        if ( sum >= rank )
+        {
+            uint64_t ub = upper_bound(i);
+            return ub < max ? ub : max;
+        }
+    }
+    return max;
+}
+
+// -----------------------------------------------------------------------------
+// per thread stages
+// -----------------------------------------------------------------------------
+
+THREAD_LOCAL LatencyHistogram* LatencyHistograms::local = nullptr;
+
+static const char* const s_stages[LatencyHistograms::MAX_STAGE] =
+{ "total", "decode", "stream", "inspect", "detect", "log" };
+
+static std::mutex s_mutex;
+static LatencyHistogram s_totals[LatencyHistograms::MAX_STAGE];  // exited threads
+static LatencyHistogram s_dump[LatencyHistograms::MAX_STAGE];    // live threads
+
+static void merge(LatencyHistogram* to, const LatencyHistogram* from)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    for ( unsigned i = 0; i < LatencyHistograms::MAX_STAGE; ++i )
+        to[i].merge(from[i]);
+}
+
+static uint64_t to_usecs(uint64_t ticks)
+{ return clock_usecs(TO_USECS(hr_duration(ticks))); }
+
+static void show(const char* title, const LatencyHistogram* hist)
+{
+    if ( !hist[LatencyHistograms::TOTAL].get_count() )
+        return;
+
+    LogLabel(title);
+    LogMessage("%12s %12s %10s %10s %10s %10s\n",
+        "stage", "count", "p50", "p99", "p99.9", "max");
+
+    for ( unsigned i = 0; i < LatencyHistograms::MAX_STAGE; ++i )
+    {
+        const LatencyHistogram& h = hist[i];
+
+        if ( !h.get_count() )
+            continue;
+
+        LogMessage("%12s %12" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+            s_stages[i], h.get_count(), to_usecs(h.percentile(50.0)),
+            to_usecs(h.percentile(99.0)), to_usecs(h.percentile(99.9)), to_usecs(h.get_max()));
+    }
+}
+
+void LatencyHistograms::tinit()
+{
+    if ( SnortConfig::get_conf()->latency->packet_latency.histograms )
+        local = new LatencyHistogram[MAX_STAGE];
+}
+
+void LatencyHistograms::tterm()
+{
+    if ( !local )
+        return;
+
+    merge(s_totals, local);
+    delete[] local;
+    local = nullptr;
+}
+
+const LatencyHistogram* LatencyHistograms::get_local(Stage s)
+{ return local ? local + s : nullptr; }
+
+void LatencyHistograms::accumulate_dump()
+{
+    if ( local )
+        merge(s_dump, local);
+}
+
+void LatencyHistograms::show_dump()
+{
+    show("latency histograms (usecs)", s_dump);
+
+    for ( unsigned i = 0; i < MAX_STAGE; ++i )
+        s_dump[i].reset();
+}
+
+void LatencyHistograms::show_stats()
+{ show("latency histograms (usecs)", s_totals); }
+
+// -----------------------------------------------------------------------------
+// unit tests
+// -----------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+TEST_CASE ( "latency histogram", "[latency]" )
+{
+    SECTION( "buckets" )
+    {
+        for ( uint64_t v : { 0ULL, 15ULL, 16ULL, 17ULL, 1000ULL, 123456789ULL, ~0ULL } )
+        {
+            unsigned i = LatencyHistogram::index(v);
+            CHECK( i < LatencyHistogram::num_buckets );
+            CHECK( v <= LatencyHistogram::upper_bound(i) );
+
+            if ( i )
+                CHECK( v > LatencyHistogram::upper_bound(i - 1) );
+        }
+    }
+
+    SECTION( "percentiles" )
+    {
+        LatencyHistogram h;
+
+        for ( uint64_t v = 1; v <= 1000; ++v )
+            h.record(v);
+
+        CHECK( h.get_count() == 1000 );
+        CHECK( h.get_max() == 1000 );
+
+        // within a bucket width of the exact value
+        CHECK( h.percentile(50.0) >= 500 );
+        CHECK( h.percentile(50.0) < 500 + 500 / LatencyHistogram::sub_count + 1 );
+        CHECK( h.percentile(99.0) >= 990 );
+        CHECK( h.percentile(100.0) == 1000 );
+    }
+
+    SECTION( "merge" )
+    {
+        LatencyHistogram a, b;
+        a.record(10);
+        b.record(20000);
+        a.merge(b);
+
+        CHECK( a.get_count() == 2 );
+        CHECK( a.get_max() == 20000 );
+        CHECK( a.percentile(50.0) == 10 );
+
+        a.reset();
+        CHECK( !a.get_count() );
+        CHECK( !a.percentile(50.0) );
+    }
+}
+
+#endif
@@ -0,0 +1,144 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// latency_histogram.h
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+// log-linear (hdr style) histograms of packet processing time.  each value
+// lands in one of 16 linear buckets per power of 2 so recording is just a
+// bit scan and an increment and percentiles are within about 6%.
+
+#include <cstdint>
+
+#include "main/thread.h"
+#include "time/clock_defs.h"
+
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned sub_bits = 4;
+    static constexpr unsigned sub_count = 1 << sub_bits;
+    static constexpr unsigned num_buckets = (64 - sub_bits + 1) * sub_count;
+
+    void record(uint64_t ticks)
+    {
+        ++buckets[index(ticks)];
+        ++count;
+
+        if ( ticks > max )
+            max = ticks;
+    }
+
+    void merge(const LatencyHistogram&);
+    void reset();
+
+    uint64_t get_count() const
+    { return count; }
+
+    uint64_t get_max() const
+    { return max; }
+
+    // returns ticks; pct is 0 to 100
+    uint64_t percentile(double pct) const;
+
+    static unsigned index(uint64_t ticks)
+    {
+        if ( ticks < sub_count )
+            return ticks;
+
+        unsigned msb = 63 - __builtin_clzll(ticks);
+        unsigned sub = (ticks >> (msb - sub_bits)) & (sub_count - 1);
+        return ((msb - sub_bits + 1) << sub_bits) + sub;
+    }
+
+    // highest value that maps to the bucket
+    static uint64_t upper_bound(unsigned idx)
+    {
+        if ( idx < sub_count )
+            return idx;
+
+        unsigned octave = idx >> sub_bits;
+        unsigned sub = idx & (sub_count - 1);
+        return ((uint64_t)(sub_count + sub + 1) << (octave - 1)) - 1;
+    }
+
+private:
+    uint64_t buckets[num_buckets] = { };
+    uint64_t count = 0;
+    uint64_t max = 0;
+};
+
+class LatencyHistograms
+{
+public:
+    // stages are timed inclusively; stream and inspect also contain the
+    // stages of any pdus they rebuild and flush
+    enum Stage
+    {
+        TOTAL,
+        DECODE,
+        STREAM,
+        INSPECT,
+        DETECT,
+        LOG,
+        MAX_STAGE
+    };
+
+    static void tinit();
+    static void tterm();
+
+    // thread local histograms from the current packet thread
+    static const LatencyHistogram* get_local(Stage);
+
+    // add this thread's histograms to the shell dump
+    static void accumulate_dump();
+
+    // call from main thread
+    static void show_dump();
+    static void show_stats();
+
+    class Context
+    {
+    public:
+        Context(Stage s) : hist(local ? local + s : nullptr)
+        {
+            if ( hist )
+                start = SnortClock::now();
+        }
+
+        ~Context()
+        {
+            if ( hist )
+            {
+                hr_duration elapsed = SnortClock::now() - start;
+                hist->record(TO_TICKS(elapsed));
+            }
+        }
+
+    private:
+        LatencyHistogram* hist;
+        hr_time start;
+    };
+
+private:
+    static THREAD_LOCAL LatencyHistogram* local;
+};
+
+#endif
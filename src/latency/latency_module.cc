@@ -26,9 +26,11 @@
 
 #include <chrono>
 
+#include "main/analyzer_command.h"
 #include "main/snort_config.h"
 
 #include "latency_config.h"
+#include "latency_histogram.h"
 #include "latency_rules.h"
 #include "latency_stats.h"
 
@@ -50,6 +52,9 @@ static const Parameter s_packet_params[] =
     { "fastpath", Parameter::PT_BOOL, nullptr, "false",
         "fastpath expensive packets (max_time exceeded)" },
 
+    { "histograms", Parameter::PT_BOOL, nullptr, "false",
+        "track percentiles of total packet time and of each processing stage" },
+
     { "action", Parameter::PT_ENUM, "none | alert | log | alert_and_log", "none",
         "event action if packet times out and is fastpathed" },
 
@@ -72,6 +77,9 @@ static const Parameter s_rule_params[] =
     { "max_suspend_time", Parameter::PT_INT, "0:", "30000",
         "set max time for suspending a rule (ms, 0 means permanently disable rule)" },
 
+    { "budget", Parameter::PT_INT, "0:", "0",
+        "per packet rule evaluation budget; skip rule trees expected to exceed what is left (usec, 0 disables; independent of max_time)" },
+
     { "action", Parameter::PT_ENUM, "none | alert | log | alert_and_log", "none",
         "event action for rule latency enable and suspend events" },
 
@@ -89,6 +97,38 @@ static const Parameter s_params[] =
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+// -----------------------------------------------------------------------------
+// latency commands
+// -----------------------------------------------------------------------------
+
+class LatencyDump : public AnalyzerCommand
+{
+public:
+    void execute(Analyzer&) override
+    { LatencyHistograms::accumulate_dump(); }
+
+    const char* stringify() override
+    { return "LATENCY_DUMP"; }
+
+    ~LatencyDump() override
+    { LatencyHistograms::show_dump(); }
+};
+
+static int dump_histograms(lua_State* L)
+{
+    bool from_shell = ( L != nullptr );
+    main_broadcast_command(new LatencyDump, from_shell);
+    return 0;
+}
+
+static const Command latency_cmds[] =
+{
+    { "dump_histograms", dump_histograms, nullptr,
+      "show packet time percentiles from all packet threads" },
+
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 static const RuleMap latency_rules[] =
 {
     { LATENCY_EVENT_RULE_TREE_SUSPENDED, "rule tree suspended due to latency" },
@@ -109,6 +149,11 @@ static const PegInfo latency_pegs[] =
     { CountType::SUM, "total_rule_evals", "total rule evals monitored" },
     { CountType::SUM, "rule_eval_timeouts", "rule evals that timed out" },
     { CountType::SUM, "rule_tree_enables", "rule tree re-enables" },
+    { CountType::SUM, "rule_tree_skips", "rule tree evals skipped to stay within the packet budget" },
+    { CountType::SUM, "rule_budget_exhausted", "packets that skipped rule trees for lack of budget" },
+    { CountType::MAX, "packet_p50_usecs", "median packet usecs (max across threads)" },
+    { CountType::MAX, "packet_p99_usecs", "99th percentile packet usecs (max across threads)" },
+    { CountType::MAX, "packet_p999_usecs", "99.9th percentile packet usecs (max across threads)" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -126,6 +171,9 @@ static inline bool latency_set(Value& v, PacketLatencyConfig& config)
     else if ( v.is("fastpath") )
         config.fastpath = v.get_bool();
 
+    else if ( v.is("histograms") )
+        config.histograms = v.get_bool();
+
     else if ( v.is("action") )
         config.action =
             static_cast<decltype(config.action)>(v.get_long());
@@ -153,6 +201,11 @@ static inline bool latency_set(Value& v, RuleLatencyConfig& config)
         long t = clock_ticks(v.get_long());
         config.max_suspend_time = TO_DURATION(config.max_time, t);
     }
+    else if ( v.is("budget") )
+    {
+        long t = clock_ticks(v.get_long());
+        config.budget = TO_DURATION(config.budget, t);
+    }
     else if ( v.is("action") )
         config.action =
             static_cast<decltype(config.action)>(v.get_long());
@@ -180,6 +233,9 @@ bool LatencyModule::set(const char* fqn, Value& v, SnortConfig* sc)
     return false;
 }
 
+const Command* LatencyModule::get_commands() const
+{ return latency_cmds; }
+
 const RuleMap* LatencyModule::get_rules() const
 { return latency_rules; }
 
@@ -191,3 +247,21 @@ const PegInfo* LatencyModule::get_pegs() const
 
 PegCount* LatencyModule::get_counts() const
 { return reinterpret_cast<PegCount*>(&latency_stats); }
+
+void LatencyModule::prep_counts()
+{
+    const LatencyHistogram* h = LatencyHistograms::get_local(LatencyHistograms::TOTAL);
+
+    if ( !h )
+        return;
+
+    latency_stats.packet_p50_usecs = clock_usecs(TO_USECS(hr_duration(h->percentile(50.0))));
+    latency_stats.packet_p99_usecs = clock_usecs(TO_USECS(hr_duration(h->percentile(99.0))));
+    latency_stats.packet_p999_usecs = clock_usecs(TO_USECS(hr_duration(h->percentile(99.9))));
+}
+
+void LatencyModule::show_stats()
+{
+    Module::show_stats();
+    LatencyHistograms::show_stats();
+}
@@ -30,12 +30,19 @@ public:
 
     bool set(const char*, snort::Value&, snort::SnortConfig*) override;
 
+    const snort::Command* get_commands() const override;
     const snort::RuleMap* get_rules() const override;
     unsigned get_gid() const override;
 
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
 
+    bool counts_need_prep() const override
+    { return true; }
+
+    void prep_counts() override;
+    void show_stats() override;
+
     Usage get_usage() const override
     { return CONTEXT; }
 };
@@ -33,6 +33,11 @@ struct LatencyStats
     PegCount total_rule_evals;
     PegCount rule_eval_timeouts;
     PegCount rule_tree_enables;
+    PegCount rule_tree_skips;
+    PegCount rule_budget_exhausted;
+    PegCount packet_p50_usecs;
+    PegCount packet_p99_usecs;
+    PegCount packet_p999_usecs;
 };
 
 extern THREAD_LOCAL LatencyStats latency_stats;
@@ -35,6 +35,7 @@ struct PacketLatencyConfig
 
     hr_duration max_time = CLOCK_ZERO;
     bool fastpath = false;
+    bool histograms = false;
     Action action = NONE;
 
     bool enabled() const { return max_time > CLOCK_ZERO; }
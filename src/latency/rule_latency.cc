@@ -72,12 +72,28 @@ class RuleTimer : public LatencyTimer<Clock>
 {
 public:
     RuleTimer(typename Clock::duration d, detection_option_tree_root_t* root, Packet* p) :
-        LatencyTimer<Clock>(d), root(root), packet(p) { }
+        LatencyTimer<Clock>(d), root(root), packet(p), bytes(p->dsize) { }
 
     detection_option_tree_root_t* root;
     Packet* packet;
+    unsigned bytes;
+
+    // cost model
+    bool skipped = false;
+    bool first_skip = false;
+    bool matched = false;
 };
 
+// the cost model needs this many evals of a tree before it will skip it
+static constexpr uint64_t min_cost_samples = 16;
+
+// trees that match at least this often are never skipped for budget
+static constexpr double keep_match_rate = 0.01;
+
+// skipped evals don't feed the model, so after this many skips in a row a
+// tree is evaluated anyway to let a stale estimate come back down
+static constexpr unsigned max_skip_streak = 64;
+
 using ConfigWrapper = ReferenceWrapper<RuleLatencyConfig>;
 using EventHandler = EventingWrapper<Event>;
 
@@ -178,6 +194,32 @@ struct DefaultRuleInterface
 
         return false;
     }
+
+    // return true if the tree is expected to cost more than remains
+    // and it hasn't been skipped too many times in a row
+    template<typename Duration>
+    static bool too_expensive(detection_option_tree_root_t& root, unsigned bytes,
+        Duration remaining)
+    {
+        auto& state = root.latency_state[get_instance_id()];
+
+        if ( state.samples < min_cost_samples or state.match_rate >= keep_match_rate )
+            return false;
+
+        if ( state.estimate(bytes) <= remaining )
+            return false;
+
+        if ( ++state.skips < max_skip_streak )
+            return true;
+
+        state.skips = 0;
+        return false;
+    }
+
+    template<typename Duration>
+    static void update_cost(detection_option_tree_root_t& root, Duration cost, unsigned bytes,
+        bool matched)
+    { root.latency_state[get_instance_id()].update(cost, bytes, matched); }
 };
 
 // -----------------------------------------------------------------------------
@@ -194,13 +236,23 @@ public:
     bool pop();
     bool suspended() const;
 
+    bool skipped() const;
+    bool exhausted() const;
+    void matched();
+
 private:
     void handle(const Event&);
+    void check_budget(RuleTimer<Clock>&);
 
     std::vector<RuleTimer<Clock>> timers;
     const ConfigWrapper& config;
     EventHandler& event_handler;
     EventHandler& log_handler;
+
+    // rule eval time charged to the current packet
+    uint64_t budget_packet = 0;
+    hr_duration budget_used = 0_ticks;
+    bool budget_exhausted = false;
 };
 
 template<typename Clock, typename RuleTree>
@@ -216,17 +268,50 @@ inline bool Impl<Clock, RuleTree>::push(detection_option_tree_root_t* root, Pack
     // FIXIT-L rule timer is pushed even if rule is not enabled (no visible side-effects)
     timers.emplace_back(config->max_time, root, p);
 
+    bool reenabled = false;
+
     if ( config->allow_reenable() )
     {
         if ( RuleTree::reenable(*root, config->max_suspend_time, Clock::now()) )
         {
             Event e { Event::EVENT_ENABLED, config->max_suspend_time, root, p };
             handle(e);
-            return true;
+            reenabled = true;
         }
     }
 
-    return false;
+    if ( config->use_budget() )
+        check_budget(timers.back());
+
+    return reenabled;
+}
+
+template<typename Clock, typename RuleTree>
+inline void Impl<Clock, RuleTree>::check_budget(RuleTimer<Clock>& timer)
+{
+    // pseudo packets share the budget of the wire packet they came from
+    if ( budget_packet != pc.total_from_daq )
+    {
+        budget_packet = pc.total_from_daq;
+        budget_used = 0_ticks;
+        budget_exhausted = false;
+    }
+
+    // nested evals are charged to the outermost tree
+    if ( timers.size() > 1 )
+        return;
+
+    hr_duration remaining = 0_ticks;
+
+    if ( budget_used < config->budget )
+        remaining = config->budget - budget_used;
+
+    if ( RuleTree::too_expensive(*timer.root, timer.bytes, remaining) )
+    {
+        timer.skipped = true;
+        timer.first_skip = !budget_exhausted;
+        budget_exhausted = true;
+    }
 }
 
 template<typename Clock, typename RuleTree>
@@ -237,9 +322,18 @@ inline bool Impl<Clock, RuleTree>::pop()
 
     bool timed_out = false;
 
-    if ( !RuleTree::is_suspended(*timer.root) )
+    if ( !timer.skipped and !RuleTree::is_suspended(*timer.root) )
     {
-        timed_out = timer.timed_out();
+        if ( config->use_budget() )
+        {
+            auto elapsed = timer.elapsed();
+            RuleTree::update_cost(*timer.root, elapsed, timer.bytes, timer.matched);
+
+            if ( timers.size() == 1 )
+                budget_used += elapsed;
+        }
+
+        timed_out = config->enabled() and timer.timed_out();
 
         if ( timed_out )
         {
@@ -270,6 +364,27 @@ inline bool Impl<Clock, RuleTree>::suspended() const
     return RuleTree::is_suspended(*timers.back().root);
 }
 
+template<typename Clock, typename RuleTree>
+inline bool Impl<Clock, RuleTree>::skipped() const
+{
+    assert(!timers.empty());
+    return timers.back().skipped;
+}
+
+template<typename Clock, typename RuleTree>
+inline bool Impl<Clock, RuleTree>::exhausted() const
+{
+    assert(!timers.empty());
+    return timers.back().first_skip;
+}
+
+template<typename Clock, typename RuleTree>
+inline void Impl<Clock, RuleTree>::matched()
+{
+    assert(!timers.empty());
+    timers.back().matched = true;
+}
+
 template<typename Clock, typename RuleTree>
 inline void Impl<Clock, RuleTree>::handle(const Event& e)
 {
@@ -339,7 +454,7 @@ static inline Impl<>& get_impl()
 
 void RuleLatency::push(detection_option_tree_root_t* root, Packet* p)
 {
-    if ( rule_latency::config->enabled() )
+    if ( rule_latency::config->timed() )
     {
         if ( rule_latency::get_impl().push(root, p) )
             ++latency_stats.rule_tree_enables;
@@ -350,7 +465,7 @@ void RuleLatency::push(detection_option_tree_root_t* root, Packet* p)
 
 void RuleLatency::pop()
 {
-    if ( rule_latency::config->enabled() )
+    if ( rule_latency::config->timed() )
     {
         if ( rule_latency::get_impl().pop() )
             ++latency_stats.rule_eval_timeouts;
@@ -359,12 +474,32 @@ void RuleLatency::pop()
 
 bool RuleLatency::suspended()
 {
-    if ( rule_latency::config->enabled() )
-        return rule_latency::get_impl().suspended();
+    if ( rule_latency::config->timed() )
+    {
+        auto& impl = rule_latency::get_impl();
+
+        if ( impl.skipped() )
+        {
+            ++latency_stats.rule_tree_skips;
+
+            if ( impl.exhausted() )
+                ++latency_stats.rule_budget_exhausted;
+
+            return true;
+        }
+
+        return impl.suspended();
+    }
 
     return false;
 }
 
+void RuleLatency::matched()
+{
+    if ( rule_latency::config->timed() )
+        rule_latency::get_impl().matched();
+}
+
 void RuleLatency::tterm()
 {
     using rule_latency::impl;
@@ -424,6 +559,8 @@ struct RuleInterfaceSpy
     static bool reenable_called;
     static bool timeout_and_suspend_result;
     static bool timeout_and_suspend_called;
+    static bool too_expensive_result;
+    static bool update_cost_called;
 
     static void reset()
     {
@@ -433,6 +570,8 @@ struct RuleInterfaceSpy
         reenable_called = false;
         timeout_and_suspend_result = false;
         timeout_and_suspend_called = false;
+        too_expensive_result = false;
+        update_cost_called = false;
     }
 
     static bool is_suspended(const detection_option_tree_root_t&)
@@ -445,6 +584,14 @@ struct RuleInterfaceSpy
     template<typename Time>
     static bool timeout_and_suspend(detection_option_tree_root_t&, unsigned, Time, bool)
     { timeout_and_suspend_called = true; return timeout_and_suspend_result; }
+
+    template<typename Duration>
+    static bool too_expensive(detection_option_tree_root_t&, unsigned, Duration)
+    { return too_expensive_result; }
+
+    template<typename Duration>
+    static void update_cost(detection_option_tree_root_t&, Duration, unsigned, bool)
+    { update_cost_called = true; }
 };
 
 bool RuleInterfaceSpy::is_suspended_result = false;
@@ -453,6 +600,8 @@ bool RuleInterfaceSpy::reenable_result = false;
 bool RuleInterfaceSpy::reenable_called = false;
 bool RuleInterfaceSpy::timeout_and_suspend_result = false;
 bool RuleInterfaceSpy::timeout_and_suspend_called = false;
+bool RuleInterfaceSpy::too_expensive_result = false;
+bool RuleInterfaceSpy::update_cost_called = false;
 
 } // namespace t_rule_latency
 
@@ -590,6 +739,53 @@ TEST_CASE ( "rule latency impl", "[latency]" )
             CHECK_FALSE( RuleInterfaceSpy::timeout_and_suspend_called );
         }
     }
+
+    SECTION( "budget" )
+    {
+        config.config.budget = 10_ticks;
+        ++pc.total_from_daq;
+
+        SECTION( "tree within budget" )
+        {
+            impl.push(&root, &pkt);
+            CHECK_FALSE( impl.skipped() );
+            CHECK_FALSE( impl.suspended() );
+
+            MockClock::inc(2_ticks);
+            impl.pop();
+            CHECK( RuleInterfaceSpy::update_cost_called );
+        }
+
+        SECTION( "tree too expensive" )
+        {
+            RuleInterfaceSpy::too_expensive_result = true;
+
+            impl.push(&root, &pkt);
+            CHECK( impl.skipped() );
+            CHECK( impl.exhausted() );
+            CHECK_FALSE( impl.pop() );
+            CHECK_FALSE( RuleInterfaceSpy::update_cost_called );
+
+            // only the first skip per packet counts as exhausting the budget
+            impl.push(&root, &pkt);
+            CHECK( impl.skipped() );
+            CHECK_FALSE( impl.exhausted() );
+            impl.pop();
+        }
+
+        SECTION( "budget without max time" )
+        {
+            REQUIRE_FALSE( config.config.enabled() );
+            CHECK( config.config.timed() );
+
+            impl.push(&root, &pkt);
+            MockClock::inc(2_ticks);
+
+            CHECK_FALSE( impl.pop() );
+            CHECK( RuleInterfaceSpy::update_cost_called );
+            CHECK_FALSE( RuleInterfaceSpy::timeout_and_suspend_called );
+        }
+    }
 }
 
 TEST_CASE ( "default latency rule interface", "[latency]" )
@@ -675,6 +871,51 @@ TEST_CASE ( "default latency rule interface", "[latency]" )
             CHECK( child_state[0].latency_suspends == 0 );
         }
     }
+
+    SECTION( "cost model" )
+    {
+        SECTION( "too few samples" )
+        {
+            RuleInterface::update_cost(root, 100_ticks, 10, false);
+            CHECK_FALSE( RuleInterface::too_expensive(root, 10, 1_ticks) );
+        }
+
+        SECTION( "settled" )
+        {
+            for ( unsigned i = 0; i < 16; ++i )
+                RuleInterface::update_cost(root, 100_ticks, 10, false);
+
+            CHECK( RuleInterface::too_expensive(root, 10, 50_ticks) );
+            CHECK_FALSE( RuleInterface::too_expensive(root, 10, 200_ticks) );
+
+            // cost scales with the data to inspect
+            CHECK( RuleInterface::too_expensive(root, 100, 200_ticks) );
+        }
+
+        SECTION( "skip streak" )
+        {
+            for ( unsigned i = 0; i < 16; ++i )
+                RuleInterface::update_cost(root, 100_ticks, 10, false);
+
+            for ( unsigned i = 1; i < rule_latency::max_skip_streak; ++i )
+                CHECK( RuleInterface::too_expensive(root, 10, 50_ticks) );
+
+            // then one probe eval refreshes the estimate
+            CHECK_FALSE( RuleInterface::too_expensive(root, 10, 50_ticks) );
+            RuleInterface::update_cost(root, 10_ticks, 10, false);
+
+            CHECK( RuleInterface::too_expensive(root, 10, 50_ticks) );
+            CHECK( root.latency_state[get_instance_id()].skips == 1 );
+        }
+
+        SECTION( "matching trees are kept" )
+        {
+            for ( unsigned i = 0; i < 16; ++i )
+                RuleInterface::update_cost(root, 100_ticks, 10, true);
+
+            CHECK_FALSE( RuleInterface::too_expensive(root, 10, 0_ticks) );
+        }
+    }
 }
 
 #endif
@@ -33,6 +33,7 @@ public:
     static void push(detection_option_tree_root_t*, snort::Packet*);
     static void pop();
     static bool suspended();
+    static void matched();
 
     static void tterm();
 
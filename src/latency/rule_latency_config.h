@@ -37,10 +37,15 @@ struct RuleLatencyConfig
     bool suspend = false;
     unsigned suspend_threshold = 0;
     hr_duration max_suspend_time = 0_ticks;
+    hr_duration budget = 0_ticks;
     Action action = NONE;
 
     bool enabled() const { return max_time > 0_ticks; }
     bool allow_reenable() const { return max_suspend_time > 0_ticks; }
+    bool use_budget() const { return budget > 0_ticks; }
+
+    // the budget works w/o max_time so either one needs the rule timers
+    bool timed() const { return enabled() or use_budget(); }
 };
 
 #endif
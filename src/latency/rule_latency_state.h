@@ -21,6 +21,8 @@
 #ifndef RULE_LATENCY_STATE_H
 #define RULE_LATENCY_STATE_H
 
+#include <cstdint>
+
 #include "time/clock_defs.h"
 
 struct RuleLatencyState
@@ -29,6 +31,30 @@ struct RuleLatencyState
     unsigned timeouts = 0;
     bool suspended = false;
 
+    // adaptive cost model; moving averages over this thread's evals
+    double avg_ticks = 0.0;
+    double avg_bytes = 0.0;
+    double match_rate = 0.0;
+    uint64_t samples = 0;
+    unsigned skips = 0;  // consecutive evals skipped for budget
+
+    void update(hr_duration cost, unsigned bytes, bool matched)
+    {
+        skips = 0;
+
+        // first sample seeds the averages, then weight new samples 1/16
+        const double w = samples ? 1.0 / 16 : 1.0;
+
+        avg_ticks += w * ((double)TO_TICKS(cost) - avg_ticks);
+        avg_bytes += w * ((double)bytes - avg_bytes);
+        match_rate += w * ((matched ? 1.0 : 0.0) - match_rate);
+        ++samples;
+    }
+
+    // expected cost of evaluating bytes of data, scaled by cost per byte
+    hr_duration estimate(unsigned bytes) const
+    { return hr_duration((hr_duration::rep)(avg_ticks * (bytes + 1) / (avg_bytes + 1))); }
+
     void enable()
     {
         timeouts = 0;
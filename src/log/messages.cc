@@ -25,6 +25,7 @@
 
 #include <syslog.h>
 
+#include <atomic>
 #include <cassert>
 #include <cstdarg>
 #include <cstdio>
@@ -37,21 +38,18 @@
 
 static int already_fatal = 0;
 
-static unsigned parse_errors = 0;
-static unsigned parse_warnings = 0;
+// atomic since search engines may report errors from compile threads
+static std::atomic<unsigned> parse_errors { 0 };
+static std::atomic<unsigned> parse_warnings { 0 };
 
 unsigned get_parse_errors()
 {
-    unsigned tmp = parse_errors;
-    parse_errors = 0;
-    return tmp;
+    return parse_errors.exchange(0);
 }
 
 unsigned get_parse_warnings()
 {
-    unsigned tmp = parse_warnings;
-    parse_warnings = 0;
-    return tmp;
+    return parse_warnings.exchange(0);
 }
 
 static void log_message(FILE* file, const char* type, const char* msg)
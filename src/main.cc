@@ -46,6 +46,7 @@
 #include "managers/plugin_manager.h"
 #include "packet_io/sfdaq.h"
 #include "packet_io/trough.h"
+#include "profiler/profiler_defs.h"
 #include "target_based/sftarget_reader.h"
 #include "time/periodic.h"
 #include "utils/util.h"
@@ -311,6 +312,20 @@ int main_dump_stats(lua_State* L)
     return 0;
 }
 
+int main_dump_profile(lua_State* L)
+{
+    bool from_shell = ( L != nullptr );
+
+    if ( ACProfileSnapshot::is_pending() )
+    {
+        current_request->respond("== profile snapshot pending; retry\n", from_shell);
+        return 0;
+    }
+    current_request->respond("== dumping profile\n", from_shell);
+    main_broadcast_command(new ACProfileSnapshot(), from_shell);
+    return 0;
+}
+
 int main_rotate_stats(lua_State* L)
 {
     bool from_shell = ( L != nullptr );
@@ -614,6 +629,26 @@ static int signal_check()
     return 1;
 }
 
+static void profile_check(void*)
+{
+    static time_t last = 0;
+    unsigned interval = SnortConfig::get_profiler()->snapshot_interval;
+
+    if ( !interval )
+        return;
+
+    time_t now = time(nullptr);
+
+    if ( !last )
+        last = now;
+
+    else if ( now - last >= (time_t)interval and !ACProfileSnapshot::is_pending() )
+    {
+        last = now;
+        main_dump_profile();
+    }
+}
+
 static void reap_commands()
 {
     for (unsigned idx = 0; idx < max_pigs; ++idx)
@@ -891,6 +926,7 @@ static void snort_main()
         pig.set_index(idx);
     }
 
+    Periodic::register_handler(profile_check, nullptr, 0, 1000);
     main_loop();
 
     delete pig_poke;
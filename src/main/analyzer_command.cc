@@ -27,6 +27,7 @@
 
 #include "log/messages.h"
 #include "managers/module_manager.h"
+#include "profiler/profiler.h"
 #include "utils/stats.h"
 
 #include "analyzer.h"
@@ -80,6 +81,21 @@ ACGetStats::~ACGetStats()
     DropStats();
 }
 
+bool ACProfileSnapshot::pending = false;
+
+void ACProfileSnapshot::execute(Analyzer&)
+{
+    Profiler::accumulate_snapshot();
+}
+
+ACProfileSnapshot::~ACProfileSnapshot()
+{
+    std::string file;
+    Profiler::write_snapshot(file);
+    LogMessage("== profile snapshot written to %s\n", file.c_str());
+    pending = false;
+}
+
 ACSwap::ACSwap(Swapper* ps) : ps(ps)
 {
     assert(Swapper::get_reload_in_progress() == false);
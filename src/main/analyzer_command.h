@@ -45,6 +45,19 @@ public:
     ~ACGetStats() override;
 };
 
+class ACProfileSnapshot : public AnalyzerCommand
+{
+public:
+    ACProfileSnapshot() { pending = true; }
+    void execute(Analyzer&) override;
+    const char* stringify() override { return "PROFILE_SNAPSHOT"; }
+    ~ACProfileSnapshot() override;
+
+    static bool is_pending() { return pending; }
+private:
+    static bool pending;
+};
+
 class ACPause : public AnalyzerCommand
 {
 public:
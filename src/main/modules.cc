@@ -221,6 +221,9 @@ static const Parameter search_engine_params[] =
     { "bleedover_warnings_enabled", Parameter::PT_BOOL, nullptr, "false",
       "print warning if a rule is demoted to any-any port group" },
 
+    { "compile_threads", Parameter::PT_INT, "0:256", "0",
+      "compile rule group search engines on this many threads (0 = main thread only)" },
+
     { "enable_single_rule_group", Parameter::PT_BOOL, nullptr, "false",
       "put all rules into one group" },
 
@@ -308,6 +311,9 @@ bool SearchEngineModule::set(const char*, Value& v, SnortConfig* sc)
         if ( v.get_bool() )
             fp->set_bleed_over_warnings();  // FIXIT-L these should take arg
     }
+    else if ( v.is("compile_threads") )
+        fp->set_compile_threads(v.get_long());
+
     else if ( v.is("enable_single_rule_group") )
     {
         if ( v.get_bool() )
@@ -386,6 +392,10 @@ static const Parameter profiler_time_params[] =
     { "max_depth", Parameter::PT_INT, "-1:", "-1",
       "limit depth to max_depth (-1 = no limit)" },
 
+    { "sample", Parameter::PT_INT, "0:1000000", "0",
+      "sample module stacks every given usecs of thread cpu instead of timing each scope "
+      "(0 = disabled)" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -434,6 +444,9 @@ static const Parameter profiler_params[] =  // FIXIT-L add help
     { "rules", Parameter::PT_TABLE, profiler_rule_params, nullptr,
       "rule time profiling" },
 
+    { "snapshot_interval", Parameter::PT_INT, "0:", "0",
+      "seconds between live profile snapshots written to profile_snapshot.json (0 = disabled)" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -485,7 +498,19 @@ bool ProfilerModule::set(const char* fqn, Value& v, SnortConfig* sc)
     const char* spr = "profiler.rules";
 
     if ( !strncmp(fqn, spt, strlen(spt)) )
+    {
+        if ( v.is("sample") )
+        {
+#ifdef __linux__
+            sc->profiler->time.sample = v.get_long();
+#else
+            if ( v.get_long() )
+                ParseWarning(WARN_CONF, "profiler.modules.sample is only supported on Linux");
+#endif
+            return true;
+        }
         return s_profiler_module_set(sc->profiler->time, v);
+    }
 
     else if ( !strncmp(fqn, spm, strlen(spm)) )
         return s_profiler_module_set(sc->profiler->memory, v);
@@ -493,6 +518,12 @@ bool ProfilerModule::set(const char* fqn, Value& v, SnortConfig* sc)
     else if ( !strncmp(fqn, spr, strlen(spr)) )
         return s_profiler_module_set(sc->profiler->rule, v);
 
+    else if ( v.is("snapshot_interval") )
+    {
+        sc->profiler->snapshot_interval = v.get_long();
+        return true;
+    }
+
     return false;
 }
 
@@ -912,6 +943,10 @@ static const Parameter packets_params[] =
     { "bpf_file", Parameter::PT_STRING, nullptr, nullptr,
       "file with BPF to select traffic for Snort" },
 
+    { "fast_decode", Parameter::PT_BOOL, nullptr, "false",
+      "decode ethernet and vlan headers inline instead of with the eth and vlan codecs; "
+      "read when packet threads start" },
+
     { "limit", Parameter::PT_INT, "0:", "0",
       "maximum number of packets to process before stopping (0 is unlimited)" },
 
@@ -945,6 +980,10 @@ bool PacketsModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("bpf_file") )
         sc->bpf_file = v.get_string();
 
+    // only read by PacketManager::thread_init()
+    else if ( v.is("fast_decode") )
+        sc->fast_decode = v.get_bool();
+
     else if ( v.is("limit") )
         sc->pkt_cnt = v.get_long();
 
@@ -1024,6 +1063,9 @@ static const Parameter network_params[] =
       "all | ip | noip | tcp | notcp | udp | noudp | icmp | noicmp | none", "none",
       "checksums to verify" },
 
+    { "checksum_trust", Parameter::PT_BOOL, nullptr, "false",
+      "skip tcp checksum evaluation when the DAQ reports that hardware verified it" },
+
     { "decode_drops", Parameter::PT_BOOL, nullptr, "false",
       "enable dropping of packets by the decoder" },
 
@@ -1074,6 +1116,9 @@ bool NetworkModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("checksum_eval") )
         ConfigChecksumMode(v.get_string());
 
+    else if ( v.is("checksum_trust") )
+        p->checksum_trust = v.get_bool();
+
     else if ( v.is("decode_drops") )
         p->decoder_drop = v.get_bool();
 
@@ -1124,12 +1169,34 @@ static const Parameter inspection_params[] =
 #define inspection_help \
     "configure basic inspection policy parameters"
 
+THREAD_LOCAL InspectionModuleStats snort::inspection_module_stats;
+
+const PegInfo inspection_module_pegs[] =
+{
+    // the dispatch pegs follow the PktType order of InspectionModuleStats::dispatches
+    { CountType::SUM, "untyped_dispatches", "inspector vectors run by checking protocol bits" },
+    { CountType::SUM, "ip_dispatches", "inspector vectors run with the ip plan" },
+    { CountType::SUM, "tcp_dispatches", "inspector vectors run with the tcp plan" },
+    { CountType::SUM, "udp_dispatches", "inspector vectors run with the udp plan" },
+    { CountType::SUM, "icmp_dispatches", "inspector vectors run with the icmp plan" },
+    { CountType::SUM, "pdu_dispatches", "inspector vectors run with the pdu plan" },
+    { CountType::SUM, "file_dispatches", "inspector vectors run with the file plan" },
+    { CountType::SUM, "evals", "inspector evaluations from dispatch plans" },
+    { CountType::END, nullptr, nullptr }
+};
+
 class InspectionModule : public Module
 {
 public:
     InspectionModule() : Module("inspection", inspection_help, inspection_params) { }
     bool set(const char*, Value&, SnortConfig*) override;
 
+    const PegInfo* get_pegs() const override
+    { return inspection_module_pegs; }
+
+    PegCount* get_counts() const override
+    { return (PegCount*)&inspection_module_stats; }
+
     Usage get_usage() const override
     { return INSPECT; }
 };
@@ -25,6 +25,7 @@
 // ideally, modules.cc would be refactored and several files.
 
 #include "framework/counts.h"
+#include "framework/decode_data.h"
 #include "main/snort_debug.h"
 #include "main/thread.h"
 
@@ -38,9 +39,17 @@ struct IpsModuleStats
     PegCount invalid_policy_ids;
 };
 
+// one dispatch count per PktType; PktType::NONE counts the untyped fallback
+struct InspectionModuleStats
+{
+    PegCount dispatches[(unsigned)PktType::MAX];
+    PegCount evals;
+};
+
 namespace snort
 {
 SO_PUBLIC extern THREAD_LOCAL IpsModuleStats ips_module_stats;
+extern THREAD_LOCAL InspectionModuleStats inspection_module_stats;
 }
 
 #endif
@@ -91,6 +91,7 @@ public:
     uint32_t checksum_drop;
     uint32_t normal_mask;
 
+    bool checksum_trust = false;
     bool decoder_drop;
 };
 
@@ -26,6 +26,8 @@
 #include <sys/stat.h>
 #include <syslog.h>
 
+#include <chrono>
+
 #include "actions/ips_actions.h"
 #include "codecs/codec_api.h"
 #include "connectors/connectors.h"
@@ -50,6 +52,7 @@
 #include "host_tracker/host_cache.h"
 #include "ips_options/ips_flowbits.h"
 #include "ips_options/ips_options.h"
+#include "latency/latency_histogram.h"
 #include "latency/packet_latency.h"
 #include "latency/rule_latency.h"
 #include "log/log.h"
@@ -552,14 +555,30 @@ void Snort::cleanup()
     clean_exit(0);
 }
 
+static void log_reload(const chrono::steady_clock::time_point& start, uint64_t heap)
+{
+    unsigned reused, total;
+    InspectorManager::get_reuse_counts(reused, total);
+
+    chrono::duration<double> secs = chrono::steady_clock::now() - start;
+    long delta = ((long)get_heap_usage() - (long)heap) / 1024;
+
+    LogMessage("== reload reused %u of %u inspectors in %.3f seconds, heap delta %+ld KB\n",
+        reused, total, secs.count(), delta);
+}
+
 // FIXIT-M refactor this so startup and reload call the same core function to
 // instantiate things that can be reloaded
 SnortConfig* Snort::get_reload_config(const char* fname)
 {
     reloading = true;
     ModuleManager::reset_errors();
+    ModuleManager::reset_digests();
     trim_heap();
 
+    auto start = chrono::steady_clock::now();
+    uint64_t heap = get_heap_usage();
+
     parser_init();
     SnortConfig* sc = ParseSnortConf(snort_cmd_line_conf, fname);
     sc->merge(snort_cmd_line_conf);
@@ -625,6 +644,7 @@ SnortConfig* Snort::get_reload_config(const char* fname)
 
     reloading = false;
     parser_term(sc);
+    log_reload(start, heap);
 
     return sc;
 }
@@ -709,7 +729,7 @@ void Snort::thread_idle()
     // FIXIT-L this whole thing could be pub-sub
     //用于perf, PerfIdleHandler, perf_monitor.cc
     DataBus::publish(THREAD_IDLE_EVENT, nullptr);
-    Stream::timeout_flows(time(nullptr));
+    Stream::idle_timeout_flows(time(nullptr));
     //统计信息, stats.cc文件, __thread类型, uint64_t
     aux_counts.idle++;
     HighAvailabilityManager::process_receive();
@@ -777,6 +797,8 @@ void Snort::thread_init_unprivileged()
     HighAvailabilityManager::thread_init(); // must be before InspectorManager::thread_init();
     InspectorManager::thread_init(SnortConfig::get_conf());
     PacketTracer::thread_init();
+    Profiler::thread_init();
+    LatencyHistograms::tinit();
     
     // in case there are HA messages waiting, process them first
     HighAvailabilityManager::process_receive();
@@ -812,7 +834,9 @@ void Snort::thread_term()
 
     PacketLatency::tterm();
     RuleLatency::tterm();
+    LatencyHistograms::tterm();
 
+    Profiler::thread_term();
     Profiler::consolidate_stats();
 
     DetectionEngine::thread_term();
@@ -843,7 +867,10 @@ DAQ_Verdict Snort::process_packet(
 {
     aux_counts.rx_bytes += pkthdr->caplen;
 
-    PacketManager::decode(p, pkthdr, pkt, is_frag);
+    {
+        LatencyHistograms::Context decode_latency(LatencyHistograms::DECODE);
+        PacketManager::decode(p, pkthdr, pkt, is_frag);
+    }
     assert(p->pkth && p->pkt);
 
     PacketTracer::activate(*p);
@@ -946,6 +973,7 @@ DAQ_Verdict Snort::packet_callback(
 {
     set_default_policy();
     Profile profile(totalPerfStats);
+    LatencyHistograms::Context total_latency(LatencyHistograms::TOTAL);
 
     pc.total_from_daq++;
     packet_time_update(&pkthdr->ts);
@@ -253,6 +253,7 @@ public:
     uint8_t max_ip6_extensions = 0;
     uint8_t max_ip_layers = 0;
     bool address_anomaly_check_enabled = false;
+    bool fast_decode = false;
 
     //------------------------------------------------------
     // active stuff
@@ -531,6 +532,9 @@ public:
     static bool tcp_checksum_drops()
     { return snort::get_network_policy()->checksum_drop & CHECKSUM_FLAG__TCP; }
 
+    static bool tcp_checksum_trust()
+    { return snort::get_network_policy()->checksum_trust; }
+
     static bool icmp_checksums()
     { return snort::get_network_policy()->checksum_eval & CHECKSUM_FLAG__ICMP; }
 
@@ -74,6 +74,7 @@ static const Command snort_cmds[] =
     { "show_plugins", main_dump_plugins, nullptr, "show available plugins" },
     { "delete_inspector", main_delete_inspector, s_delete, "delete an inspector from the default policy" },
     { "dump_stats", main_dump_stats, nullptr, "show summary statistics" },
+    { "dump_profile", main_dump_profile, nullptr, "append a live profile snapshot with deltas to profile_snapshot.json" },
     { "rotate_stats", main_rotate_stats, nullptr, "roll perfmonitor log files" },
     { "reload_config", main_reload_config, s_reload, "load new configuration" },
     { "reload_policy", main_reload_policy, s_reload, "reload part or all of the default policy" },
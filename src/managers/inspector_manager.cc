@@ -24,15 +24,19 @@
 #include "inspector_manager.h"
 
 #include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "binder/bind_module.h"
 #include "binder/binder.h"
 #include "detection/detect.h"
 #include "detection/detection_engine.h"
+#include "framework/data_bus.h"
 #include "flow/flow.h"
 #include "flow/session.h"
+#include "latency/latency_histogram.h"
 #include "log/messages.h"
+#include "main/modules.h"
 #include "main/snort.h"
 #include "main/snort_config.h"
 #include "main/thread_config.h"
@@ -114,11 +118,16 @@ struct PHInstance
     PHClass& pp_class;
     Inspector* handler;
     string name;
+    string digest;
     ReloadType reload_type;
+    bool reused;
+    bool subscriber;
 
     PHInstance(PHClass&, SnortConfig*, Module* = nullptr);
     ~PHInstance();
 
+    void reuse(Inspector*);
+
     static bool comp(PHInstance* a, PHInstance* b)
     { return ( a->pp_class.api.type < b->pp_class.api.type ); }
 
@@ -137,13 +146,25 @@ struct PHInstance
     { return reload_type; }
 };
 
+// a full reload may carry a configured handler over to the new config so
+// a handler is only trashed when the last config holding it is deleted
+static unordered_map<Inspector*, unsigned> s_owners;
+
+static unsigned s_reused = 0;
+static unsigned s_instances = 0;
+
 PHInstance::PHInstance(PHClass& p, SnortConfig* sc, Module* mod) : pp_class(p)
 {
     reload_type = RELOAD_TYPE_NONE;
+    reused = false;
+
+    unsigned subs = DataBus::get_subscriptions();
     handler = p.api.ctor(mod);
+    subscriber = DataBus::get_subscriptions() != subs;
 
     if ( handler )
     {
+        s_owners[handler] = 1;
         handler->set_api(&p.api);
         handler->add_ref();
 
@@ -158,6 +179,19 @@ PHInstance::~PHInstance()
         handler->rem_ref();
 }
 
+// the fresh handler was never configured or seen by a packet thread
+void PHInstance::reuse(Inspector* old)
+{
+    handler->rem_ref();
+    s_owners.erase(handler);
+    InspectorManager::free_inspector(handler);
+
+    handler = old;
+    handler->add_ref();
+    ++s_owners[handler];
+    reused = true;
+}
+
 typedef vector<PHGlobal*> PHGlobalList;
 typedef vector<PHClass*> PHClassList;
 typedef vector<PHInstance*> PHInstanceList;
@@ -172,28 +206,87 @@ static bool s_sorted = false;
 struct FrameworkConfig
 {
     PHClassList clist;
+    string digest;  // global modules, see ModuleManager::get_global_digest()
+    bool reusable = false;
 };
 
+// each vector also keeps a dispatch plan per PktType listing only those
+// inspectors whose proto_bits include that type so that packet time
+// selection is a single index.  PktType::NONE has no plan since it must
+// be matched against the packet's proto_bits.  vectors are homogeneous
+// by inspector type so service is set for the service vector only.
+
+static const unsigned num_plans = (unsigned)PktType::MAX;
+
 struct PHVector
 {
     PHInstance** vec;
     unsigned num;
 
+    PHInstance** plan[num_plans];
+    unsigned plan_num[num_plans];
+
+    bool service;
+
     PHVector()
-    { vec = nullptr; num = 0; }
+    {
+        vec = nullptr;
+        num = 0;
+
+        for ( unsigned t = 0; t < num_plans; ++t )
+        {
+            plan[t] = nullptr;
+            plan_num[t] = 0;
+        }
+        service = false;
+    }
 
     ~PHVector()
-    { if ( vec ) delete[] vec; }
+    {
+        if ( vec )
+            delete[] vec;
+
+        for ( unsigned t = 0; t < num_plans; ++t )
+            if ( plan[t] )
+                delete[] plan[t];
+    }
 
     void alloc(unsigned max)
-    { vec = new PHInstance*[max]; }
+    {
+        vec = new PHInstance*[max];
 
-    void add(PHInstance* p)
-    { vec[num++] = p; }
+        for ( unsigned t = 1; t < num_plans; ++t )
+            plan[t] = new PHInstance*[max];
+    }
 
+    void add(PHInstance* p, bool first = false);
     void add_control(PHInstance*);
 };
 
+static inline void insert(PHInstance** v, unsigned& n, PHInstance* p, bool first)
+{
+    if ( first and n )
+    {
+        v[n++] = v[0];
+        v[0] = p;
+    }
+    else
+        v[n++] = p;
+}
+
+void PHVector::add(PHInstance* p, bool first)
+{
+    insert(vec, num, p, first);
+
+    for ( unsigned t = 1; t < num_plans; ++t )
+    {
+        if ( BIT(t) & p->pp_class.api.proto_bits )
+            insert(plan[t], plan_num[t], p, first);
+    }
+    if ( p->pp_class.api.type == IT_SERVICE )
+        service = true;
+}
+
 // FIXIT-L a more sophisticated approach to handling controls etc. may be
 // warranted such as a configuration or priority scheme (a la 2X).  for
 // now we only require that appid run first among controls.
@@ -201,15 +294,7 @@ struct PHVector
 void PHVector::add_control(PHInstance* p)
 {
     const char* name = p->pp_class.api.base.name;
-
-    if ( strcmp(name, app_id) or !num )
-        add(p);
-
-    else
-    {
-        add(vec[0]);
-        vec[0] = p;
-    }
+    add(p, !strcmp(name, app_id));
 }
 
 struct FrameworkPolicy
@@ -479,6 +564,16 @@ void InspectorManager::delete_policy(InspectionPolicy* pi, bool cloned)
         if ( cloned and !(p->is_reloaded()) )
                 continue;
 
+        auto it = s_owners.find(p->handler);
+
+        if ( it != s_owners.end() and --it->second )
+        {
+            // still held by another config
+            delete p;
+            continue;
+        }
+        s_owners.erase(p->handler);
+
         if ( p->handler->get_api()->type == IT_PASSIVE )
             s_trash2.push_back(p->handler);
         else
@@ -710,8 +805,13 @@ void InspectorManager::instantiate(
         if ( !ppi )
             ParseError("can't instantiate inspector: '%s'.", keyword);
 
-        else if ( name )
-            ppi->set_name(name);
+        else
+        {
+            if ( name )
+                ppi->set_name(name);
+
+            ppi->digest = ModuleManager::get_digest(mod->get_name());
+        }
     }
 }
 
@@ -792,7 +892,23 @@ static bool configure(SnortConfig* sc, FrameworkPolicy* fp, bool cloned)
             else
                 continue;
         }
+        else
+        {
+            ++s_instances;
+
+            if ( p->reused )
+            {
+                ++s_reused;
+                p->handler->apply(sc);
+                continue;
+            }
+        }
+        unsigned subs = DataBus::get_subscriptions();
         ok = p->handler->configure(sc) && ok;
+        p->handler->apply(sc);
+
+        if ( DataBus::get_subscriptions() != subs )
+            p->subscriber = true;
     }
 
     if ( new_ins or reenabled_ins )
@@ -847,6 +963,57 @@ void InspectorManager::release(Inspector* pi)
     pi->rem_ref();
 }
 
+// an instance is carried over from the running config if it comes from the
+// same plugin with the same name, module settings and service.  the binder
+// is always rebuilt since it resolves instances by pointer.  data bus
+// subscriptions belong to the inspection policy and a reused handler is not
+// configured again, so handlers that subscribe are not reused.
+static bool same_instance(const PHInstance* p, const PHInstance* q)
+{
+    return &p->pp_class.api == &q->pp_class.api and
+        p->pp_class.api.type != IT_BINDER and
+        !p->subscriber and !q->subscriber and
+        !p->digest.empty() and p->digest == q->digest and p->name == q->name and
+        p->handler->get_service() == q->handler->get_service();
+}
+
+static void reuse(FrameworkPolicy* fp, FrameworkPolicy* old)
+{
+    for ( auto* p : fp->ilist )
+    {
+        for ( auto* q : old->ilist )
+        {
+            if ( same_instance(p, q) )
+            {
+                p->reuse(q->handler);
+                break;
+            }
+        }
+    }
+}
+
+// full reloads only; the running config can donate instances as long as
+// none of the global settings they were configured with have changed
+static SnortConfig* get_donor(SnortConfig* sc, bool cloned)
+{
+    if ( cloned )
+        return nullptr;
+
+    FrameworkConfig* fc = sc->framework_config;
+    fc->digest = ModuleManager::get_global_digest(fc->reusable);
+
+    if ( !Snort::is_reloading() or !fc->reusable )
+        return nullptr;
+
+    SnortConfig* old = SnortConfig::get_conf();
+
+    if ( !old or old == sc or !old->framework_config or !old->framework_config->reusable or
+        old->framework_config->digest != fc->digest )
+        return nullptr;
+
+    return old;
+}
+
 bool InspectorManager::configure(SnortConfig* sc, bool cloned)
 {
     if ( !s_sorted )
@@ -855,6 +1022,8 @@ bool InspectorManager::configure(SnortConfig* sc, bool cloned)
         s_sorted = true;
     }
     bool ok = true;
+    SnortConfig* old = get_donor(sc, cloned);
+    s_reused = s_instances = 0;
 
     for ( unsigned idx = 0; idx < sc->policy_map->inspection_policy_count(); ++idx )
     {
@@ -864,6 +1033,14 @@ bool InspectorManager::configure(SnortConfig* sc, bool cloned)
         set_inspection_policy(sc, idx);
         InspectionPolicy* p = sc->policy_map->get_inspection_policy(idx);
         p->configure();
+
+        if ( old and idx < old->policy_map->inspection_policy_count() )
+        {
+            InspectionPolicy* op = old->policy_map->get_inspection_policy(idx);
+
+            if ( op->framework_policy )
+                reuse(p->framework_policy, op->framework_policy);
+        }
         ok = ::configure(sc, p->framework_policy, cloned) && ok;
     }
 
@@ -871,6 +1048,12 @@ bool InspectorManager::configure(SnortConfig* sc, bool cloned)
     return ok;
 }
 
+void InspectorManager::get_reuse_counts(unsigned& reused, unsigned& total)
+{
+    reused = s_reused;
+    total = s_instances;
+}
+
 void InspectorManager::print_config(SnortConfig* sc)
 {
     InspectionPolicy* pi = snort::get_inspection_policy();
@@ -886,31 +1069,44 @@ void InspectorManager::print_config(SnortConfig* sc)
 // packet handling
 //-------------------------------------------------------------------------
 
-static inline void execute(
-    Packet* p, PHInstance** prep, unsigned num)
+static inline void execute(Packet* p, const PHVector& v)
 {
-    for ( unsigned i = 0; i < num; ++i, ++prep )
-    {
-        if ( p->packet_flags & PKT_PASS_RULE )
-            break;
+    // session and app handlers aren't called w/o a session pointer
+    if ( v.service and !p->flow )
+        return;
 
-        PHClass& ppc = (*prep)->pp_class;
+    unsigned t = (unsigned)p->type();
 
-        // FIXIT-P these checks can eventually be optimized
-        // but they are required to ensure that session and app
-        // handlers aren't called w/o a session pointer
-        if ( !p->flow && (ppc.api.type == IT_SERVICE) )
-            break;
+    // FIXIT-L ideally we could eliminate PktType and just use
+    // proto_bits but things like teredo need to be fixed up.
+    if ( t == (unsigned)PktType::NONE )
+    {
+        inspection_module_stats.dispatches[t]++;
+        PHInstance** prep = v.vec;
 
-        // FIXIT-L ideally we could eliminate PktType and just use
-        // proto_bits but things like teredo need to be fixed up.
-        if ( p->type() == PktType::NONE )
+        for ( unsigned i = 0; i < v.num; ++i, ++prep )
         {
-            if ( p->proto_bits & ppc.api.proto_bits )
+            if ( p->packet_flags & PKT_PASS_RULE )
+                break;
+
+            if ( p->proto_bits & (*prep)->pp_class.api.proto_bits )
                 (*prep)->handler->eval(p);
         }
-        else if ( BIT((unsigned)p->type()) & ppc.api.proto_bits )
-            (*prep)->handler->eval(p);
+        return;
+    }
+
+    inspection_module_stats.dispatches[t]++;
+
+    PHInstance** prep = v.plan[t];
+    unsigned num = v.plan_num[t];
+
+    for ( unsigned i = 0; i < num; ++i, ++prep )
+    {
+        if ( p->packet_flags & PKT_PASS_RULE )
+            break;
+
+        (*prep)->handler->eval(p);
+        inspection_module_stats.evals++;
     }
 }
 
@@ -953,14 +1149,12 @@ void InspectorManager::execute_control(Packet* p)
 {
     SnortConfig* sc = SnortConfig::get_conf();
     FrameworkPolicy* fp = snort::get_default_inspection_policy(sc)->framework_policy;
-    ::execute(p, fp->control.vec, fp->control.num);
+    ::execute(p, fp->control);
 }
 
-// FIXIT-M leverage knowledge of flow creation so that reputation (possibly a
-// new it_xxx) is run just once per flow (and all non-flow packets).
-
 void InspectorManager::execute(Packet* p)
 {
+    LatencyHistograms::Context inspect_latency(LatencyHistograms::INSPECT);
     FrameworkPolicy* fp = snort::get_inspection_policy()->framework_policy;
     assert(fp);
 
@@ -970,7 +1164,8 @@ void InspectorManager::execute(Packet* p)
         // be elevated from inspector to framework component (it is just
         // a flow control wrapper) and use eval() instead of process()
         // for stream_*.
-        ::execute(p, fp->session.vec, fp->session.num);
+        LatencyHistograms::Context stream_latency(LatencyHistograms::STREAM);
+        ::execute(p, fp->session);
         fp = snort::get_inspection_policy()->framework_policy;
     }
     // must check between each ::execute()
@@ -978,14 +1173,14 @@ void InspectorManager::execute(Packet* p)
        return;
 
     if ( !p->is_cooked() )
-        ::execute(p, fp->packet.vec, fp->packet.num);
+        ::execute(p, fp->packet);
 
     if ( p->disable_inspect )
        return;
 
     if ( !p->flow )
     {
-        ::execute(p, fp->network.vec, fp->network.num);
+        ::execute(p, fp->network);
 
         if ( p->disable_inspect )
            return;
@@ -995,10 +1190,13 @@ void InspectorManager::execute(Packet* p)
     else
     {
         if ( !p->has_paf_payload() and p->flow->flow_state == Flow::FlowState::INSPECT )
+        {
+            LatencyHistograms::Context stream_latency(LatencyHistograms::STREAM);
             p->flow->session->process(p);
+        }
 
         if ( !p->flow->service )
-            ::execute(p, fp->network.vec, fp->network.num);
+            ::execute(p, fp->network);
 
         if ( p->disable_inspect )
            return;
@@ -1015,7 +1213,7 @@ void InspectorManager::probe(Packet* p)
 {
     InspectionPolicy* policy = snort::SnortConfig::get_conf()->policy_map->get_inspection_policy(0);
     FrameworkPolicy* fp = policy->framework_policy;
-    ::execute(p, fp->probe.vec, fp->probe.num);
+    ::execute(p, fp->probe);
 }
 
 void InspectorManager::clear(Packet* p)
@@ -72,6 +72,10 @@ public:
     static bool configure(SnortConfig*, bool cloned = false);
     static void print_config(SnortConfig*);
 
+    // results of the last configure(); reused instances were carried
+    // over from the running config by a full reload
+    static void get_reuse_counts(unsigned& reused, unsigned& total);
+
     static void thread_init(SnortConfig*);
     static void thread_stop(SnortConfig*);
     static void thread_term(SnortConfig*);
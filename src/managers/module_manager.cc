@@ -25,6 +25,7 @@
 
 #include <libgen.h>
 #include <lua.hpp>
+#include <sys/stat.h>
 
 #include <cassert>
 #include <iostream>
@@ -40,6 +41,7 @@
 #include "main/shell.h"
 #include "main/snort.h"
 #include "main/snort_config.h"
+#include "parser/config_file.h"
 #include "parser/parse_conf.h"
 #include "parser/parser.h"
 #include "parser/vars.h"
@@ -57,6 +59,11 @@ struct ModHook
     const BaseApi* api;
     luaL_Reg* reg;
 
+    // everything set on the module during the current parse; used by
+    // reload to tell whether an instance can be carried over
+    string digest;
+    bool reusable = true;
+
     ModHook(Module*, const BaseApi*);
     ~ModHook();
 
@@ -186,6 +193,88 @@ static ModHook* get_hook(const char* s)
     return nullptr;
 }
 
+// fnv-1a over the file so that editing a list in place is seen as a change
+static bool hash_file(const char* path, uint64_t& hash)
+{
+    FILE* f = fopen(path, "r");
+
+    if ( !f )
+        return false;
+
+    hash = 0xcbf29ce484222325ull;
+    uint8_t buf[8192];
+    size_t n;
+
+    while ( (n = fread(buf, 1, sizeof(buf), f)) > 0 )
+    {
+        for ( size_t i = 0; i < n; ++i )
+            hash = (hash ^ buf[i]) * 0x100000001b3ull;
+    }
+    fclose(f);
+    return true;
+}
+
+// relative names are tried against the conf dir first and then the
+// working dir as the modules do
+static bool find_file(const char* s, string& path, struct stat& st)
+{
+    if ( *s != '/' )
+    {
+        path = get_snort_conf_dir();
+
+        if ( !path.empty() and path.back() != '/' )
+            path += '/';
+
+        path += s;
+
+        if ( !stat(path.c_str(), &st) )
+            return true;
+    }
+    path = s;
+    return !stat(path.c_str(), &st);
+}
+
+// strings naming files also record a hash of the file contents.  the
+// contents of a directory can't be tracked cheaply so a module naming one
+// is not reused.
+static void add_digest(ModHook* h, const char* fqn, Value& v)
+{
+    string& d = h->digest;
+    d += fqn;
+    d += '=';
+
+    if ( v.get_type() != Value::VT_STR )
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.17g", v.get_real());
+        d += buf;
+    }
+    else
+    {
+        const char* s = v.get_string();
+        d += s;
+
+        string path;
+        struct stat st;
+        uint64_t hash;
+
+        if ( !*s or !find_file(s, path, st) )
+            path.clear();
+
+        else if ( S_ISDIR(st.st_mode) )
+            h->reusable = false;
+
+        else if ( S_ISREG(st.st_mode) and hash_file(path.c_str(), hash) )
+        {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "@%lld:%016llx",
+                (long long)st.st_size, (unsigned long long)hash);
+            d += buf;
+        }
+    }
+    d += ';';
+}
+
 //-------------------------------------------------------------------------
 // dump methods:
 // recurse over parameters and output like this:
@@ -502,6 +591,10 @@ static bool set_value(const char* fqn, Value& v)
     {
         v.set(p);
         set_param(mod, fqn, v);
+
+        if ( ModHook* h = get_hook(key.c_str()) )
+            add_digest(h, fqn, v);
+
         return true;
     }
 
@@ -725,6 +818,18 @@ SO_PUBLIC bool open_table(const char* s, int idx)
         }
     }
 
+    if ( key == s and !idx )
+    {
+        h->digest.clear();
+        h->reusable = true;
+    }
+
+    h->digest += "{";
+    h->digest += s;
+    h->digest += ':';
+    h->digest += to_string(idx);
+    h->digest += ';';
+
     if ( s_current != key )
     {
         if ( fqn != orig )
@@ -768,6 +873,8 @@ SO_PUBLIC void close_table(const char* s, int idx)
         if ( h->mod->get_usage() != Module::CONTEXT && only_network_policy() )
             return;
 
+        h->digest += "};";
+
         if ( !end(h->mod, nullptr, s, idx) )
             ParseError("can't close %s", h->mod->get_name());
 
@@ -940,6 +1047,44 @@ void ModuleManager::reset_errors()
 unsigned ModuleManager::get_errors()
 { return s_errors; }
 
+void ModuleManager::reset_digests()
+{
+    for ( auto* h : s_modules )
+    {
+        h->digest.clear();
+        h->reusable = true;
+    }
+}
+
+// empty if the module can't be reused
+const char* ModuleManager::get_digest(const char* name)
+{
+    ModHook* h = get_hook(name);
+    return (h and h->reusable) ? h->digest.c_str() : "";
+}
+
+// basic modules other than detection feed the whole configuration so any
+// change there precludes reusing inspectors; so does any of them that
+// can't be digested
+string ModuleManager::get_global_digest(bool& reusable)
+{
+    string d;
+    reusable = true;
+
+    for ( auto* h : s_modules )
+    {
+        if ( h->api or h->digest.empty() or h->mod->get_usage() == Module::DETECT )
+            continue;
+
+        d += h->mod->get_name();
+        d += h->digest;
+
+        if ( !h->reusable )
+            reusable = false;
+    }
+    return d;
+}
+
 void ModuleManager::list_modules(const char* s)
 {
     PlugType pt = s ? PluginManager::get_type(s) : PT_MAX;
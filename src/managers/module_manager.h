@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <set>
 #include <list>
+#include <string>
 
 //-------------------------------------------------------------------------
 
@@ -75,6 +76,11 @@ public:
     static void reset_errors();
     static unsigned get_errors();
 
+    // configuration fingerprints for reload
+    static void reset_digests();
+    static const char* get_digest(const char*);
+    static std::string get_global_digest(bool& reusable);
+
     static void dump_stats(snort::SnortConfig*, const char* skip = nullptr, bool dynamic = false);
  
     static void accumulate(snort::SnortConfig*);
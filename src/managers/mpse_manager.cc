@@ -25,6 +25,7 @@
 
 #include <cassert>
 #include <list>
+#include <unordered_map>
 
 #include "detection/fp_config.h"
 #include "framework/mpse.h"
@@ -120,8 +121,25 @@ Mpse* MpseManager::get_search_engine(const char* type)
     return eng;
 }
 
+// engines shared by identical rule groups are only deleted with the last
+// reference; the count here is the number of references beyond the first
+static unordered_map<Mpse*, unsigned> s_shares;
+
+void MpseManager::share_search_engine(Mpse* eng)
+{
+    ++s_shares[eng];
+}
+
 void MpseManager::delete_search_engine(Mpse* eng)
 {
+    auto it = s_shares.find(eng);
+
+    if ( it != s_shares.end() )
+    {
+        if ( !--it->second )
+            s_shares.erase(it);
+        return;
+    }
     const MpseApi* api = eng->get_api();
     api->dtor(eng);
 }
@@ -175,6 +193,12 @@ bool MpseManager::is_regex_capable(const MpseApi* api)
     return (api->flags & MPSE_REGEX) != 0;
 }
 
+bool MpseManager::parallel_compiles(const MpseApi* api)
+{
+    assert(api);
+    return (api->flags & MPSE_MTBLD) != 0;
+}
+
 // was called during drop stats but actually commented out
 // FIXIT-M this one has to accumulate across threads
 #if 0
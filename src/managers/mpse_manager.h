@@ -65,6 +65,7 @@ public:
 
     static void instantiate(const snort::MpseApi*, snort::Module*, snort::SnortConfig*);
     static const snort::MpseApi* get_search_api(const char* type);
+    static void share_search_engine(snort::Mpse*);
     static void delete_search_engine(snort::Mpse*);
 
     static snort::Mpse* get_search_engine(const char*);
@@ -77,6 +78,7 @@ public:
     static void stop_search_engine(const snort::MpseApi*);
     static bool search_engine_trim(const snort::MpseApi*);
     static bool is_regex_capable(const snort::MpseApi*);
+    static bool parallel_compiles(const snort::MpseApi*);
     static void print_mpse_summary(const snort::MpseApi*);
     static void print_search_engine_stats();
 
@@ -736,6 +736,11 @@ int AppIdConfig::load_analysis_config(const char* config_file, int reload, int i
         configure_analysis_networks(instance_toklist, IPFUNCS_APPLICATION);
     }
 
+    tcp_port_exclusion_src_matcher.compile(tcp_port_exclusions_src);
+    udp_port_exclusion_src_matcher.compile(udp_port_exclusions_src);
+    tcp_port_exclusion_dst_matcher.compile(tcp_port_exclusions_dst);
+    udp_port_exclusion_dst_matcher.compile(udp_port_exclusions_dst);
+
     for (my_net_list = net_list_list; my_net_list; my_net_list = net_list->next)
     {
         if (my_net_list != net_list)
@@ -780,6 +785,83 @@ bool AppIdConfig::init_appid(SnortConfig* sc)
     return true;
 }
 
+// Exclusions that overlap the IPv4 mapped space, which includes all IPv4 exclusions, go in the
+// IPv4 trie clipped to that space. Exclusions that reach outside of it go in the IPv6 trie. Since
+// match() sends every mapped address to the IPv4 trie, each address matches the same exclusions
+// as the masked compare this replaces.
+void PortExclusionMatcher::compile(const AppIdPortExclusions& port_exclusions)
+{
+    static const uint8_t mapped_min[16] =
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 0, 0, 0, 0 };
+    static const uint8_t mapped_max[16] =
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+    clear();
+
+    for ( unsigned port = 0; port < APP_ID_PORT_ARRAY_SIZE; port++ )
+    {
+        if ( !port_exclusions[port] )
+            continue;
+
+        SF_LNODE* node;
+        for ( PortExclusion* pe = (PortExclusion*)sflist_first(port_exclusions[port], &node);
+            pe;
+            pe = (PortExclusion*)sflist_next(&node) )
+        {
+            uint8_t lo[2 + 16];
+            uint8_t hi[2 + 16];
+            bool reachable = true;
+
+            lo[0] = hi[0] = (uint8_t)(port >> 8);
+            lo[1] = hi[1] = (uint8_t)port;
+            for ( unsigned i = 0; i < 16; i++ )
+            {
+                const uint8_t ip = pe->ip.u6_addr8[i];
+                const uint8_t mask = pe->netmask.u6_addr8[i];
+                if ( ip & ~mask )
+                    reachable = false;
+                lo[2 + i] = ip;
+                hi[2 + i] = ip | (uint8_t)~mask;
+            }
+
+            // an address with bits outside its netmask never matched a masked compare
+            if ( !reachable )
+                continue;
+
+            if ( memcmp(lo + 2, mapped_min, 16) < 0 or memcmp(hi + 2, mapped_max, 16) > 0 )
+            {
+                if ( !trie6 )
+                    trie6 = new NetworkTrie(2 + 16, 16);
+                trie6->add(lo, hi, 1);
+            }
+
+            const uint8_t* min = (memcmp(lo + 2, mapped_min, 16) > 0) ? lo + 2 : mapped_min;
+            const uint8_t* max = (memcmp(hi + 2, mapped_max, 16) < 0) ? hi + 2 : mapped_max;
+            if ( memcmp(min, max, 16) > 0 )
+                continue;
+
+            uint8_t lo4[2 + 4];
+            uint8_t hi4[2 + 4];
+            memcpy(lo4, lo, 2);
+            memcpy(hi4, hi, 2);
+            memcpy(lo4 + 2, min + 12, 4);
+            memcpy(hi4 + 2, max + 12, 4);
+
+            if ( !trie )
+                trie = new NetworkTrie(2 + 4, 16);
+            trie->add(lo4, hi4, 1);
+        }
+    }
+}
+
+void PortExclusionMatcher::clear()
+{
+    delete trie;
+    trie = nullptr;
+    delete trie6;
+    trie6 = nullptr;
+}
+
 static void free_port_exclusion_list(AppIdPortExclusions& pe_list)
 {
     for ( unsigned i = 0; i < APP_ID_PORT_ARRAY_SIZE; i++ )
@@ -814,6 +896,10 @@ void AppIdConfig::cleanup()
     free_port_exclusion_list(tcp_port_exclusions_dst);
     free_port_exclusion_list(udp_port_exclusions_src);
     free_port_exclusion_list(udp_port_exclusions_dst);
+    tcp_port_exclusion_src_matcher.clear();
+    tcp_port_exclusion_dst_matcher.clear();
+    udp_port_exclusion_src_matcher.clear();
+    udp_port_exclusion_dst_matcher.clear();
 }
 
 AppId AppIdConfig::get_port_service_id(IpProtocol proto, uint16_t port)
@@ -23,9 +23,11 @@
 #define APP_ID_CONFIG_H
 
 #include <array>
+#include <cstring>
 #include <string>
 
 #include "application_ids.h"
+#include "appid_utils/network_trie.h"
 #include "framework/decode_data.h"
 #include "main/snort_config.h"
 #include "protocols/ipv6.h"
@@ -94,6 +96,46 @@ public:
 
 typedef std::array<SF_LIST*, APP_ID_PORT_ARRAY_SIZE> AppIdPortExclusions;
 
+// Compiled form of the port exclusion lists for one protocol and direction. The trie key is the
+// port followed by the address so matching is a single lookup however many exclusions exist.
+class PortExclusionMatcher
+{
+public:
+    PortExclusionMatcher() = default;
+    PortExclusionMatcher(const PortExclusionMatcher&) = delete;
+    PortExclusionMatcher& operator=(const PortExclusionMatcher&) = delete;
+    ~PortExclusionMatcher()
+    { clear(); }
+
+    void compile(const AppIdPortExclusions&);
+    void clear();
+
+    bool match(uint16_t port, const snort::SfIp* ip) const
+    {
+        uint8_t key[2 + 16];
+        key[0] = (uint8_t)(port >> 8);
+        key[1] = (uint8_t)port;
+
+        // IPv4 mapped addresses are looked up in the IPv4 trie whatever their family
+        const uint32_t* ip6 = ip->get_ip6_ptr();
+        if ( ip->is_ip4() or (!ip6[0] and !ip6[1] and ip6[2] == htonl(0xffff)) )
+        {
+            if ( !trie )
+                return false;
+            memcpy(key + 2, ip->get_ip4_ptr(), 4);
+            return trie->find(key) != 0;
+        }
+        if ( !trie6 )
+            return false;
+        memcpy(key + 2, ip->get_ip6_ptr(), 16);
+        return trie6->find(key) != 0;
+    }
+
+private:
+    NetworkTrie* trie = nullptr;    // port + IPv4 address
+    NetworkTrie* trie6 = nullptr;   // port + IPv6 address
+};
+
 class AppIdConfig
 {
 public:
@@ -122,6 +164,10 @@ public:
     AppIdPortExclusions udp_port_exclusions_src;
     AppIdPortExclusions tcp_port_exclusions_dst;
     AppIdPortExclusions udp_port_exclusions_dst;
+    PortExclusionMatcher tcp_port_exclusion_src_matcher;
+    PortExclusionMatcher udp_port_exclusion_src_matcher;
+    PortExclusionMatcher tcp_port_exclusion_dst_matcher;
+    PortExclusionMatcher udp_port_exclusion_dst_matcher;
     AppIdModuleConfig* mod_config = nullptr;
     unsigned appIdPolicyId = 53;
 
@@ -147,73 +147,36 @@ void AppIdDiscovery::do_application_discovery(Packet* p, AppIdInspector& inspect
     do_post_discovery(p, *asd, direction, is_discovery_done);
 }
 
-static inline int match_pe_network(const SfIp* pktAddr, const PortExclusion* pe)
-{
-    const uint32_t* pkt = pktAddr->get_ip6_ptr();
-    const uint32_t* nm = pe->netmask.u6_addr32;
-    const uint32_t* peIP = pe->ip.u6_addr32;
-    return (((pkt[0] & nm[0]) == peIP[0])
-           && ((pkt[1] & nm[1]) == peIP[1])
-           && ((pkt[2] & nm[2]) == peIP[2])
-           && ((pkt[3] & nm[3]) == peIP[3]));
-}
-
 static inline int check_port_exclusion(const Packet* pkt, bool reversed, AppIdInspector& inspector)
 {
-    AppIdPortExclusions* src_port_exclusions;
-    AppIdPortExclusions* dst_port_exclusions;
-    SF_LIST* pe_list;
-    PortExclusion* pe;
-    const SfIp* s_ip;
+    const PortExclusionMatcher* src_matcher;
+    const PortExclusionMatcher* dst_matcher;
     AppIdConfig* config = inspector.get_appid_config();
 
     if ( pkt->is_tcp() )
     {
-        src_port_exclusions = &config->tcp_port_exclusions_src;
-        dst_port_exclusions = &config->tcp_port_exclusions_dst;
+        src_matcher = &config->tcp_port_exclusion_src_matcher;
+        dst_matcher = &config->tcp_port_exclusion_dst_matcher;
     }
     else if ( pkt->is_udp() )
     {
-        src_port_exclusions = &config->udp_port_exclusions_src;
-        dst_port_exclusions = &config->udp_port_exclusions_dst;
+        src_matcher = &config->udp_port_exclusion_src_matcher;
+        dst_matcher = &config->udp_port_exclusion_dst_matcher;
     }
     else
         return 0;
 
     /* check the source port */
     uint16_t port = reversed ? pkt->ptrs.dp : pkt->ptrs.sp;
-    if ( port && (pe_list = (*src_port_exclusions)[port]) != nullptr )
-    {
-        s_ip = reversed ? pkt->ptrs.ip_api.get_dst() : pkt->ptrs.ip_api.get_src();
-
-        SF_LNODE* node;
-
-        /* walk through the list of port exclusions for this port */
-        for ( pe = (PortExclusion*)sflist_first(pe_list, &node);
-            pe;
-            pe = (PortExclusion*)sflist_next(&node) )
-        {
-            if ( match_pe_network(s_ip, pe))
-                return 1;
-        }
-    }
+    if ( port && src_matcher->match(port,
+        reversed ? pkt->ptrs.ip_api.get_dst() : pkt->ptrs.ip_api.get_src()) )
+        return 1;
 
     /* check the dest port */
     port = reversed ? pkt->ptrs.sp : pkt->ptrs.dp;
-    if ( port && (pe_list = (*dst_port_exclusions)[port]) != nullptr )
-    {
-        s_ip = reversed ? pkt->ptrs.ip_api.get_src() : pkt->ptrs.ip_api.get_dst();
-
-        SF_LNODE* node;
-        /* walk through the list of port exclusions for this port */
-        for ( pe = (PortExclusion*)sflist_first(pe_list, &node);
-            pe;
-            pe = (PortExclusion*)sflist_next(&node) )
-        {
-            if ( match_pe_network(s_ip, pe))
-                return 1;
-        }
-    }
+    if ( port && dst_matcher->match(port,
+        reversed ? pkt->ptrs.ip_api.get_src() : pkt->ptrs.ip_api.get_dst()) )
+        return 1;
 
     return 0;
 }
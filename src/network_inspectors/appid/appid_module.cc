@@ -36,6 +36,7 @@
 #include "app_info_table.h"
 #include "appid_debug.h"
 #include "appid_peg_counts.h"
+#include "lua_detector_module.h"
 
 using namespace snort;
 using namespace std;
@@ -293,10 +294,12 @@ PegCount* AppIdModule::get_counts() const
 void AppIdModule::sum_stats(bool accumulate_now_stats)
 {
     AppIdPegCounts::sum_stats();
+    LuaDetectorManager::sum_stats();
     Module::sum_stats(accumulate_now_stats);
 }
 
 void AppIdModule::show_dynamic_stats()
 {
     AppIdPegCounts::print();
+    LuaDetectorManager::print_stats();
 }
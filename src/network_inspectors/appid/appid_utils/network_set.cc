@@ -65,6 +65,8 @@ int NetworkSetManager::destroy(NetworkSet* network_set)
     if (!network_set)
         return -1;
 
+    delete network_set->trie;
+    delete network_set->trie6;
     if (network_set->pnetwork)
     {
         snort_free(network_set->pnetwork);
@@ -1084,9 +1086,47 @@ int NetworkSetManager::reduce(NetworkSet* network_set)
             }
         }
     }
+
+    compile(network_set);
     return 0;
 }
 
+// Replace the binary search over the sorted, reduced networks with a trie lookup that costs a
+// fixed number of memory accesses however many networks are configured. The root covers the
+// first 16 bits so IPv4 takes at most 3 accesses.
+void NetworkSetManager::compile(NetworkSet* network_set)
+{
+    uint8_t lo[16];
+    uint8_t hi[16];
+
+    delete network_set->trie;
+    network_set->trie = nullptr;
+    delete network_set->trie6;
+    network_set->trie6 = nullptr;
+
+    if (network_set->count)
+    {
+        network_set->trie = new NetworkTrie(4, 16);
+        for (unsigned i = 0; i < network_set->count; i++)
+        {
+            pack_key(network_set->pnetwork[i]->range_min, lo);
+            pack_key(network_set->pnetwork[i]->range_max, hi);
+            network_set->trie->add(lo, hi, i + 1);
+        }
+    }
+
+    if (network_set->count6)
+    {
+        network_set->trie6 = new NetworkTrie(16, 16);
+        for (unsigned i = 0; i < network_set->count6; i++)
+        {
+            pack_key6(&network_set->pnetwork6[i]->range_min, lo);
+            pack_key6(&network_set->pnetwork6[i]->range_max, hi);
+            network_set->trie6->add(lo, hi, i + 1);
+        }
+    }
+}
+
 NetworkSet* NetworkSetManager::copy(NetworkSet* network_set)
 {
     NetworkSet* new_set;
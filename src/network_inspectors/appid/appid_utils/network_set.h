@@ -30,6 +30,8 @@
 #include "protocols/ipv6.h"
 #include "utils/sflsq.h"
 
+#include "network_trie.h"
+
 // network_set.h author Sourcefire Inc.
 
 #ifndef ULLONG_MAX
@@ -109,6 +111,10 @@ struct NetworkSet
     XHash* ids6;
     Network6** pnetwork6;
     unsigned count6;
+
+    // compiled by reduce(), the value found is an index + 1 into pnetwork / pnetwork6
+    NetworkTrie* trie;
+    NetworkTrie* trie6;
 };
 
 // FIXIT-L - this should be integrated into the snort3 general IP address support library
@@ -242,6 +248,24 @@ public:
             ip6->lo--;
     }
 
+    // Trie keys are in network order, addresses in NetworkSet are in host order
+    static void pack_key(uint32_t ip, uint8_t* key)
+    {
+        key[0] = (uint8_t)(ip >> 24);
+        key[1] = (uint8_t)(ip >> 16);
+        key[2] = (uint8_t)(ip >> 8);
+        key[3] = (uint8_t)ip;
+    }
+
+    static void pack_key6(const NSIPv6Addr* ip6, uint8_t* key)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            key[i] = (uint8_t)(ip6->hi >> (56 - 8 * i));
+            key[i + 8] = (uint8_t)(ip6->lo >> (56 - 8 * i));
+        }
+    }
+
     static int contains_ex(NetworkSet* network_set, uint32_t ipaddr, unsigned* type)
     {
         int low=0;
@@ -254,6 +278,17 @@ public:
         if (!network_set->count)
             return 0;
 
+        if (network_set->trie)
+        {
+            uint8_t key[4];
+            pack_key(ipaddr, key);
+            unsigned i = network_set->trie->find(key);
+            if (!i)
+                return 0;
+            *type = network_set->pnetwork[i - 1]->info.type;
+            return 1;
+        }
+
         high = network_set->count - 1;
 
         if (ipaddr < network_set->pnetwork[low]->range_min || ipaddr >
@@ -289,6 +324,17 @@ public:
         if (!network_set->count6)
             return 0;
 
+        if (network_set->trie6)
+        {
+            uint8_t key[16];
+            pack_key6(ipaddr, key);
+            unsigned i = network_set->trie6->find(key);
+            if (!i)
+                return 0;
+            *type = network_set->pnetwork6[i - 1]->info.type;
+            return 1;
+        }
+
         high = network_set->count6 - 1;
 
         if (compare_ipv6_address(ipaddr, &network_set->pnetwork6[low]->range_min) < 0 ||
@@ -366,6 +412,7 @@ private:
     static int add_network_list(SF_LIST* networks, SF_LIST* new_networks);
     static int reduce_network_set(SF_LIST* networks);
     static int reduce_network_set6(SF_LIST* networks);
+    static void compile(NetworkSet*);
 };
 #endif
 
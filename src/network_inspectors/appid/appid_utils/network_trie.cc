@@ -0,0 +1,100 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "network_trie.h"
+
+#include <cassert>
+#include <cstring>
+
+static inline unsigned get_digit(const uint8_t* key, unsigned start, unsigned len)
+{
+    unsigned digit = 0;
+    for (unsigned i = start; i < start + len; i++)
+        digit = (digit << 8) | key[i];
+    return digit;
+}
+
+static inline bool is_filled(const uint8_t* key, unsigned len, uint8_t fill)
+{
+    for (unsigned i = 0; i < len; i++)
+        if (key[i] != fill)
+            return false;
+    return true;
+}
+
+NetworkTrie::NetworkTrie(unsigned key_len_, unsigned root_bits) :
+    key_len(key_len_), root_len((root_bits == 8) ? 1 : 2)
+{
+    assert(root_bits == 8 or root_bits == 16);
+    assert(key_len > root_len);
+    table.resize(1u << (8 * root_len), 0);
+}
+
+bool NetworkTrie::add(const uint8_t* lo, const uint8_t* hi, uint32_t value)
+{
+    if (!value or value > MAX_VALUE or memcmp(lo, hi, key_len) > 0)
+        return false;
+
+    fill(0, 0, root_len, lo, hi, true, true, value);
+    return true;
+}
+
+// Set every empty entry of the table at base whose keys are covered by [lo, hi]. The digit for
+// this level is key bytes [start, start + len). lo_edge / hi_edge say whether the lower / upper
+// bound still constrains this subtree. Only the entries at the two edges can be partially covered
+// and those are the only ones that need a child table.
+void NetworkTrie::fill(uint32_t base, unsigned start, unsigned len, const uint8_t* lo,
+    const uint8_t* hi, bool lo_edge, bool hi_edge, uint32_t value)
+{
+    const unsigned first = lo_edge ? get_digit(lo, start, len) : 0;
+    const unsigned last = hi_edge ? get_digit(hi, start, len) : (1u << (8 * len)) - 1;
+    const unsigned next = start + len;
+
+    for (unsigned d = first; d <= last; d++)
+    {
+        const bool sub_lo = lo_edge and d == first and !is_filled(lo + next, key_len - next, 0x00);
+        const bool sub_hi = hi_edge and d == last and !is_filled(hi + next, key_len - next, 0xff);
+        uint32_t entry = table[base + d];
+
+        if (entry and !(entry & CHILD))
+            continue;
+
+        if (!sub_lo and !sub_hi)
+        {
+            if (!entry)
+                table[base + d] = value;
+            else
+                fill(entry & ~CHILD, next, 1, lo, hi, false, false, value);
+            continue;
+        }
+
+        if (!entry)
+        {
+            entry = table.size();
+            table.resize(entry + STRIDE, 0);
+            entry |= CHILD;
+            table[base + d] = entry;
+        }
+        fill(entry & ~CHILD, next, 1, lo, hi, sub_lo, sub_hi, value);
+    }
+}
+
@@ -0,0 +1,72 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef NETWORK_TRIE_H
+#define NETWORK_TRIE_H
+
+// NetworkTrie is a read-mostly multibit trie built at configuration time that
+// maps an address (or any fixed length big endian key) to the value of the
+// range containing it. The root is indexed by the first 8 or 16 bits of the
+// key and each further level by one byte, so a lookup costs at most one memory
+// access per remaining key byte no matter how many ranges were added.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class NetworkTrie
+{
+public:
+    static const uint32_t MAX_VALUE = 0x7fffffff;
+
+    // key_len is in bytes, root_bits is 8 or 16
+    NetworkTrie(unsigned key_len, unsigned root_bits);
+
+    // Associate value with every key in [lo, hi] that does not already have one. Ranges
+    // added earlier take precedence where they overlap. Value must be 1 .. MAX_VALUE.
+    bool add(const uint8_t* lo, const uint8_t* hi, uint32_t value);
+
+    // Returns the value of the range containing key or 0 if there is none
+    uint32_t find(const uint8_t* key) const
+    {
+        uint32_t entry = table[(root_len == 1) ? key[0] : ((key[0] << 8) | key[1])];
+        for (unsigned depth = root_len; entry & CHILD; depth++)
+            entry = table[(entry & ~CHILD) + key[depth]];
+        return entry;
+    }
+
+    unsigned get_key_len() const
+    { return key_len; }
+
+    size_t get_memory() const
+    { return table.size() * sizeof(uint32_t); }
+
+private:
+    static const uint32_t CHILD = 0x80000000;
+    static const unsigned STRIDE = 256;
+
+    void fill(uint32_t base, unsigned start, unsigned len, const uint8_t* lo, const uint8_t* hi,
+        bool lo_edge, bool hi_edge, uint32_t value);
+
+    const unsigned key_len;
+    const unsigned root_len;
+    std::vector<uint32_t> table;
+};
+
+#endif
+
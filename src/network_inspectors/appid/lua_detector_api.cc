@@ -68,6 +68,23 @@ ProfileStats luaCiscoPerfStats;
 ProfileStats luaCustomPerfStats;
 
 static THREAD_LOCAL XHash* CHP_glossary = nullptr;      // keep track of http multipatterns here
+static THREAD_LOCAL const LuaDetectorParameters* ffi_params = nullptr;
+static THREAD_LOCAL AppIdLuaPacket ffi_packet;
+
+SO_PUBLIC const AppIdLuaPacket* appid_get_packet()
+{
+    if ( !ffi_params or !ffi_params->pkt )
+        return nullptr;
+
+    const Packet* p = ffi_params->pkt;
+    ffi_packet.data = ffi_params->data;
+    ffi_packet.size = ffi_params->size;
+    ffi_packet.dir = ffi_params->dir;
+    ffi_packet.proto = p->has_ip() ? (unsigned)p->get_ip_proto_next() : 0;
+    ffi_packet.sp = p->ptrs.sp;
+    ffi_packet.dp = p->ptrs.dp;
+    return &ffi_packet;
+}
 
 static int free_chp_data(void* /* key */, void* data)
 {
@@ -2362,9 +2379,32 @@ int LuaStateDescriptor::lua_validate(AppIdDiscoveryArgs& args)
         return APPID_ENULL;
     }
 
-    lua_getglobal(my_lua_state, validateFn);
+    // Look the validate function up once and keep a registry reference to it rather than
+    // hashing its name into the globals table on every packet
+    if ( !validate_function_ref )
+    {
+        lua_getglobal(my_lua_state, validateFn);
+        if ( !lua_isfunction(my_lua_state, -1) )
+        {
+            lua_pop(my_lua_state, 1);
+            ErrorMessage("lua detector %s: validate function %s not found\n",
+                package_info.name.c_str(), validateFn);
+            ldp.pkt = nullptr;
+            return APPID_ENULL;
+        }
+        validate_function_ref = luaL_ref(my_lua_state, LUA_REGISTRYINDEX);
+    }
+
+    lua_rawgeti(my_lua_state, LUA_REGISTRYINDEX, validate_function_ref);
+
+    validate_calls++;
+    validate_time.start();
+    ffi_params = &ldp;
+    int status = lua_pcall(my_lua_state, 0, 1, 0);
+    ffi_params = nullptr;
+    validate_time.stop();
 
-    if ( lua_pcall(my_lua_state, 0, 1, 0) )
+    if ( status )
     {
         // Runtime Lua errors are suppressed in production code since detectors are written for
         // efficiency and with defensive minimum checks. Errors are dealt as exceptions
@@ -28,7 +28,10 @@
 #include <string>
 
 #include "client_plugins/client_detector.h"
+#include "framework/counts.h"
 #include "service_plugins/service_detector.h"
+#include "time/clock_defs.h"
+#include "time/stopwatch.h"
 
 #include "main/snort_debug.h"
 extern Trace TRACE_NAME(appid_module);
@@ -43,6 +46,28 @@ class AppIdSession;
 #define DETECTOR "Detector"
 #define DETECTORFLOW "DetectorFlow"
 
+// Detectors running under LuaJIT can read the packet being validated through the FFI instead of
+// the Detector methods, which avoids a C function call and Lua stack marshalling per field:
+//
+//     ffi.cdef[[ struct AppIdLuaPacket { const uint8_t* data; unsigned size; unsigned dir;
+//         unsigned proto; unsigned sp; unsigned dp; };
+//         const struct AppIdLuaPacket* appid_get_packet(); ]]
+//     local pkt = ffi.C.appid_get_packet()
+//
+// The pointer is only valid during the validate call and is null at any other time.
+struct AppIdLuaPacket
+{
+    const uint8_t* data;
+    unsigned size;
+    unsigned dir;
+    unsigned proto;
+    unsigned sp;
+    unsigned dp;
+};
+
+extern "C"
+const struct AppIdLuaPacket* appid_get_packet();
+
 struct DetectorPackageInfo
 {
     std::string initFunctionName;
@@ -83,6 +108,11 @@ public:
     int detector_user_data_ref = 0;    // key into LUA_REGISTRYINDEX
     DetectorPackageInfo package_info;
     unsigned int service_id = APP_ID_UNKNOWN;
+    int validate_function_ref = 0;      // resolved on first use, key into LUA_REGISTRYINDEX
+
+    // per thread cost of this detector
+    PegCount validate_calls = 0;
+    Stopwatch<SnortClock> validate_time;
 
     int lua_validate(AppIdDiscoveryArgs&);
 };
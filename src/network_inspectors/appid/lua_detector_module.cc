@@ -29,6 +29,7 @@
 #include <libgen.h>
 
 #include <cassert>
+#include <map>
 
 #include "appid_config.h"
 #include "lua_detector_util.h"
@@ -47,6 +48,15 @@
 static THREAD_LOCAL LuaDetectorManager* lua_detector_mgr;
 static THREAD_LOCAL SF_LIST allocated_detector_flow_list;
 
+struct LuaDetectorStats
+{
+    PegCount validate_calls = 0;
+    hr_duration validate_time = 0_ticks;
+};
+
+// totals by detector name; threads add theirs under the stats lock
+static std::map<std::string, LuaDetectorStats> lua_detector_stats;
+
 bool get_lua_field(lua_State* L, int table, const char* field, std::string& out)
 {
     lua_getfield(L, table, field);
@@ -431,3 +441,39 @@ void LuaDetectorManager::list_lua_detectors()
     LogMessage("Lua Stats total memory usage %zu kb\n", totalMem);
 }
 
+// each thread's detectors are loaded at runtime so their counts are kept
+// by name and shown with the dynamic stats rather than as module pegs
+void LuaDetectorManager::sum_stats()
+{
+    if ( !lua_detector_mgr )
+        return;
+
+    for ( auto& ld : lua_detector_mgr->allocated_detectors )
+    {
+        LuaStateDescriptor* lsd = ld->validate_lua_state(false);
+        if ( !lsd->validate_calls )
+            continue;
+
+        LuaDetectorStats& stats = lua_detector_stats[ld->get_name()];
+        stats.validate_calls += lsd->validate_calls;
+        stats.validate_time += lsd->validate_time.get();
+
+        lsd->validate_calls = 0;
+        lsd->validate_time.reset();
+    }
+}
+
+void LuaDetectorManager::print_stats()
+{
+    if ( lua_detector_stats.empty() )
+        return;
+
+    LogLabel("Appid lua detector stats:");
+
+    for ( const auto& it : lua_detector_stats )
+    {
+        LogMessage("%s: validate calls: %" PRIu64 ", time: %" PRIu64 " usecs\n",
+            it.first.c_str(), it.second.validate_calls,
+            (uint64_t)clock_usecs(TO_USECS(it.second.validate_time)));
+    }
+}
@@ -48,6 +48,8 @@ public:
     static void terminate();
     static void add_detector_flow(DetectorFlow*);
     static void free_detector_flows();
+    static void sum_stats();
+    static void print_stats();
 
 private:
     void initialize_lua_detectors();
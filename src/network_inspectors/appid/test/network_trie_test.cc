@@ -0,0 +1,117 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// network_trie_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "network_inspectors/appid/appid_utils/network_trie.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+static void put32(uint8_t* key, uint32_t ip)
+{
+    key[0] = ip >> 24;
+    key[1] = ip >> 16;
+    key[2] = ip >> 8;
+    key[3] = ip;
+}
+
+static uint32_t find32(const NetworkTrie& trie, uint32_t ip)
+{
+    uint8_t key[4];
+    put32(key, ip);
+    return trie.find(key);
+}
+
+static bool add32(NetworkTrie& trie, uint32_t lo, uint32_t hi, uint32_t value)
+{
+    uint8_t k_lo[4], k_hi[4];
+    put32(k_lo, lo);
+    put32(k_hi, hi);
+    return trie.add(k_lo, k_hi, value);
+}
+
+TEST_GROUP(network_trie)
+{
+};
+
+TEST(network_trie, ipv4_ranges)
+{
+    NetworkTrie trie(4, 16);
+
+    CHECK(add32(trie, 0x0a000000, 0x0affffff, 1));     // 10.0.0.0/8
+    CHECK(add32(trie, 0xc0a80110, 0xc0a8011f, 2));     // 192.168.1.16/28
+    CHECK(add32(trie, 0xc0a80120, 0xc0a80120, 3));     // 192.168.1.32
+    CHECK(add32(trie, 0xc0a80121, 0xc0a90005, 4));     // range crossing a /16
+
+    CHECK_EQUAL(0u, find32(trie, 0x09ffffff));
+    CHECK_EQUAL(1u, find32(trie, 0x0a000000));
+    CHECK_EQUAL(1u, find32(trie, 0x0a123456));
+    CHECK_EQUAL(1u, find32(trie, 0x0affffff));
+    CHECK_EQUAL(0u, find32(trie, 0x0b000000));
+    CHECK_EQUAL(0u, find32(trie, 0xc0a8010f));
+    CHECK_EQUAL(2u, find32(trie, 0xc0a80110));
+    CHECK_EQUAL(2u, find32(trie, 0xc0a8011f));
+    CHECK_EQUAL(3u, find32(trie, 0xc0a80120));
+    CHECK_EQUAL(4u, find32(trie, 0xc0a80121));
+    CHECK_EQUAL(4u, find32(trie, 0xc0a8ffff));
+    CHECK_EQUAL(4u, find32(trie, 0xc0a90005));
+    CHECK_EQUAL(0u, find32(trie, 0xc0a90006));
+}
+
+TEST(network_trie, overlap_keeps_first_value)
+{
+    NetworkTrie trie(4, 8);
+
+    CHECK(add32(trie, 0xc0a80100, 0xc0a801ff, 1));
+    CHECK(add32(trie, 0xc0a80000, 0xc0a8ffff, 2));
+    CHECK(add32(trie, 0, 0xffffffff, 3));
+
+    CHECK_EQUAL(1u, find32(trie, 0xc0a80180));
+    CHECK_EQUAL(2u, find32(trie, 0xc0a80080));
+    CHECK_EQUAL(2u, find32(trie, 0xc0a80280));
+    CHECK_EQUAL(3u, find32(trie, 0x01020304));
+    CHECK_EQUAL(3u, find32(trie, 0xffffffff));
+}
+
+TEST(network_trie, ipv6_prefix)
+{
+    NetworkTrie trie(16, 16);
+    uint8_t lo[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+    uint8_t hi[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+                       0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+    CHECK(trie.add(lo, hi, 7));                 // 2001:db8::/64
+    CHECK_FALSE(trie.add(hi, lo, 8));
+    CHECK_FALSE(trie.add(lo, hi, 0));
+
+    uint8_t key[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0x12, 0x34 };
+    CHECK_EQUAL(7u, trie.find(key));
+    key[7] = 1;
+    CHECK_EQUAL(0u, trie.find(key));
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
@@ -47,6 +47,9 @@ static const PegInfo bind_pegs[] =
     { CountType::SUM, "blocks", "block bindings" },
     { CountType::SUM, "allows", "allow bindings" },
     { CountType::SUM, "inspects", "inspect bindings" },
+    { CountType::SUM, "lookups", "binding lookups for flows and service changes" },
+    { CountType::SUM, "bindings", "total bindings configured at each lookup" },
+    { CountType::SUM, "checks", "bindings from the index checked at each lookup" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -33,6 +33,9 @@ struct BindStats
 {
     PegCount packets;
     PegCount verdicts[BindUse::BA_MAX];
+    PegCount lookups;
+    PegCount bindings;
+    PegCount checks;
 };
 
 extern THREAD_LOCAL BindStats bstats;
@@ -40,6 +40,7 @@
 
 #include "bind_module.h"
 #include "binding.h"
+#include "binding_index.h"
 
 using namespace snort;
 using namespace std;
@@ -595,6 +596,7 @@ private:
 
 private:
     vector<Binding*> bindings;
+    BindingIndex index;
 };
 
 // When a flow's service changes, re-evaluate service to inspector mapping.
@@ -644,6 +646,8 @@ bool Binder::configure(SnortConfig* sc)
             set_binding(sc, pb);
     }
 
+    index.build(bindings);
+
     DataBus::subscribe(FLOW_SERVICE_CHANGE_EVENT, new FlowServiceChangeHandler);
 
     return true;
@@ -664,6 +668,7 @@ void Binder::update(SnortConfig*, const char* name)
         {
             bindings.erase(it);
             delete pb;
+            index.build(bindings);
             return;
         }
     }
@@ -777,16 +782,21 @@ void Binder::set_binding(SnortConfig*, Binding* pb)
         ParseError("can't bind %s", key);
 }
 
-// FIXIT-P this is a simple linear search until functionality is nailed
-// down.  performance should be the focus of the next iteration.
+// the index only yields bindings that can match this flow, in configuration
+// order, so the first match here is the same as with a linear search
 void Binder::get_bindings(Flow* flow, Stuff& stuff, Packet* p)
 {
     Binding* pb;
-    unsigned i, sz = bindings.size();
+    unsigned i;
+    BindingIndex::Cursor cursor(index, flow);
+
+    bstats.lookups++;
+    bstats.bindings += bindings.size();
 
-    for ( i = 0; i < sz; i++ )
+    while ( cursor.next(i) )
     {
         pb = bindings[i];
+        bstats.checks++;
 
         if ( !pb->check_all(flow, p) )
             continue;
@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// binding_index.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "binding_index.h"
+
+#include <cassert>
+#include <climits>
+
+#include "flow/flow.h"
+#include "flow/flow_key.h"
+#include "protocols/packet.h"
+#include "sfip/sf_cidr.h"
+#include "sfip/sf_ipvar.h"
+
+#include "binding.h"
+
+using namespace snort;
+
+// a binding that covers more vlans or ports than this is cheaper to check than to file
+#define MAX_INDEXED_KEYS 64
+
+static inline uint32_t mask_net(uint32_t ip, uint16_t bits)
+{
+    // v4 prefix lengths are stored in the v6 space, ie 96 + n
+    const unsigned shift = 128 - bits;
+    return (ip >> shift) << shift;
+}
+
+// Binding::check_addr() is filed by network only when the result of sfvar_ip_in() is exactly
+// "the address is IPv4 and within one of these networks". That excludes negations, any, IPv6,
+// and 0.0.0.0 networks which match every IPv4 address.
+static bool get_v4_nets(const BindWhen& when, std::vector<std::pair<uint16_t, uint32_t>>& nets)
+{
+    if ( when.split_nets or !when.src_nets or when.src_nets->neg_head or !when.src_nets->head )
+        return false;
+
+    for ( const sfip_node_t* node = when.src_nets->head; node; node = node->next )
+    {
+        if ( (node->flags & (SFIP_NEGATED | SFIP_ANY)) or !node->ip->is_set() or
+            node->ip->get_family() != AF_INET )
+            return false;
+
+        const uint16_t bits = node->ip->get_bits();
+        const uint32_t net = ntohl(node->ip->get_addr()->get_ip4_value());
+
+        if ( bits <= 96 or bits > 128 or !net )
+            return false;
+
+        nets.emplace_back(bits, net);
+    }
+    return true;
+}
+
+template<typename Bits>
+static bool get_keys(const Bits& bits, std::vector<uint16_t>& keys)
+{
+    if ( bits.count() > MAX_INDEXED_KEYS )
+        return false;
+
+    for ( unsigned i = 0; i < bits.size(); i++ )
+        if ( bits.test(i) )
+            keys.push_back(i);
+
+    return !keys.empty();
+}
+
+void BindingIndex::add(Table& t, const Binding* pb, unsigned index)
+{
+    const BindWhen& when = pb->when;
+    std::vector<uint16_t> keys;
+
+    if ( get_keys(when.vlans, keys) )
+    {
+        for ( auto k : keys )
+            t.vlans[k].push_back(index);
+        return;
+    }
+
+    std::vector<std::pair<uint16_t, uint32_t>> nets;
+
+    if ( get_v4_nets(when, nets) )
+    {
+        std::vector<unsigned> tabs;
+
+        for ( const auto& n : nets )
+        {
+            unsigned nt = 0;
+
+            while ( nt < t.nets.size() and t.nets[nt].bits != n.first )
+                ++nt;
+
+            if ( nt == t.nets.size() )
+            {
+                if ( nt == MAX_NET_TABLES )
+                    break;
+
+                t.nets.push_back(NetTable());
+                t.nets.back().bits = n.first;
+            }
+            tabs.push_back(nt);
+        }
+
+        if ( tabs.size() == nets.size() )
+        {
+            for ( unsigned i = 0; i < nets.size(); i++ )
+            {
+                List& l = t.nets[tabs[i]].nets[nets[i].second];
+
+                // the same binding may list overlapping networks of the same size
+                if ( l.empty() or l.back() != index )
+                    l.push_back(index);
+            }
+            return;
+        }
+    }
+
+    if ( !when.split_ports and get_keys(when.src_ports, keys) )
+    {
+        for ( auto k : keys )
+            t.ports[k].push_back(index);
+        return;
+    }
+
+    t.any.push_back(index);
+}
+
+void BindingIndex::build(const std::vector<Binding*>& bindings)
+{
+    for ( auto& t : tables )
+    {
+        t.any.clear();
+        t.vlans.clear();
+        t.ports.clear();
+        t.nets.clear();
+    }
+
+    for ( unsigned i = 0; i < bindings.size(); i++ )
+    {
+        const Binding* pb = bindings[i];
+
+        // PktType::NONE has no proto bit so its table holds every binding
+        for ( unsigned type = 0; type < (unsigned)PktType::MAX; type++ )
+        {
+            if ( !type or (pb->when.protos & BIT(type)) )
+                add(tables[type], pb, i);
+        }
+    }
+}
+
+const BindingIndex::List* BindingIndex::find(
+    const std::unordered_map<uint16_t, List>& map, uint16_t key)
+{
+    auto it = map.find(key);
+    return (it == map.end()) ? nullptr : &it->second;
+}
+
+BindingIndex::Cursor::Cursor(const BindingIndex& index, const Flow* flow)
+{
+    unsigned type = (unsigned)flow->pkt_type;
+    const Table& t = index.tables[(type < (unsigned)PktType::MAX) ? type : 0];
+
+    add(&t.any);
+
+    if ( !t.vlans.empty() )
+        add(find(t.vlans, flow->key->vlan_tag));
+
+    if ( !t.ports.empty() )
+    {
+        add(find(t.ports, flow->client_port));
+
+        if ( flow->server_port != flow->client_port )
+            add(find(t.ports, flow->server_port));
+    }
+
+    for ( const auto& nt : t.nets )
+    {
+        if ( flow->client_ip.is_ip4() )
+        {
+            auto it = nt.nets.find(mask_net(ntohl(flow->client_ip.get_ip4_value()), nt.bits));
+            if ( it != nt.nets.end() )
+                add(&it->second);
+        }
+        if ( flow->server_ip.is_ip4() )
+        {
+            auto it = nt.nets.find(mask_net(ntohl(flow->server_ip.get_ip4_value()), nt.bits));
+            if ( it != nt.nets.end() )
+                add(&it->second);
+        }
+    }
+}
+
+void BindingIndex::Cursor::add(const List* l)
+{
+    if ( !l or l->empty() )
+        return;
+
+    assert(num_lists < MAX_LISTS);
+    lists[num_lists].pos = l->data();
+    lists[num_lists].end = l->data() + l->size();
+    ++num_lists;
+}
+
+bool BindingIndex::Cursor::next(unsigned& index)
+{
+    unsigned best = UINT_MAX;
+
+    for ( unsigned i = 0; i < num_lists; i++ )
+    {
+        if ( lists[i].pos != lists[i].end and *lists[i].pos < best )
+            best = *lists[i].pos;
+    }
+
+    if ( best == UINT_MAX )
+        return false;
+
+    // a binding can be on more than one of the lists, eg client and server port
+    for ( unsigned i = 0; i < num_lists; i++ )
+    {
+        if ( lists[i].pos != lists[i].end and *lists[i].pos == best )
+            ++lists[i].pos;
+    }
+
+    index = best;
+    return true;
+}
+
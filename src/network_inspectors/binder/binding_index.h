@@ -0,0 +1,96 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// binding_index.h
+
+#ifndef BINDING_INDEX_H
+#define BINDING_INDEX_H
+
+// BindingIndex narrows down the bindings that must be checked for a flow. It is built when the
+// binder is configured. Each binding is filed under the most selective of its vlans, IPv4
+// networks, or ports. A binding that can't be filed that way goes on a list that is always
+// checked. Separate tables are kept for each PktType. A lookup merges the lists that apply to
+// the flow, so candidates come back in configuration order and first match semantics are
+// unchanged. Every candidate must still pass Binding::check_all().
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "framework/decode_data.h"
+
+namespace snort
+{
+class Flow;
+}
+struct Binding;
+
+class BindingIndex
+{
+private:
+    typedef std::vector<unsigned> List;
+    static const unsigned MAX_NET_TABLES = 8;
+
+public:
+    void build(const std::vector<Binding*>&);
+
+    class Cursor
+    {
+    public:
+        Cursor(const BindingIndex&, const snort::Flow*);
+
+        // get the next candidate in configuration order
+        bool next(unsigned& index);
+
+    private:
+        void add(const List*);
+
+        struct Range
+        {
+            const unsigned* pos;
+            const unsigned* end;
+        };
+
+        static const unsigned MAX_LISTS = 4 + 2 * MAX_NET_TABLES;
+
+        Range lists[MAX_LISTS];
+        unsigned num_lists = 0;
+    };
+
+private:
+    struct NetTable
+    {
+        uint16_t bits;
+        std::unordered_map<uint32_t, List> nets;
+    };
+
+    struct Table
+    {
+        List any;
+        std::unordered_map<uint16_t, List> vlans;
+        std::unordered_map<uint16_t, List> ports;
+        std::vector<NetTable> nets;
+    };
+
+    void add(Table&, const Binding*, unsigned index);
+    static const List* find(const std::unordered_map<uint16_t, List>&, uint16_t key);
+
+    Table tables[(unsigned)PktType::MAX];
+};
+
+#endif
+
@@ -88,6 +88,9 @@ struct ReputationConfig
     table_flat_t* ip_list = nullptr;
     ListFiles list_files;
     std::string list_dir;
+    std::string update_file;
+    uint32_t update_interval = 60;
+    unsigned generation = 0;
 
     ~ReputationConfig();
 };
@@ -104,6 +107,9 @@ struct ReputationStats
     PegCount blacklisted;
     PegCount whitelisted;
     PegCount monitored;
+    PegCount flows;
+    PegCount reevaluated;
+    PegCount updates;
     PegCount memory_allocated;
 };
 
@@ -0,0 +1,422 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// reputation_delta.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "reputation_delta.h"
+
+#include <sys/stat.h>
+
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+#include "log/messages.h"
+#include "main/analyzer_command.h"
+#include "sfip/sf_cidr.h"
+#include "utils/endian.h"
+
+#include "reputation_parse.h"
+
+using namespace snort;
+
+//-------------------------------------------------------------------------
+// delta
+//-------------------------------------------------------------------------
+
+ReputationDelta::ReputationDelta(unsigned b, unsigned g, ReputationDelta* p) :
+    refs(1), base(b), generation(g)
+{
+    if ( !p )
+        return;
+
+    lengths = p->lengths;
+    count = p->count;
+
+    if ( p->depth < MAX_CHAIN )
+    {
+        prev = p;
+        prev->hold();
+        depth = p->depth + 1;
+        return;
+    }
+
+    // flatten the chain; newer entries are copied first and win
+    for ( const ReputationDelta* d = p; d; d = d->prev )
+    {
+        for ( const auto& t : d->tables )
+        {
+            Prefixes& prefixes = tables[t.first];
+            Index& keys = index[t.first];
+
+            for ( const auto& e : t.second )
+            {
+                prefixes.emplace(e.first, e.second);
+                keys.insert(e.first);
+            }
+        }
+    }
+}
+
+ReputationDelta::~ReputationDelta()
+{
+    if ( prev )
+        prev->release();
+}
+
+ReputationDelta::Key ReputationDelta::get_key(const uint32_t* addr, unsigned bits)
+{
+    uint8_t buf[16];
+    memcpy(buf, addr, sizeof(buf));
+
+    unsigned i = bits / 8;
+
+    if ( i < sizeof(buf) )
+    {
+        buf[i] &= (uint8_t)(0xFF00 >> (bits % 8));
+        memset(buf + i + 1, 0, sizeof(buf) - i - 1);
+    }
+
+    Key k;
+    memcpy(&k.hi, buf, sizeof(k.hi));
+    memcpy(&k.lo, buf + sizeof(k.hi), sizeof(k.lo));
+    return k;
+}
+
+ReputationDelta::Key ReputationDelta::get_key(const Key& k, unsigned bits)
+{
+    uint32_t addr[4];
+    memcpy(addr, &k.hi, sizeof(k.hi));
+    memcpy(addr + 2, &k.lo, sizeof(k.lo));
+    return get_key(addr, bits);
+}
+
+// the highest address covered by the prefix
+ReputationDelta::Key ReputationDelta::get_last(const Key& k, unsigned bits)
+{
+    uint8_t buf[16];
+    memcpy(buf, &k.hi, sizeof(k.hi));
+    memcpy(buf + sizeof(k.hi), &k.lo, sizeof(k.lo));
+
+    unsigned i = bits / 8;
+
+    if ( i < sizeof(buf) )
+    {
+        buf[i] |= (uint8_t)(0xFF >> (bits % 8));
+        memset(buf + i + 1, 0xFF, sizeof(buf) - i - 1);
+    }
+
+    Key last;
+    memcpy(&last.hi, buf, sizeof(last.hi));
+    memcpy(&last.lo, buf + sizeof(last.hi), sizeof(last.lo));
+    return last;
+}
+
+bool ReputationDelta::KeyLess::operator()(const Key& a, const Key& b) const
+{
+    if ( a.hi != b.hi )
+        return ntohll(a.hi) < ntohll(b.hi);
+
+    return ntohll(a.lo) < ntohll(b.lo);
+}
+
+const ReputationDelta::Entry* ReputationDelta::find(unsigned bits, const Key& k) const
+{
+    for ( const ReputationDelta* d = this; d; d = d->prev )
+    {
+        auto t = d->tables.find(bits);
+
+        if ( t == d->tables.end() )
+            continue;
+
+        auto it = t->second.find(k);
+
+        if ( it != t->second.end() )
+            return &it->second;
+    }
+    return nullptr;
+}
+
+// entries from earlier updates are copied before they are changed.  a new
+// prefix starts with the lists and removal of the delta prefix covering it.
+ReputationDelta::Entry& ReputationDelta::get_entry(unsigned bits, const Key& k)
+{
+    Prefixes& prefixes = tables[bits];
+    auto res = prefixes.emplace(k, Entry());
+    Entry& entry = res.first->second;
+
+    if ( !res.second )
+        return entry;
+
+    index[bits].insert(k);
+
+    if ( const Entry* old = prev ? prev->find(bits, k) : nullptr )
+    {
+        entry = *old;
+        return entry;
+    }
+
+    ++count;
+
+    auto it = lengths.begin();
+
+    while ( it != lengths.end() and *it > bits )
+        ++it;
+
+    if ( it == lengths.end() or *it != bits )
+        it = lengths.insert(it, bits) + 1;
+    else
+        ++it;
+
+    for ( ; it != lengths.end(); ++it )
+    {
+        if ( const Entry* cover = find(*it, get_key(k, *it)) )
+        {
+            entry = *cover;
+            break;
+        }
+    }
+    return entry;
+}
+
+// like the table, the latest list is last and the oldest is dropped
+// when there is no room
+static void add_list(IPrepInfo& info, char list_index)
+{
+    int i;
+
+    for ( i = 0; i < NUM_INDEX_PER_ENTRY and info.list_indexes[i]; ++i )
+    {
+        if ( info.list_indexes[i] == list_index )
+            return;
+    }
+
+    if ( i == NUM_INDEX_PER_ENTRY )
+    {
+        memmove(info.list_indexes, info.list_indexes + 1, NUM_INDEX_PER_ENTRY - 1);
+        i = NUM_INDEX_PER_ENTRY - 1;
+    }
+    info.list_indexes[i] = list_index;
+}
+
+// as with table inserts, more specific prefixes inside the changed prefix
+// get the same change
+bool ReputationDelta::add(const SfCidr& cidr, uint8_t list_index)
+{
+    unsigned bits = cidr.get_bits();
+
+    if ( bits > 128 )
+        return false;
+
+    Key key = get_key(cidr.get_addr()->get_ip6_ptr(), bits);
+    Key last = get_last(key, bits);
+    std::vector<std::pair<unsigned, Key>> changes { { bits, key } };
+    KeyLess less;
+
+    // only the longer prefixes from key through last are under this one
+    for ( auto len : lengths )
+    {
+        if ( len <= bits )
+            break;
+
+        for ( const ReputationDelta* d = this; d; d = d->prev )
+        {
+            auto t = d->index.find(len);
+
+            if ( t == d->index.end() )
+                continue;
+
+            for ( auto it = t->second.lower_bound(key);
+                it != t->second.end() and !less(last, *it); ++it )
+                changes.emplace_back(len, *it);
+        }
+    }
+
+    for ( const auto& c : changes )
+    {
+        Entry& entry = get_entry(c.first, c.second);
+
+        if ( list_index )
+            add_list(entry.info, (char)list_index);
+
+        else
+        {
+            memset(&entry.info, 0, sizeof(entry.info));
+
+            if ( entry.hide < bits + 1 )
+                entry.hide = bits + 1;
+        }
+    }
+    return true;
+}
+
+const ReputationDelta::Entry* ReputationDelta::lookup(const SfIp* ip) const
+{
+    const uint32_t* addr = ip->get_ip6_ptr();
+
+    for ( auto bits : lengths )
+    {
+        if ( const Entry* entry = find(bits, get_key(addr, bits)) )
+            return entry;
+    }
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------
+// packet threads
+//-------------------------------------------------------------------------
+
+static THREAD_LOCAL ReputationDelta* t_delta = nullptr;
+
+const ReputationDelta* reputation_get_delta(const ReputationConfig* config)
+{
+    if ( t_delta and t_delta->get_base() == config->generation )
+        return t_delta;
+
+    return nullptr;
+}
+
+void reputation_swap_delta(ReputationDelta* delta)
+{
+    if ( delta )
+    {
+        delta->hold();
+        reputationstats.updates++;
+    }
+
+    if ( t_delta )
+        t_delta->release();
+
+    t_delta = delta;
+}
+
+class ReputationUpdate : public AnalyzerCommand
+{
+public:
+    ReputationUpdate(ReputationDelta* d) : delta(d)
+    { delta->hold(); }
+
+    ~ReputationUpdate() override
+    { delta->release(); }
+
+    void execute(Analyzer&) override
+    { reputation_swap_delta(delta); }
+
+    const char* stringify() override
+    { return "REPUTATION_UPDATE"; }
+
+private:
+    ReputationDelta* delta;
+};
+
+//-------------------------------------------------------------------------
+// main thread
+//-------------------------------------------------------------------------
+
+static ReputationConfig* s_config = nullptr;
+static ReputationDelta* s_latest = nullptr;
+static unsigned s_generation = 0;
+
+static time_t s_last_check = 0;
+static time_t s_last_mtime = 0;
+
+static void drop_latest()
+{
+    if ( s_latest )
+    {
+        s_latest->release();
+        s_latest = nullptr;
+    }
+}
+
+// each table loaded gets a new generation; updates made against the
+// previous table are dropped and the watched file is applied again
+void reputation_set_config(ReputationConfig* config)
+{
+    config->generation = ++s_generation;
+    s_config = config->ip_list ? config : nullptr;
+    s_last_check = s_last_mtime = 0;
+    drop_latest();
+}
+
+void reputation_clear_config(ReputationConfig* config)
+{
+    if ( s_config != config )
+        return;
+
+    s_config = nullptr;
+    drop_latest();
+}
+
+bool reputation_update(const char* file, bool from_shell)
+{
+    if ( !s_config )
+    {
+        LogMessage("reputation: no address lists loaded, update ignored\n");
+        return false;
+    }
+
+    ReputationDelta* delta = new ReputationDelta(s_config->generation, ++s_generation, s_latest);
+
+    if ( !load_delta(file, s_config, delta) )
+    {
+        delta->release();
+        return false;
+    }
+
+    drop_latest();
+    s_latest = delta;
+
+    LogMessage("    Reputation update entries: %u\n", delta->get_count());
+    main_broadcast_command(new ReputationUpdate(delta), from_shell);
+    return true;
+}
+
+void reputation_check_update(void*)
+{
+    if ( !s_config or s_config->update_file.empty() )
+        return;
+
+    time_t now = time(nullptr);
+
+    if ( now - s_last_check < (time_t)s_config->update_interval )
+        return;
+
+    s_last_check = now;
+
+    char path[PATH_MAX+1];
+    struct stat st;
+
+    if ( !update_path_to_file(path, PATH_MAX, s_config->update_file.c_str()) or
+        stat(path, &st) or st.st_mtime == s_last_mtime )
+        return;
+
+    s_last_mtime = st.st_mtime;
+    reputation_update(s_config->update_file.c_str(), false);
+}
+
+void reputation_delta_term()
+{
+    s_config = nullptr;
+    drop_latest();
+}
+
@@ -0,0 +1,151 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// reputation_delta.h
+
+#ifndef REPUTATION_DELTA_H
+#define REPUTATION_DELTA_H
+
+// address list updates applied on top of the loaded reputation table
+// without a reload.  each update produces a new immutable delta holding
+// the prefixes it changed and a reference to the previous delta; lookups
+// walk the chain newest first and every MAX_CHAIN updates the chain is
+// flattened into the new delta.  the main thread builds it and broadcasts
+// it to the packet threads which swap it in between packets.  a delta is
+// freed when the last thread or later delta using it moves on.
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "reputation_config.h"
+
+namespace snort
+{
+struct SfCidr;
+struct SfIp;
+}
+
+class ReputationDelta
+{
+public:
+    struct Entry
+    {
+        // lists added since the table was loaded; next is not used
+        IPrepInfo info;
+
+        // table matches shorter than this were removed; 0 if none
+        uint8_t hide;
+    };
+
+    // base is the generation of the table this applies to
+    ReputationDelta(unsigned base, unsigned generation, ReputationDelta* prev = nullptr);
+    ~ReputationDelta();
+
+    // list_index of 0 removes the prefix from all lists
+    bool add(const snort::SfCidr&, uint8_t list_index);
+
+    // returns the longest prefix covering ip or null
+    const Entry* lookup(const snort::SfIp*) const;
+
+    unsigned get_base() const
+    { return base; }
+
+    unsigned get_generation() const
+    { return generation; }
+
+    unsigned get_count() const
+    { return count; }
+
+    void hold()
+    { ++refs; }
+
+    void release()
+    {
+        if ( !--refs )
+            delete this;
+    }
+
+private:
+    struct Key
+    {
+        uint64_t hi;
+        uint64_t lo;
+
+        bool operator==(const Key& k) const
+        { return hi == k.hi and lo == k.lo; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& k) const
+        { return std::hash<uint64_t>()(k.hi ^ (k.lo * 0x9E3779B97F4A7C15ull)); }
+    };
+
+    // address order so the prefixes under a shorter one are a range
+    struct KeyLess
+    {
+        bool operator()(const Key&, const Key&) const;
+    };
+
+    typedef std::unordered_map<Key, Entry, KeyHash> Prefixes;
+    typedef std::set<Key, KeyLess> Index;
+
+    static const unsigned MAX_CHAIN = 8;
+
+    static Key get_key(const uint32_t* addr, unsigned bits);
+    static Key get_key(const Key&, unsigned bits);
+    static Key get_last(const Key&, unsigned bits);
+
+    const Entry* find(unsigned bits, const Key&) const;
+    Entry& get_entry(unsigned bits, const Key&);
+
+    // prefixes changed by this update only
+    std::map<unsigned, Prefixes> tables;
+
+    // the same prefixes sorted for finding those under a new prefix
+    std::map<unsigned, Index> index;
+
+    // prefix lengths used anywhere in the chain, longest first
+    std::vector<unsigned> lengths;
+
+    ReputationDelta* prev = nullptr;
+    unsigned depth = 1;
+
+    std::atomic<unsigned> refs;
+    unsigned base;
+    unsigned generation;
+    unsigned count = 0;
+};
+
+// main thread
+void reputation_set_config(ReputationConfig*);
+void reputation_clear_config(ReputationConfig*);
+bool reputation_update(const char* file, bool from_shell);
+void reputation_check_update(void*);
+void reputation_delta_term();
+
+// packet threads
+const ReputationDelta* reputation_get_delta(const ReputationConfig*);
+void reputation_swap_delta(ReputationDelta*);
+
+#endif
+
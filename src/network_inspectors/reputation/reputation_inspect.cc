@@ -31,7 +31,9 @@
 #include "log/messages.h"
 #include "packet_io/active.h"
 #include "profiler/profiler.h"
+#include "time/periodic.h"
 
+#include "reputation_delta.h"
 #include "reputation_module.h"
 
 using namespace snort;
@@ -45,6 +47,9 @@ const PegInfo reputation_peg_names[] =
 { CountType::SUM, "blacklisted", "number of packets blacklisted" },
 { CountType::SUM, "whitelisted", "number of packets whitelisted" },
 { CountType::SUM, "monitored", "number of packets monitored" },
+{ CountType::SUM, "flows", "number of flows evaluated" },
+{ CountType::SUM, "reevaluated", "number of flows reevaluated after a table change" },
+{ CountType::SUM, "updates", "number of list updates swapped in" },
 { CountType::SUM, "memory_allocated", "total memory allocated" },
 
 { CountType::END, nullptr, nullptr }
@@ -65,54 +70,19 @@ const char* WhiteActionOption[] =
     nullptr
 };
 
-/*
- * Function prototype(s)
- */
-static void snort_reputation(ReputationConfig* GlobalConf, Packet* p);
-
 unsigned ReputationFlowData::inspector_id = 0;
 
-static ReputationData* set_new_reputation_data(Flow* flow)
-{
-    ReputationFlowData* fd = new ReputationFlowData;
-    flow->set_flow_data(fd);
-    return &fd->session;
-}
-
 static ReputationData* get_session_data(Flow* flow)
 {
     ReputationFlowData* fd = (ReputationFlowData*)flow->get_flow_data(
         ReputationFlowData::inspector_id);
 
-    return fd ? &fd->session : nullptr;
-}
-
-static bool is_reputation_disabled(Flow* flow)
-{
-    ReputationData* data;
-
-    if (!flow)
-        return false;
-
-    data = get_session_data(flow);
-
-    if (!data)
-        set_new_reputation_data(flow);
-
-    return data ? data->disabled : false;
-}
-
-static void disable_reputation(Flow* flow)
-{
-    ReputationData* data;
-
-    if (!flow)
-        return;
-
-    data = get_session_data(flow);
-
-    if (data)
-        data->disabled = true;
+    if ( !fd )
+    {
+        fd = new ReputationFlowData;
+        flow->set_flow_data(fd);
+    }
+    return &fd->session;
 }
 
 static void print_iplist_stats(ReputationConfig* config)
@@ -154,9 +124,16 @@ static void print_reputation_conf(ReputationConfig* config)
     LogMessage("\n");
 }
 
-static inline IPrepInfo* reputation_lookup(ReputationConfig* config, const SfIp* ip)
+// the table and the delta are matched together: table lists are used
+// unless a removal covers the table match, and lists added by updates to
+// a covering prefix are checked as well
+static inline const IPrepInfo* reputation_lookup(ReputationConfig* config,
+    const ReputationDelta* delta, const SfIp* ip, const IPrepInfo*& added)
 {
-    IPrepInfo* result;
+    const IPrepInfo* result;
+    int length = 0;
+
+    added = nullptr;
 
     if (!config->scanlocal)
     {
@@ -166,13 +143,27 @@ static inline IPrepInfo* reputation_lookup(ReputationConfig* config, const SfIp*
         }
     }
 
-    result = (IPrepInfo*)sfrt_flat_dir8x_lookup(ip, config->ip_list);
+    result = (IPrepInfo*)sfrt_flat_dir8x_lookup(ip, config->ip_list, length);
+
+    if (delta)
+    {
+        const ReputationDelta::Entry* entry = delta->lookup(ip);
+
+        if (entry)
+        {
+            if (length < entry->hide)
+                result = nullptr;
+
+            if (entry->info.list_indexes[0])
+                added = &entry->info;
+        }
+    }
 
     return (result);
 }
 
-static inline IPdecision get_reputation(ReputationConfig* config, IPrepInfo* rep_info,
-    uint32_t* listid, uint32_t ingress_zone, uint32_t egress_zone)
+static inline IPdecision get_reputation(ReputationConfig* config, const IPrepInfo* rep_info,
+    const IPrepInfo* added, uint32_t* listid, uint32_t ingress_zone, uint32_t egress_zone)
 {
     IPdecision decision = DECISION_NULL;
 
@@ -180,6 +171,12 @@ static inline IPdecision get_reputation(ReputationConfig* config, IPrepInfo* rep
     uint8_t* base = (uint8_t*)config->ip_list;
     ListFiles& list_info =  config->list_files;
 
+    if (!rep_info)
+    {
+        rep_info = added;
+        added = nullptr;
+    }
+
     while (rep_info)
     {
         int i;
@@ -208,26 +205,33 @@ static inline IPdecision get_reputation(ReputationConfig* config, IPrepInfo* rep
             }
         }
 
-        if (!rep_info->next)
-            break;
-        rep_info = (IPrepInfo*)(&base[rep_info->next]);
+        if (rep_info->next)
+            rep_info = (IPrepInfo*)(&base[rep_info->next]);
+        else
+        {
+            /*Lists added by updates are checked last like the latest table lists*/
+            rep_info = added;
+            added = nullptr;
+        }
     }
 
     return decision;
 }
 
-static bool decision_per_layer(ReputationConfig* config, Packet* p,
+static bool decision_per_layer(ReputationConfig* config, const ReputationDelta* delta, Packet* p,
     uint32_t ingressZone, uint32_t egressZone, const ip::IpApi& ip_api, IPdecision* decision_final)
 {
     const SfIp* ip;
     IPdecision decision;
-    IPrepInfo* result;
+    const IPrepInfo* result;
+    const IPrepInfo* added;
 
     ip = ip_api.get_src();
-    result = reputation_lookup(config, ip);
-    if (result)
+    result = reputation_lookup(config, delta, ip, added);
+    if (result || added)
     {
-        decision = get_reputation(config, result, &p->iplist_id, ingressZone, egressZone);
+        decision = get_reputation(config, result, added, &p->iplist_id, ingressZone,
+            egressZone);
 
         *decision_final = decision;
         if ( config->priority == decision)
@@ -235,10 +239,11 @@ static bool decision_per_layer(ReputationConfig* config, Packet* p,
     }
 
     ip = ip_api.get_dst();
-    result = reputation_lookup(config, ip);
-    if (result)
+    result = reputation_lookup(config, delta, ip, added);
+    if (result || added)
     {
-        decision = get_reputation(config, result, &p->iplist_id, ingressZone, egressZone);
+        decision = get_reputation(config, result, added, &p->iplist_id, ingressZone,
+            egressZone);
 
         *decision_final = decision;
         if ( config->priority == decision)
@@ -248,7 +253,8 @@ static bool decision_per_layer(ReputationConfig* config, Packet* p,
     return false;
 }
 
-static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
+static IPdecision reputation_decision(ReputationConfig* config, const ReputationDelta* delta,
+    Packet* p)
 {
     IPdecision decision_final = DECISION_NULL;
     uint32_t ingress_zone = 0;
@@ -274,7 +280,7 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
     {
         outer_layer = true;
 
-        if (decision_per_layer(config, p, ingress_zone, egress_zone,p->ptrs.ip_api,
+        if (decision_per_layer(config, delta, p, ingress_zone, egress_zone, p->ptrs.ip_api,
                 &decision_final))
             return decision_final;
 
@@ -292,22 +298,15 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
     /*Check INNER IP, when configured or only one layer*/
     if (!outer_layer || (config->nested_ip == INNER) || (config->nested_ip == ALL))
     {
-        decision_per_layer(config, p, ingress_zone, egress_zone, p->ptrs.ip_api,
+        decision_per_layer(config, delta, p, ingress_zone, egress_zone, p->ptrs.ip_api,
             &decision_final);
     }
 
     return (decision_final);
 }
 
-static void snort_reputation(ReputationConfig* config, Packet* p)
+static void apply_reputation(IPdecision decision, Packet* p)
 {
-    IPdecision decision;
-
-    if (!config->ip_list)
-        return;
-
-    decision = reputation_decision(config, p);
-
     if (DECISION_NULL == decision)
         return;
 
@@ -335,6 +334,49 @@ static void snort_reputation(ReputationConfig* config, Packet* p)
     }
 }
 
+static inline IPdecision snort_reputation(ReputationConfig* config, const ReputationDelta* delta,
+    Packet* p)
+{
+    if (!config->ip_list)
+        return DECISION_NULL;
+
+    return reputation_decision(config, delta, p);
+}
+
+// flows are evaluated on the first packet and the decision is cached.  it
+// is only recomputed when the generation changes (reload or update) and
+// only acted on again if it differs from the cached decision.
+static void flow_reputation(ReputationConfig* config, Packet* p)
+{
+    ReputationData* data = get_session_data(p->flow);
+    const ReputationDelta* delta = reputation_get_delta(config);
+    unsigned generation = delta ? delta->get_generation() : config->generation;
+
+    if ( data->generation == generation )
+        return;
+
+    IPdecision decision = snort_reputation(config, delta, p);
+    ++reputationstats.packets;
+
+    if ( !data->generation )
+        reputationstats.flows++;
+
+    else
+    {
+        reputationstats.reevaluated++;
+
+        if ( decision == data->decision )
+        {
+            data->generation = generation;
+            return;
+        }
+    }
+
+    data->decision = decision;
+    data->generation = generation;
+    apply_reputation(decision, p);
+}
+
 //-------------------------------------------------------------------------
 // class stuff
 //-------------------------------------------------------------------------
@@ -345,8 +387,10 @@ public:
     Reputation(ReputationConfig*);
     ~Reputation() override;
 
+    bool configure(SnortConfig*) override;
     void show(SnortConfig*) override;
     void eval(Packet*) override;
+    void tterm() override;
 
 private:
     ReputationConfig* config;
@@ -358,10 +402,19 @@ Reputation::Reputation(ReputationConfig* pc)
     reputationstats.memory_allocated = sfrt_flat_usage(config->ip_list);
 }
 
+// an instance carried over by a reload is not configured again so it
+// keeps its generation, its updates, and ownership of the update state
+bool Reputation::configure(SnortConfig*)
+{
+    reputation_set_config(config);
+    return true;
+}
+
 Reputation::~Reputation()
 {
     if ( config )
     {
+        reputation_clear_config(config);
         delete config;
     }
 }
@@ -378,14 +431,24 @@ void Reputation::eval(Packet* p)
     // precondition - what we registered for
     assert(p->has_ip());
 
-    if (!p->is_rebuilt() && !is_reputation_disabled(p->flow))
+    if ( p->is_rebuilt() )
+        return;
+
+    if ( p->flow )
+        flow_reputation(config, p);
+
+    else
     {
-        snort_reputation(config, p);
-        disable_reputation(p->flow);
+        apply_reputation(snort_reputation(config, reputation_get_delta(config), p), p);
         ++reputationstats.packets;
     }
 }
 
+void Reputation::tterm()
+{
+    reputation_swap_delta(nullptr);
+}
+
 //-------------------------------------------------------------------------
 // api stuff
 //-------------------------------------------------------------------------
@@ -399,6 +462,12 @@ static void mod_dtor(Module* m)
 static void reputation_init()
 {
     ReputationFlowData::init();
+    Periodic::register_handler(reputation_check_update, nullptr, 0, 1000);
+}
+
+static void reputation_term()
+{
+    reputation_delta_term();
 }
 
 static Inspector* reputation_ctor(Module* m)
@@ -431,7 +500,7 @@ const InspectApi reputation_api =
     nullptr, // buffers
     nullptr, // service
     reputation_init, // pinit
-    nullptr, // pterm
+    reputation_term, // pterm
     nullptr, // tinit
     nullptr, // tterm
     reputation_ctor,
@@ -21,12 +21,17 @@
 
 #include "flow/flow.h"
 
+#include "reputation_config.h"
+
 // Per-session data block containing current state
 // of the Reputation preprocessor for the session.
+// the decision is computed once per flow and only recomputed when the
+// table generation changes (ie after a reload).
 
 struct ReputationData
 {
-    bool disabled = false;
+    IPdecision decision = DECISION_NULL;
+    unsigned generation = 0;
 };
 
 class ReputationFlowData : public snort::FlowData
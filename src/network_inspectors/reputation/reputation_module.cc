@@ -25,10 +25,12 @@
 #include "reputation_module.h"
 
 #include <cassert>
+#include <lua.hpp>
 
 #include "log/messages.h"
 #include "utils/util.h"
 
+#include "reputation_delta.h"
 #include "reputation_parse.h"
 
 using namespace snort;
@@ -61,6 +63,12 @@ static const Parameter s_params[] =
     { "scan_local", Parameter::PT_BOOL, nullptr, "false",
       "inspect local address defined in RFC 1918" },
 
+    { "update_file", Parameter::PT_STRING, nullptr, nullptr,
+      "file of address list updates to apply when it changes" },
+
+    { "update_interval", Parameter::PT_INT, "1:", "60",
+      "minimum seconds between checks of update_file" },
+
     { "white", Parameter::PT_ENUM, "unblack|trust", "unblack",
       "specify the meaning of whitelist" },
 
@@ -70,6 +78,31 @@ static const Parameter s_params[] =
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+static const Parameter s_update_params[] =
+{
+    { "file", Parameter::PT_STRING, nullptr, nullptr,
+      "file of address list updates" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+static int update(lua_State* L)
+{
+    const char* file = luaL_checkstring(L, 1);
+
+    if ( !*file )
+        return luaL_argerror(L, 1, "file required");
+
+    reputation_update(file, true);
+    return 0;
+}
+
+static const Command reputation_cmds[] =
+{
+    { "update", update, s_update_params, "add and remove addresses without a reload" },
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 static const RuleMap reputation_rules[] =
 {
     { REPUTATION_EVENT_BLACKLIST, REPUTATION_EVENT_BLACKLIST_STR },
@@ -94,6 +127,9 @@ ReputationModule::~ReputationModule()
         delete conf;
 }
 
+const Command* ReputationModule::get_commands() const
+{ return reputation_cmds; }
+
 const RuleMap* ReputationModule::get_rules() const
 { return reputation_rules; }
 
@@ -126,6 +162,12 @@ bool ReputationModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("scan_local") )
         conf->scanlocal = v.get_bool();
 
+    else if ( v.is("update_file") )
+        conf->update_file = v.get_string();
+
+    else if ( v.is("update_interval") )
+        conf->update_interval = v.get_long();
+
     else if ( v.is("white") )
         conf->white_action = (WhiteAction)v.get_long();
 
@@ -57,6 +57,7 @@ public:
     unsigned get_gid() const override
     { return GID_REPUTATION; }
 
+    const snort::Command* get_commands() const override;
     const snort::RuleMap* get_rules() const override;
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
@@ -36,6 +36,8 @@
 #include "utils/util.h"
 #include "utils/util_cstring.h"
 
+#include "reputation_delta.h"
+
 using namespace std;
 
 enum
@@ -514,7 +516,7 @@ static int process_line(char* line, INFO info, ReputationConfig* config)
     return add_ip(&address, info, config);
 }
 
-static int update_path_to_file(char* full_filename, unsigned int max_size, const char* filename)
+int update_path_to_file(char* full_filename, unsigned int max_size, const char* filename)
 {
     const char* snort_conf_dir = get_snort_conf_dir();
 
@@ -771,6 +773,91 @@ void add_black_white_List(ReputationConfig* config)
     }
 }
 
+static uint8_t get_list_index(const ReputationConfig* config, const char* name)
+{
+    for (auto& file : config->list_files)
+    {
+        const char* base = strrchr(file->file_name.c_str(), '/');
+        base = base ? base + 1 : file->file_name.c_str();
+
+        if (file->file_name == name || !strcmp(base, name))
+            return file->list_index;
+    }
+    return 0;
+}
+
+/* Each line of an update file is either "+ <address> <list>" to add the
+ * address to the list with that file name or "- <address>" to remove it
+ * from all lists.  Updates are added to the delta in order.
+ */
+bool load_delta(const char* file, const ReputationConfig* config, ReputationDelta* delta)
+{
+    char linebuf[MAX_ADDR_LINE_LENGTH];
+    char full_path_filename[PATH_MAX+1];
+    int addrline = 0;
+    FILE* fp;
+    char* cmt;
+
+    unsigned int invalid_count = 0;
+    unsigned int num_loaded_before = delta->get_count();
+
+    if (!update_path_to_file(full_path_filename, PATH_MAX, file))
+        return false;
+
+    LogMessage("    Processing update file %s\n", full_path_filename);
+
+    if ((fp = fopen(full_path_filename, "r")) == nullptr)
+    {
+        ErrorMessage("Unable to open update file %s, Error: %s\n", full_path_filename,
+            get_error(errno));
+        return false;
+    }
+
+    while ( fgets(linebuf, MAX_ADDR_LINE_LENGTH, fp) )
+    {
+        addrline++;
+
+        if ( (cmt = strchr(linebuf, '#')) )
+            *cmt = '\0';
+
+        char* save = nullptr;
+        const char* op = strtok_r(linebuf, " \t\r\n", &save);
+
+        if (!op)
+            continue;
+
+        const char* addr = strtok_r(nullptr, " \t\r\n", &save);
+        const char* list = strtok_r(nullptr, " \t\r\n", &save);
+
+        snort::SfCidr address;
+        uint8_t list_index = 0;
+        bool ok = addr && snort_pton(addr, &address) > 0;
+
+        if (ok && !strcmp(op, "+"))
+            ok = list && (list_index = get_list_index(config, list));
+
+        else if (ok && strcmp(op, "-"))
+            ok = false;
+
+        if (ok && delta->add(address, list_index))
+            continue;
+
+        if (invalid_count++ < MAX_MSGS_TO_PRINT)
+            ErrorMessage("      (%d) => Invalid update\n", addrline);
+    }
+
+    total_invalids += invalid_count;
+
+    if (invalid_count > MAX_MSGS_TO_PRINT)
+        ErrorMessage("    Additional invalid updates were not listed.\n");
+
+    LogMessage("    Reputation updates loaded: %u, invalid: %u (from file %s)\n",
+        delta->get_count() - num_loaded_before, invalid_count, full_path_filename);
+
+    fclose(fp);
+    return true;
+}
+
 /*Ignore the space characters from string*/
 static char* ignore_start_space(char* str)
 {
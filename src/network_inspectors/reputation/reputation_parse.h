@@ -24,9 +24,13 @@
 
 #define MANIFEST_FILENAME "zone.info"
 
+class ReputationDelta;
+
 void ip_list_init(uint32_t,ReputationConfig *config);
 void estimate_num_entries(ReputationConfig* config);
 int read_manifest(const char* filename, ReputationConfig* config);
 void add_black_white_List(ReputationConfig* config);
+int update_path_to_file(char* full_filename, unsigned int max_size, const char* filename);
+bool load_delta(const char* filename, const ReputationConfig*, ReputationDelta*);
 
 #endif
@@ -34,6 +34,7 @@ extern "C" {
 
 #include "log/messages.h"
 #include "main/snort_config.h"
+#include "main/thread_config.h"
 #include "protocols/packet.h"
 #include "protocols/vlan.h"
 
@@ -344,6 +345,12 @@ bool SFDAQInstance::configure(const SnortConfig* sc)
 
     printf("cfg.name = %s\n", cfg.name);
 
+    // the shard daq splits one file across all packet threads; this
+    // can still be overridden below
+    if (!strcasecmp(type, "shard"))
+        daq_config_set_value(&cfg, "shards",
+            std::to_string(ThreadConfig::get_instance_max()).c_str());
+
     for (auto& kvp : sc->daq_config->variables)
     {
         daq_config_set_value(&cfg, kvp.first.c_str(),
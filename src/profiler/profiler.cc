@@ -27,13 +27,16 @@
 #include <cassert>
 
 #include "framework/module.h"
+#include "log/messages.h"
 #include "main/snort_config.h"
 
 #include "memory_context.h"
 #include "memory_profiler.h"
 #include "profiler_nodes.h"
+#include "profiler_snapshot.h"
 #include "rule_profiler.h"
 #include "time_profiler.h"
+#include "time_sampler.h"
 
 #ifdef UNIT_TEST
 #include "catch/snort_catch.h"
@@ -71,6 +74,19 @@ void Profiler::register_module(const char* n, const char* pn, get_profile_stats_
     s_profiler_nodes.register_node(n, pn, fn);
 }
 
+void Profiler::thread_init()
+{
+    const auto* config = SnortConfig::get_profiler();
+
+    if ( config && config->time.sample )
+        start_time_sampler(config->time.sample);
+}
+
+void Profiler::thread_term()
+{
+    stop_time_sampler(s_profiler_nodes);
+}
+
 void Profiler::consolidate_stats()
 {
     s_profiler_nodes.accumulate_nodes();
@@ -83,6 +99,16 @@ void Profiler::reset_stats()
     reset_rule_profiler_stats();
 }
 
+void Profiler::accumulate_snapshot()
+{
+    accumulate_profiler_snapshot(s_profiler_nodes);
+}
+
+void Profiler::write_snapshot(std::string& file)
+{
+    write_profiler_snapshot(s_profiler_nodes, file);
+}
+
 void Profiler::show_stats()
 {
     const auto* config = SnortConfig::get_profiler();
@@ -91,6 +117,13 @@ void Profiler::show_stats()
     show_time_profiler_stats(s_profiler_nodes, config->time);
     show_memory_profiler_stats(s_profiler_nodes, config->memory);
     show_rule_profiler_stats(config->rule);
+
+    if ( config->time.sample )
+    {
+        std::string file;
+        write_folded_stacks(file);
+        LogMessage("== profile folded stacks written to %s\n", file.c_str());
+    }
 }
 
 #ifdef UNIT_TEST
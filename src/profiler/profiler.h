@@ -21,6 +21,8 @@
 #ifndef PROFILER_H
 #define PROFILER_H
 
+#include <string>
+
 #include "profiler_defs.h"
 
 namespace snort
@@ -35,11 +37,20 @@ public:
     static void register_module(const char*, const char*, snort::Module*);
     static void register_module(const char*, const char*, snort::get_profile_stats_fn);
 
+    // start and stop module time sampling on packet threads
+    static void thread_init();
+    static void thread_term();
+
     // FIXIT-L do we need to call on main thread?
     // call from packet threads, just before thread termination
     static void consolidate_stats();
     static void reset_stats();
     static void show_stats();
+
+    // live snapshot from running packet threads; accumulate from each
+    // packet thread, then write from the main thread
+    static void accumulate_snapshot();
+    static void write_snapshot(std::string& file);
 };
 
 
@@ -36,6 +36,8 @@ struct ProfilerConfig
     TimeProfilerConfig time;
     RuleProfilerConfig rule;
     MemoryProfilerConfig memory;
+
+    unsigned snapshot_interval = 0;  // seconds, 0 = disabled
 };
 
 struct SO_PUBLIC ProfileStats
@@ -122,6 +122,20 @@ void ProfilerNode::accumulate()
     }
 }
 
+const ProfileStats* ProfilerNode::get_local_stats() const
+{ return is_set() ? (*getter)() : nullptr; }
+
+void ProfilerNode::accumulate_snapshot()
+{
+    if ( is_set() )
+    {
+        const auto* local_stats = (*getter)();
+
+        if ( local_stats )
+            snapshot += *local_stats;
+    }
+}
+
 void ProfilerNodeMap::register_node(const std::string &n, const char* pn, Module* m)
 { setup_node(get_node(n), get_node(pn ? pn : ROOT_NODE), m); }
 
@@ -143,6 +157,21 @@ void ProfilerNodeMap::reset_nodes()
         it->second.reset();
 }
 
+void ProfilerNodeMap::accumulate_snapshots()
+{
+    static std::mutex snapshot_mutex;
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+
+    for ( auto it = nodes.begin(); it != nodes.end(); ++it )
+        it->second.accumulate_snapshot();
+}
+
+void ProfilerNodeMap::reset_snapshots()
+{
+    for ( auto it = nodes.begin(); it != nodes.end(); ++it )
+        it->second.reset_snapshot();
+}
+
 const ProfilerNode& ProfilerNodeMap::get_root()
 { return get_node(ROOT_NODE); }
 
@@ -49,6 +49,12 @@ public:
     // thread local call
     void accumulate();
 
+    // thread local call; nullptr if unset
+    const snort::ProfileStats* get_local_stats() const;
+
+    // thread local call; totals live threads separately from the above
+    void accumulate_snapshot();
+
     const snort::ProfileStats& get_stats() const
     { return stats; }
 
@@ -58,6 +64,12 @@ public:
     void reset()
     { stats.reset(); }
 
+    const snort::ProfileStats& get_snapshot() const
+    { return snapshot; }
+
+    void reset_snapshot()
+    { snapshot.reset(); }
+
     void add_child(ProfilerNode* node)
     { children.push_back(node); }
 
@@ -70,6 +82,7 @@ private:
     std::vector<ProfilerNode*> children;
     std::shared_ptr<GetProfileFunctor> getter;
     snort::ProfileStats stats;
+    snort::ProfileStats snapshot;
 };
 
 inline bool operator==(const ProfilerNode& lhs, const ProfilerNode& rhs)
@@ -95,6 +108,9 @@ public:
     void accumulate_nodes();
     void reset_nodes();
 
+    void accumulate_snapshots();
+    void reset_snapshots();
+
     const ProfilerNode& get_root();
 
 private:
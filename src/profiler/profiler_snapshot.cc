@@ -0,0 +1,334 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// profiler_snapshot.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "profiler_snapshot.h"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "detection/detection_options.h"
+#include "detection/treenodes.h"
+#include "main/snort_config.h"
+#include "main/thread.h"
+
+#include "profiler_nodes.h"
+
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
+using namespace snort;
+
+struct RuleTotals
+{
+    uint32_t gid = 0;
+    uint32_t sid = 0;
+    uint32_t rev = 0;
+    OtnState state;
+};
+
+// rules are keyed by gid:sid so deltas carry across reloads
+using RuleMap = std::unordered_map<uint64_t, RuleTotals>;
+using ModuleMap = std::unordered_map<std::string, ProfileStats>;
+
+static std::mutex s_rule_mutex;
+static RuleMap s_rules;
+static unsigned s_threads = 0;
+
+static RuleMap s_prev_rules;
+static ModuleMap s_prev_modules;
+static unsigned s_snapshots = 0;
+static time_t s_prev_time = 0;
+
+static void add(OtnState& lhs, const OtnState& rhs)
+{
+    lhs.elapsed += rhs.elapsed;
+    lhs.elapsed_match += rhs.elapsed_match;
+    lhs.checks += rhs.checks;
+    lhs.matches += rhs.matches;
+    lhs.alerts += rhs.alerts;
+    lhs.latency_timeouts += rhs.latency_timeouts;
+    lhs.latency_suspends += rhs.latency_suspends;
+}
+
+void accumulate_profiler_snapshot(ProfilerNodeMap& nodes)
+{
+    nodes.accumulate_snapshots();
+
+    OtnStatsMap otns;
+    std::lock_guard<std::mutex> lock(s_rule_mutex);
+
+    detection_option_tree_get_otn_stats(
+        SnortConfig::get_conf()->detection_option_tree_hash_table, get_instance_id(), otns);
+
+    for ( const auto& it : otns )
+    {
+        const SigInfo& si = it.first->sigInfo;
+        RuleTotals& rt = s_rules[((uint64_t)si.gid << 32) | si.sid];
+
+        rt.gid = si.gid;
+        rt.sid = si.sid;
+        rt.rev = si.rev;
+        add(rt.state, it.second);
+    }
+    ++s_threads;
+}
+
+//-------------------------------------------------------------------------
+// json
+//-------------------------------------------------------------------------
+
+// totals start over when the rules are reloaded so a count that went down
+// is a reset and the delta is everything counted since then
+template<typename T>
+static T delta(T now, T prev)
+{ return now < prev ? now : now - prev; }
+
+// a rule or module is reset as a whole so the check count decides for all
+// of its fields; otherwise a field that passed its prior total would look
+// like it barely moved
+static const OtnState& get_prev(const OtnState& now, const OtnState& prev)
+{
+    static const OtnState zero;
+    return now.checks < prev.checks ? zero : prev;
+}
+
+static const ProfileStats& get_prev(const ProfileStats& now, const ProfileStats& prev)
+{
+    static const ProfileStats zero;
+    return now.time.checks < prev.time.checks ? zero : prev;
+}
+
+static void put(std::ostream& os, const char* key, uint64_t now, uint64_t prev)
+{
+    os << ", \"" << key << "\": " << now;
+    os << ", \"" << key << "_delta\": " << delta(now, prev);
+}
+
+static uint64_t usecs(hr_duration d)
+{ return clock_usecs(TO_USECS(d)); }
+
+static void put_module(
+    std::ostream& os, const ProfilerNode& node, const char* parent, bool& first)
+{
+    ProfileStats now = node.get_stats();
+    now += node.get_snapshot();
+
+    ProfileStats& last = s_prev_modules[node.name];
+    const ProfileStats& prev = get_prev(now, last);
+
+    if ( now.time or now.memory.stats )
+    {
+        MemoryStats mn = now.memory.stats.startup + now.memory.stats.runtime;
+        MemoryStats mp = prev.memory.stats.startup + prev.memory.stats.runtime;
+
+        os << (first ? "" : ", ") << "{ \"name\": \"" << node.name << "\"";
+        os << ", \"parent\": \"" << parent << "\"";
+
+        put(os, "checks", now.time.checks, prev.time.checks);
+        put(os, "time_us", usecs(now.time.elapsed), usecs(prev.time.elapsed));
+        put(os, "allocs", mn.allocs, mp.allocs);
+        put(os, "deallocs", mn.deallocs, mp.deallocs);
+        put(os, "allocated", mn.allocated, mp.allocated);
+        put(os, "deallocated", mn.deallocated, mp.deallocated);
+
+        os << " }";
+        first = false;
+    }
+    last = now;
+
+    for ( const auto* child : node.get_children() )
+        put_module(os, *child, node.name.c_str(), first);
+}
+
+static uint64_t key(const RuleTotals& rt)
+{ return ((uint64_t)rt.gid << 32) | rt.sid; }
+
+static void put_rules(std::ostream& os)
+{
+    using Entry = std::pair<hr_duration, const RuleTotals*>;
+    std::vector<Entry> active;
+
+    for ( const auto& it : s_rules )
+    {
+        const OtnState& now = it.second.state;
+        const OtnState& prev = get_prev(now, s_prev_rules[it.first].state);
+
+        if ( now.checks != prev.checks or now.alerts != prev.alerts )
+            active.emplace_back(delta(now.elapsed, prev.elapsed), &it.second);
+    }
+
+    // worst first by time spent since the prior snapshot
+    std::sort(active.begin(), active.end(),
+        [](const Entry& lhs, const Entry& rhs)
+        {
+            if ( lhs.first != rhs.first )
+                return lhs.first > rhs.first;
+            return key(*lhs.second) < key(*rhs.second);
+        });
+
+    unsigned max = SnortConfig::get_profiler()->rule.count;
+
+    if ( max and active.size() > max )
+        active.resize(max);
+
+    bool first = true;
+
+    for ( const auto& e : active )
+    {
+        const RuleTotals* rt = e.second;
+        const OtnState& now = rt->state;
+        const OtnState& prev = get_prev(now, s_prev_rules[key(*rt)].state);
+
+        os << (first ? "" : ", ") << "{ \"gid\": " << rt->gid;
+        os << ", \"sid\": " << rt->sid << ", \"rev\": " << rt->rev;
+
+        put(os, "checks", now.checks, prev.checks);
+        put(os, "matches", now.matches, prev.matches);
+        put(os, "alerts", now.alerts, prev.alerts);
+        put(os, "time_us", usecs(now.elapsed), usecs(prev.elapsed));
+        put(os, "match_time_us", usecs(now.elapsed_match), usecs(prev.elapsed_match));
+        put(os, "timeouts", now.latency_timeouts, prev.latency_timeouts);
+        put(os, "suspends", now.latency_suspends, prev.latency_suspends);
+
+        os << " }";
+        first = false;
+    }
+}
+
+void write_profiler_snapshot(ProfilerNodeMap& nodes, std::string& file)
+{
+    time_t now = time(nullptr);
+    std::ostringstream ss;
+
+    ss << "{ \"snapshot\": " << ++s_snapshots;
+    ss << ", \"time\": " << now;
+    ss << ", \"interval\": " << (s_prev_time ? now - s_prev_time : 0);
+    ss << ", \"threads\": " << s_threads;
+
+    ss << ", \"modules\": [ ";
+    bool first = true;
+    put_module(ss, nodes.get_root(), "", first);
+    ss << " ]";
+
+    ss << ", \"rules\": [ ";
+    put_rules(ss);
+    ss << " ] }\n";
+
+    file = SnortConfig::get_conf()->log_dir.empty() ? "." : SnortConfig::get_conf()->log_dir;
+    file += '/';
+    file += SnortConfig::get_conf()->run_prefix;
+    file += "profile_snapshot.json";
+
+    std::ofstream ofs(file, std::ios::app);
+    ofs << ss.str();
+
+    // rules that stopped firing keep their last totals for future deltas
+    for ( auto& it : s_rules )
+        s_prev_rules[it.first] = it.second;
+
+    s_rules.clear();
+    s_threads = 0;
+    s_prev_time = now;
+    nodes.reset_snapshots();
+}
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+TEST_CASE("snapshot delta", "[profiler][snapshot]")
+{
+    SECTION("counts")
+    {
+        CHECK(delta<uint64_t>(10, 4) == 6);
+        CHECK(delta<uint64_t>(4, 4) == 0);
+        CHECK(delta<uint64_t>(3, 10) == 3);
+    }
+    SECTION("durations")
+    {
+        CHECK(delta(hr_duration(10), hr_duration(4)) == hr_duration(6));
+        CHECK(delta(hr_duration(3), hr_duration(10)) == hr_duration(3));
+    }
+    SECTION("json")
+    {
+        std::ostringstream ss;
+        put(ss, "checks", 3, 10);
+        CHECK(ss.str() == ", \"checks\": 3, \"checks_delta\": 3");
+    }
+}
+
+TEST_CASE("snapshot reset", "[profiler][snapshot]")
+{
+    OtnState prev;
+    prev.checks = 100;
+    prev.alerts = 5;
+    prev.elapsed = hr_duration(1000);
+
+    OtnState now;
+
+    SECTION("continued")
+    {
+        now.checks = 150;
+        now.alerts = 6;
+        now.elapsed = hr_duration(1200);
+
+        const OtnState& p = get_prev(now, prev);
+        CHECK(&p == &prev);
+        CHECK(delta(now.checks, p.checks) == 50);
+        CHECK(delta(now.elapsed, p.elapsed) == hr_duration(200));
+    }
+    SECTION("reloaded")
+    {
+        // alerts passed the prior total but the rule still started over
+        now.checks = 20;
+        now.alerts = 7;
+        now.elapsed = hr_duration(300);
+
+        const OtnState& p = get_prev(now, prev);
+        CHECK(p.checks == 0);
+        CHECK(delta(now.alerts, p.alerts) == 7);
+        CHECK(delta(now.elapsed, p.elapsed) == hr_duration(300));
+    }
+    SECTION("module")
+    {
+        ProfileStats last;
+        last.time.checks = 100;
+
+        ProfileStats cur;
+        cur.time.checks = 10;
+        CHECK(get_prev(cur, last).time.checks == 0);
+
+        cur.time.checks = 110;
+        CHECK(&get_prev(cur, last) == &last);
+    }
+}
+
+#endif
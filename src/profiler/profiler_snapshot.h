@@ -0,0 +1,37 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// profiler_snapshot.h
+
+#ifndef PROFILER_SNAPSHOT_H
+#define PROFILER_SNAPSHOT_H
+
+// live snapshots of the module and rule profiles.  each packet thread adds
+// its thread local stats when it executes the snapshot command; the main
+// thread then writes the totals and the deltas since the prior snapshot.
+
+#include <string>
+
+class ProfilerNodeMap;
+
+// call from packet threads
+void accumulate_profiler_snapshot(ProfilerNodeMap&);
+
+// call from main thread once all packet threads have accumulated
+void write_profiler_snapshot(ProfilerNodeMap&, std::string& file);
+
+#endif
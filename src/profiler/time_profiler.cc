@@ -523,6 +523,63 @@ TEST_CASE( "time profiler time context", "[profiler][time_profiler]" )
     }
 }
 
+TEST_CASE( "time profiler sampled context", "[profiler][time_profiler]" )
+{
+    TimeSampleStack stack;
+    TimeProfilerStats outer, inner;
+
+    bool was_sampling = time_sampling;
+    time_sampling = true;
+    time_samples = &stack;
+
+    SECTION( "lifo" )
+    {
+        {
+            TimeContext ctx1(outer);
+            TimeContext ctx2(inner);
+
+            CHECK( stack.depth == 2 );
+            CHECK( stack.scopes[0] == &outer );
+            CHECK( stack.scopes[1] == &inner );
+        }
+
+        CHECK( stack.depth == 0 );
+        CHECK( outer.checks == 1 );
+        CHECK( inner.checks == 1 );
+    }
+
+    SECTION( "outer stopped first" )
+    {
+        TimeContext ctx1(outer);
+        TimeContext ctx2(inner);
+
+        ctx1.stop();
+
+        CHECK( stack.depth == 1 );
+        CHECK( stack.scopes[0] == &inner );
+
+        ctx2.stop();
+
+        CHECK( stack.depth == 0 );
+    }
+
+    SECTION( "unsampled thread" )
+    {
+        time_samples = nullptr;
+
+        {
+            TimeContext ctx(outer);
+            avoid_optimization();
+        }
+
+        CHECK( stack.depth == 0 );
+        CHECK( outer );
+    }
+
+    time_samples = nullptr;
+    time_sampling = was_sampling;
+}
+
 TEST_CASE( "time context exclude", "[profiler][time_profiler]" )
 {
     // NOTE: this test *may* fail if the time it takes to execute the exclude context is 0_ticks (unlikely)
@@ -21,7 +21,11 @@
 #ifndef TIME_PROFILER_DEFS_H
 #define TIME_PROFILER_DEFS_H
 
+#include <atomic>
+#include <cassert>
+
 #include "main/snort_types.h"
+#include "main/thread.h"
 #include "time/clock_defs.h"
 #include "time/stopwatch.h"
 
@@ -38,6 +42,7 @@ struct TimeProfilerConfig
     bool show = false;
     unsigned count = 0;
     int max_depth = -1;
+    unsigned sample = 0;  // usecs between samples, 0 = time every scope
 };
 
 struct SO_PUBLIC TimeProfilerStats
@@ -82,6 +87,56 @@ inline TimeProfilerStats& operator+=(TimeProfilerStats& lhs, const TimeProfilerS
     return lhs;
 }
 
+// when sampling, scopes just push and pop their stats here and a per
+// thread cpu timer charges the sample period to everything on the stack
+struct TimeSampleStack
+{
+    static constexpr unsigned max_depth = 32;
+
+    TimeProfilerStats* scopes[max_depth];
+    volatile unsigned depth = 0;
+
+    void push(TimeProfilerStats* stats)
+    {
+        if ( depth < max_depth )
+            scopes[depth] = stats;
+
+        // the sampler runs in a signal handler on this thread
+        std::atomic_signal_fence(std::memory_order_release);
+        depth = depth + 1;
+    }
+
+    // contexts stopped early with stop() can unwind out of order so the
+    // scope is removed wherever it is; frames past max_depth aren't kept
+    void pop(const TimeProfilerStats* stats)
+    {
+        unsigned top = depth;
+        assert(top);
+
+        if ( top <= max_depth )
+        {
+            unsigned i = top - 1;
+
+            while ( i and scopes[i] != stats )
+                --i;
+
+            assert(scopes[i] == stats);
+
+            for ( ; i + 1 < top; ++i )
+                scopes[i] = scopes[i + 1];
+
+            std::atomic_signal_fence(std::memory_order_release);
+        }
+        depth = top - 1;
+    }
+};
+
+// set once any thread starts sampling so unsampled runs skip the tls lookup
+SO_PUBLIC extern std::atomic<bool> time_sampling;
+
+// null unless this thread is sampled
+SO_PUBLIC extern THREAD_LOCAL TimeSampleStack* time_samples;
+
 class TimeContext
 {
 public:
@@ -89,7 +144,16 @@ public:
         stats(stats)
     {
         if ( stats.enter() )
-            sw.start();
+        {
+            if ( time_sampling.load(std::memory_order_relaxed) and time_samples )
+            {
+                time_samples->push(&stats);
+                ++stats.checks;
+                sampled = true;
+            }
+            else
+                sw.start();
+        }
     }
 
     ~TimeContext()
@@ -104,7 +168,12 @@ public:
         stopped_once = true;
 
         // don't bother updating time if context is reentrant
-        if ( stats.exit() )
+        if ( !stats.exit() )
+            return;
+
+        if ( sampled )
+            time_samples->pop(&stats);
+        else
             stats.update(sw.get());
     }
 
@@ -115,6 +184,7 @@ private:
     TimeProfilerStats& stats;
     Stopwatch<SnortClock> sw;
     bool stopped_once = false;
+    bool sampled = false;
 };
 
 class TimeExclude
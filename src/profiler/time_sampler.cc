@@ -0,0 +1,258 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// time_sampler.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "time_sampler.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <csignal>
+#include <ctime>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "log/messages.h"
+#include "main/snort_config.h"
+#include "utils/util.h"
+
+#include "profiler_nodes.h"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+using namespace snort;
+
+std::atomic<bool> time_sampling(false);
+THREAD_LOCAL TimeSampleStack* time_samples = nullptr;
+
+// -----------------------------------------------------------------------------
+// per thread samples
+// -----------------------------------------------------------------------------
+
+// everything touched by the signal handler is allocated up front
+struct SampleEntry
+{
+    uint64_t count;
+    unsigned depth;
+    TimeProfilerStats* frames[TimeSampleStack::max_depth];
+};
+
+struct ThreadSampler
+{
+    static constexpr unsigned max_entries = 1024;  // must be a power of 2
+
+    TimeSampleStack stack;
+    SampleEntry entries[max_entries];
+    uint64_t dropped;
+    hr_duration period;
+#ifdef __linux__
+    timer_t timer;
+#endif
+
+    void record(unsigned depth);
+};
+
+void ThreadSampler::record(unsigned depth)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for ( unsigned i = 0; i < depth; ++i )
+        hash = (hash ^ (uintptr_t)stack.scopes[i]) * 1099511628211ULL;
+
+    for ( unsigned n = 0; n < max_entries; ++n )
+    {
+        SampleEntry& e = entries[(hash + n) & (max_entries - 1)];
+
+        if ( !e.count )
+        {
+            memcpy(e.frames, stack.scopes, depth * sizeof(e.frames[0]));
+            e.depth = depth;
+            e.count = 1;
+            return;
+        }
+        if ( e.depth == depth && !memcmp(e.frames, stack.scopes, depth * sizeof(e.frames[0])) )
+        {
+            ++e.count;
+            return;
+        }
+    }
+    ++dropped;
+}
+
+static THREAD_LOCAL ThreadSampler* s_sampler = nullptr;
+
+// folded stacks from exited threads
+static std::mutex s_folded_mutex;
+static std::map<std::string, uint64_t> s_folded;
+static uint64_t s_dropped = 0;
+
+#ifdef __linux__
+static void sample_handler(int)
+{
+    ThreadSampler* ts = s_sampler;
+
+    if ( !ts )
+        return;
+
+    unsigned depth = ts->stack.depth;
+    std::atomic_signal_fence(std::memory_order_acquire);
+
+    if ( !depth )
+        return;
+
+    if ( depth > TimeSampleStack::max_depth )
+        depth = TimeSampleStack::max_depth;
+
+    for ( unsigned i = 0; i < depth; ++i )
+        ts->stack.scopes[i]->elapsed += ts->period;
+
+    ts->record(depth);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// api
+// -----------------------------------------------------------------------------
+
+void start_time_sampler(unsigned usecs)
+{
+#ifdef __linux__
+    static std::once_flag handler_once;
+
+    std::call_once(handler_once, []()
+    {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = sample_handler;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGPROF, &sa, nullptr);
+    });
+
+    ThreadSampler* ts = new ThreadSampler();
+    long t = clock_ticks(usecs);
+    ts->period = TO_DURATION(ts->period, t);
+
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = SIGPROF;
+    sev.sigev_notify_thread_id = syscall(SYS_gettid);
+
+    if ( timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &ts->timer) )
+    {
+        WarningMessage("profiler: can't create sample timer: %s; timing each scope instead\n",
+            get_error(errno));
+        delete ts;
+        return;
+    }
+
+    struct itimerspec its;
+    its.it_interval.tv_sec = usecs / 1000000;
+    its.it_interval.tv_nsec = (usecs % 1000000) * 1000;
+    its.it_value = its.it_interval;
+
+    s_sampler = ts;
+    time_samples = &ts->stack;
+    time_sampling.store(true, std::memory_order_relaxed);
+
+    timer_settime(ts->timer, 0, &its, nullptr);
+#else
+    UNUSED(usecs);
+#endif
+}
+
+void stop_time_sampler(ProfilerNodeMap& nodes)
+{
+    ThreadSampler* ts = s_sampler;
+
+    if ( !ts )
+        return;
+
+    s_sampler = nullptr;
+    time_samples = nullptr;
+
+#ifdef __linux__
+    timer_delete(ts->timer);
+#endif
+
+    // stats are thread local so names must be resolved on this thread
+    std::unordered_map<const TimeProfilerStats*, const std::string*> names;
+
+    for ( const auto& it : nodes )
+    {
+        if ( const ProfileStats* ps = it.second.get_local_stats() )
+            names[&ps->time] = &it.first;
+    }
+
+    std::lock_guard<std::mutex> lock(s_folded_mutex);
+
+    for ( const auto& e : ts->entries )
+    {
+        if ( !e.count )
+            continue;
+
+        // frames without a registered node (eg excluded time) are elided
+        std::string stack;
+
+        for ( unsigned i = 0; i < e.depth; ++i )
+        {
+            auto name = names.find(e.frames[i]);
+
+            if ( name == names.end() )
+                continue;
+
+            if ( !stack.empty() )
+                stack += ';';
+
+            stack += *name->second;
+        }
+        if ( !stack.empty() )
+            s_folded[stack] += e.count;
+    }
+    s_dropped += ts->dropped;
+    delete ts;
+}
+
+void write_folded_stacks(std::string& file)
+{
+    file = SnortConfig::get_conf()->log_dir.empty() ? "." : SnortConfig::get_conf()->log_dir;
+    file += '/';
+    file += SnortConfig::get_conf()->run_prefix;
+    file += "profile_folded.txt";
+
+    std::ofstream ofs(file);
+
+    for ( const auto& it : s_folded )
+        ofs << it.first << ' ' << it.second << '\n';
+
+    if ( s_dropped )
+        ofs << "(unrecorded) " << s_dropped << '\n';
+}
@@ -0,0 +1,39 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// time_sampler.h
+
+#ifndef TIME_SAMPLER_H
+#define TIME_SAMPLER_H
+
+// sampling mode for the module time profile.  a per thread cpu timer
+// charges each sample period to the scopes on that thread's stack and
+// counts the stack for folded (flamegraph) output.
+
+#include <string>
+
+class ProfilerNodeMap;
+
+// call from packet threads
+void start_time_sampler(unsigned usecs);
+void stop_time_sampler(ProfilerNodeMap&);
+
+// call from main thread after packet threads have stopped
+void write_folded_stacks(std::string& file);
+
+#endif
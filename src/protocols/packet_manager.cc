@@ -23,6 +23,7 @@
 
 #include "packet_manager.h"
 
+#include <cstring>
 #include <mutex>
 
 #include "codecs/codec_module.h"
@@ -38,6 +39,7 @@
 #include "eth.h"
 #include "icmp4.h"
 #include "icmp6.h"
+#include "vlan.h"
 
 using namespace snort;
 
@@ -61,7 +63,8 @@ const std::array<const char*, PacketManager::stat_offset> PacketManager::stat_na
     {
         "total",
         "other",
-        "discards"
+        "discards",
+        "fast_link"
     }
 };
 
@@ -69,9 +72,37 @@ const std::array<const char*, PacketManager::stat_offset> PacketManager::stat_na
 static THREAD_LOCAL PegCount total_rebuilt_pkts = 0;
 static THREAD_LOCAL std::array<uint8_t, Codec::PKT_MAX>* s_pkt;
 
+// link layer fast path
+static THREAD_LOCAL bool s_fast_eth = false;
+static THREAD_LOCAL bool s_fast_vlan = false;
+
+static const unsigned max_fast_vlans = 2;
+static const uint16_t max_vlan_encap_len = 1518;  // same as cd_vlan.cc
+
+static inline bool is_vlan(ProtocolId id)
+{
+    return id == ProtocolId::ETHERTYPE_8021Q or id == ProtocolId::ETHERTYPE_8021AD or
+        id == ProtocolId::ETHERTYPE_QINQ_NS1 or id == ProtocolId::ETHERTYPE_QINQ_NS2;
+}
+
 void PacketManager::thread_init()
 {
     s_pkt = new std::array<uint8_t, Codec::PKT_MAX>{ {0} };
+
+    // the fast path only stands in for the builtin eth and vlan codecs
+    s_fast_eth = SnortConfig::get_conf()->fast_decode and
+        !strcmp(CodecManager::s_protocols[CodecManager::grinder]->get_name(), "eth");
+
+    s_fast_vlan = s_fast_eth;
+
+    for ( auto id : { ProtocolId::ETHERTYPE_8021Q, ProtocolId::ETHERTYPE_8021AD,
+        ProtocolId::ETHERTYPE_QINQ_NS1, ProtocolId::ETHERTYPE_QINQ_NS2 } )
+    {
+        ProtocolIndex idx = CodecManager::s_proto_map[to_utype(id)];
+
+        if ( !idx or strcmp(CodecManager::s_protocols[idx]->get_name(), "vlan") )
+            s_fast_vlan = false;
+    }
 }
 
 void PacketManager::thread_term()
@@ -112,6 +143,77 @@ void PacketManager::pop_teredo(Packet* p, RawData& raw)
     raw.len += lyr_len;
 }
 
+// decode ethernet and up to max_fast_vlans vlan tags without going through
+// the codecs.  each step does exactly what an iteration of the decode loop
+// does for the eth and vlan codecs and anything else (short headers, llc,
+// fabricpath, reserved vlan ids, etc.) stops here so the loop picks up from
+// the same state.
+
+void PacketManager::decode_link(
+    Packet* p, RawData& raw, ProtocolIndex& mapped_prot, ProtocolId& prev_prot_id)
+{
+    unsigned vlans = 0;
+
+    while ( true )
+    {
+        ProtocolId next_prot_id;
+        uint32_t proto_bits;
+        uint16_t lyr_len;
+
+        if ( !p->num_layers and mapped_prot == CodecManager::grinder )
+        {
+            if ( raw.len < eth::ETH_HEADER_LEN )
+                return;
+
+            const eth::EtherHdr* eh = reinterpret_cast<const eth::EtherHdr*>(raw.data);
+            next_prot_id = eh->ethertype();
+
+            if ( to_utype(next_prot_id) <= to_utype(ProtocolId::ETHERTYPE_MINIMUM) or
+                next_prot_id == ProtocolId::ETHERTYPE_FPATH )
+                return;
+
+            lyr_len = eth::ETH_HEADER_LEN;
+            proto_bits = PROTO_BIT__ETH;
+        }
+        else if ( s_fast_vlan and is_vlan(prev_prot_id) and vlans++ < max_fast_vlans )
+        {
+            if ( raw.len < sizeof(vlan::VlanTagHdr) )
+                return;
+
+            const vlan::VlanTagHdr* vh = reinterpret_cast<const vlan::VlanTagHdr*>(raw.data);
+            const uint16_t proto = vh->proto();
+            const uint16_t vid = vh->vid();
+
+            if ( proto <= max_vlan_encap_len or vid == 0 or vid == 4095 )
+                return;
+
+            next_prot_id = (ProtocolId)proto;
+            lyr_len = sizeof(vlan::VlanTagHdr);
+            proto_bits = PROTO_BIT__VLAN;
+        }
+        else
+            return;
+
+        trace_logf(decode, "Codec %s (protocol_id: %hu) "
+            "ip header starts at: %p, length is %d\n",
+            CodecManager::s_protocols[mapped_prot]->get_name(),
+            static_cast<uint16_t>(next_prot_id), p->pkt, lyr_len);
+
+        if ( p->num_layers == CodecManager::max_layers )
+            DetectionEngine::queue_event(GID_DECODE, DECODE_TOO_MANY_LAYERS);
+        else
+            push_layer(p, prev_prot_id, raw.data, lyr_len);
+
+        s_stats[mapped_prot + stat_offset]++;
+        mapped_prot = CodecManager::s_proto_map[to_utype(next_prot_id)];
+        prev_prot_id = next_prot_id;
+
+        raw.len -= lyr_len;
+        raw.data += lyr_len;
+        p->proto_bits |= proto_bits;
+    }
+}
+
 //-------------------------------------------------------------------------
 // Initialization and setup
 //-------------------------------------------------------------------------
@@ -157,6 +259,14 @@ void PacketManager::decode(
 
     s_stats[total_processed]++;
 
+    if ( s_fast_eth )
+    {
+        decode_link(p, raw, mapped_prot, prev_prot_id);
+
+        if ( p->num_layers )
+            s_stats[fast_link]++;
+    }
+
     // loop until the protocol id is no longer valid
     while (CodecManager::s_protocols[mapped_prot]->decode(raw, codec_data, p->ptrs))
     {
@@ -856,7 +966,7 @@ void PacketManager::dump_stats()
     std::vector<const char*> pkt_names;
 
     // zero out the default codecs
-    g_stats[3] = 0;
+    g_stats[stat_offset] = 0;
     g_stats[CodecManager::s_proto_map[to_utype(ProtocolId::FINISHED_DECODE)] + stat_offset] = 0;
 
     for (unsigned int i = 0; i < stat_names.size(); i++)
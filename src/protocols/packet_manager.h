@@ -136,6 +136,7 @@ private:
     friend void CodecManager::thread_term();
     static void accumulate();
     static void pop_teredo(Packet*, RawData&);
+    static void decode_link(Packet*, RawData&, ProtocolIndex&, ProtocolId&);
 
     static bool encode(const Packet*, EncodeFlags,
         uint8_t lyr_start, IpProtocol next_prot, Buffer& buf);
@@ -145,7 +146,8 @@ private:
     static const uint8_t total_processed = 0;
     static const uint8_t other_codecs = 1;
     static const uint8_t discards = 2;
-    static const uint8_t stat_offset = 3;
+    static const uint8_t fast_link = 3;
+    static const uint8_t stat_offset = 4;
 
     // declared in header so it can access s_protocols
     static THREAD_LOCAL std::array<PegCount, stat_offset +
@@ -77,6 +77,17 @@ public:
         return bnfaCompile(sc, obj);
     }
 
+    int compile(SnortConfig*) override
+    {
+        return bnfaCompileStates(obj);
+    }
+
+    int build_trees(SnortConfig* sc) override
+    {
+        bnfaBuildTrees(sc, obj);
+        return 0;
+    }
+
     int _search(
         const uint8_t* T, int n, MpseMatch match,
         void* context, int* current_state) override
@@ -98,6 +109,11 @@ public:
     {
         return bnfaPatternCount(obj);
     }
+
+    size_t get_memory_used() override
+    {
+        return bnfaMemoryUsed(obj);
+    }
 };
 
 //-------------------------------------------------------------------------
@@ -140,7 +156,7 @@ static const MpseApi bnfa_api =
         nullptr,
         nullptr
     },
-    MPSE_BASE,
+    MPSE_MTBLD,
     nullptr,
     nullptr,
     nullptr,
@@ -59,6 +59,12 @@ public:
     int prep_patterns(SnortConfig* sc) override
     { return acsmCompile2(sc, obj); }
 
+    int compile(SnortConfig*) override
+    { return acsmCompileStates2(obj); }
+
+    int build_trees(SnortConfig* sc) override
+    { acsmBuildTrees2(sc, obj); return 0; }
+
     int _search(
         const uint8_t* T, int n, MpseMatch match,
         void* context, int* current_state) override
@@ -74,6 +80,9 @@ public:
 
     int get_pattern_count() override
     { return acsmPatternCount2(obj); }
+
+    size_t get_memory_used() override
+    { return obj->memory; }
 };
 
 //-------------------------------------------------------------------------
@@ -116,7 +125,7 @@ static const MpseApi acsb_api =
         nullptr,
         nullptr
     },
-    MPSE_BASE,
+    MPSE_MTBLD,
     nullptr,
     nullptr,
     nullptr,
@@ -117,6 +117,7 @@
 
 #include "acsmx2.h"
 
+#include <atomic>
 #include <cassert>
 #include <list>
 
@@ -128,15 +129,16 @@
 
 #define MEMASSERT(p,s) if (!(p)) { FatalError("ACSM-No Memory: %s\n",s); }
 
-static int acsm2_total_memory = 0;
-static int acsm2_pattern_memory = 0;
-static int acsm2_matchlist_memory = 0;
-static int acsm2_transtable_memory = 0;
-static int acsm2_dfa_memory = 0;
-static int acsm2_dfa1_memory = 0;
-static int acsm2_dfa2_memory = 0;
-static int acsm2_dfa4_memory = 0;
-static int acsm2_failstate_memory = 0;
+// atomic since state machines may be compiled in parallel
+static std::atomic<int> acsm2_total_memory { 0 };
+static std::atomic<int> acsm2_pattern_memory { 0 };
+static std::atomic<int> acsm2_matchlist_memory { 0 };
+static std::atomic<int> acsm2_transtable_memory { 0 };
+static std::atomic<int> acsm2_dfa_memory { 0 };
+static std::atomic<int> acsm2_dfa1_memory { 0 };
+static std::atomic<int> acsm2_dfa2_memory { 0 };
+static std::atomic<int> acsm2_dfa4_memory { 0 };
+static std::atomic<int> acsm2_failstate_memory { 0 };
 
 struct acsm_summary_t
 {
@@ -239,10 +241,13 @@ enum Acsm2MemoryType
 /*
 *
 */
-static void* AC_MALLOC(int n, Acsm2MemoryType type)
+static void* AC_MALLOC(ACSM_STRUCT2* acsm, int n, Acsm2MemoryType type)
 {
     void* p = snort_calloc(n);
 
+    if ( acsm )
+        acsm->memory += n;
+
     switch (type)
     {
     case ACSM2_MEMORY_TYPE__PATTERN:
@@ -267,10 +272,13 @@ static void* AC_MALLOC(int n, Acsm2MemoryType type)
     return p;
 }
 
-static void* AC_MALLOC_DFA(int n, int sizeofstate)
+static void* AC_MALLOC_DFA(ACSM_STRUCT2* acsm, int n, int sizeofstate)
 {
     void* p = snort_calloc(n);
 
+    if ( acsm )
+        acsm->memory += n;
+
     switch (sizeofstate)
     {
     case 1:
@@ -291,10 +299,13 @@ static void* AC_MALLOC_DFA(int n, int sizeofstate)
     return p;
 }
 
-static void AC_FREE(void* p, int n, Acsm2MemoryType type)
+static void AC_FREE(ACSM_STRUCT2* acsm, void* p, int n, Acsm2MemoryType type)
 {
     if (p != nullptr)
     {
+        if ( acsm )
+            acsm->memory -= n;
+
         switch (type)
         {
         case ACSM2_MEMORY_TYPE__PATTERN:
@@ -319,10 +330,13 @@ static void AC_FREE(void* p, int n, Acsm2MemoryType type)
     }
 }
 
-static void AC_FREE_DFA(void* p, int n, int sizeofstate)
+static void AC_FREE_DFA(ACSM_STRUCT2* acsm, void* p, int n, int sizeofstate)
 {
     if (p != nullptr)
     {
+        if ( acsm )
+            acsm->memory -= n;
+
         switch (sizeofstate)
         {
         case 1:
@@ -421,7 +435,7 @@ static int List_PutNextStateOpt( ACSM_STRUCT2 * acsm, trans_node_t **acsmTransTa
     }
 
     /* Definitely not an existing transition - add it */
-    trans_node_t * tnew = (trans_node_t*)AC_MALLOC(sizeof(trans_node_t),
+    trans_node_t * tnew = (trans_node_t*)AC_MALLOC(acsm, sizeof(trans_node_t),
             ACSM2_MEMORY_TYPE__TRANSTABLE);
 
     if( !tnew )
@@ -460,7 +474,7 @@ static int List_PutNextState(ACSM_STRUCT2* acsm, int state, int input, int next_
     }
 
     /* Definitely not an existing transition - add it */
-    tnew = (trans_node_t*)AC_MALLOC(sizeof(trans_node_t), ACSM2_MEMORY_TYPE__TRANSTABLE);
+    tnew = (trans_node_t*)AC_MALLOC(acsm, sizeof(trans_node_t), ACSM2_MEMORY_TYPE__TRANSTABLE);
     if ( !tnew )
         return -1;
 
@@ -493,12 +507,12 @@ static int List_FreeTransTable(ACSM_STRUCT2* acsm)
         while (t != nullptr)
         {
             p = t->next;
-            AC_FREE(t, sizeof(trans_node_t), ACSM2_MEMORY_TYPE__TRANSTABLE);
+            AC_FREE(acsm, t, sizeof(trans_node_t), ACSM2_MEMORY_TYPE__TRANSTABLE);
             t = p;
         }
     }
 
-    AC_FREE(acsm->acsmTransTable, sizeof(void*) * acsm->acsmMaxStates,
+    AC_FREE(acsm, acsm->acsmTransTable, sizeof(void*) * acsm->acsmMaxStates,
         ACSM2_MEMORY_TYPE__TRANSTABLE);
 
     acsm->acsmTransTable = nullptr;
@@ -543,11 +557,11 @@ static inline int List_ConvToFull(ACSM_STRUCT2* acsm, acstate_t state, acstate_t
 /*
 *   Copy a Match List Entry - don't dup the pattern data
 */
-static ACSM_PATTERN2* CopyMatchListEntry(ACSM_PATTERN2* px)
+static ACSM_PATTERN2* CopyMatchListEntry(ACSM_STRUCT2* acsm, ACSM_PATTERN2* px)
 {
     ACSM_PATTERN2* p;
 
-    p = (ACSM_PATTERN2*)AC_MALLOC(sizeof (ACSM_PATTERN2), ACSM2_MEMORY_TYPE__MATCHLIST);
+    p = (ACSM_PATTERN2*)AC_MALLOC(acsm, sizeof (ACSM_PATTERN2), ACSM2_MEMORY_TYPE__MATCHLIST);
     MEMASSERT(p, "CopyMatchListEntry");
 
     memcpy(p, px, sizeof (ACSM_PATTERN2));
@@ -584,7 +598,7 @@ static void AddMatchListEntry(ACSM_STRUCT2* acsm, int state, ACSM_PATTERN2* px)
 {
     ACSM_PATTERN2* p;
 
-    p = (ACSM_PATTERN2*)AC_MALLOC(sizeof (ACSM_PATTERN2), ACSM2_MEMORY_TYPE__MATCHLIST);
+    p = (ACSM_PATTERN2*)AC_MALLOC(acsm, sizeof (ACSM_PATTERN2), ACSM2_MEMORY_TYPE__MATCHLIST);
     MEMASSERT(p, "AddMatchListEntry");
 
     memcpy(p, px, sizeof (ACSM_PATTERN2));
@@ -697,7 +711,7 @@ static void Build_NFA(ACSM_STRUCT2* acsm)
                     mlist;
                     mlist = mlist->next)
                 {
-                    px = CopyMatchListEntry (mlist);
+                    px = CopyMatchListEntry(acsm, mlist);
 
                     /* Insert at front of MatchList */
                     px->next = MatchList[s];
@@ -794,7 +808,7 @@ static int Conv_List_To_Full(ACSM_STRUCT2* acsm)
 
     for (k = 0; k < (acstate_t)acsm->acsmNumStates; k++)
     {
-        p = (acstate_t*)AC_MALLOC_DFA(acsm->sizeofstate * (acsm->acsmAlphabetSize + 2),
+        p = (acstate_t*)AC_MALLOC_DFA(acsm, acsm->sizeofstate * (acsm->acsmAlphabetSize + 2),
             acsm->sizeofstate);
         if (p == nullptr)
             return -1;
@@ -874,7 +888,7 @@ static int Conv_Full_DFA_To_Sparse(ACSM_STRUCT2* acsm)
 
         if ( k== 0 || cnt > acsm->acsmSparseMaxRowNodes )
         {
-            p = (acstate_t*)AC_MALLOC_DFA(sizeof(acstate_t)*(acsm->acsmAlphabetSize+2),
+            p = (acstate_t*)AC_MALLOC_DFA(acsm, sizeof(acstate_t)*(acsm->acsmAlphabetSize+2),
                 sizeof(acstate_t));
             if (!p)
                 return -1;
@@ -885,7 +899,7 @@ static int Conv_Full_DFA_To_Sparse(ACSM_STRUCT2* acsm)
         }
         else
         {
-            p = (acstate_t*)AC_MALLOC_DFA(sizeof(acstate_t)*(3+2*cnt),
+            p = (acstate_t*)AC_MALLOC_DFA(acsm, sizeof(acstate_t)*(3+2*cnt),
                 sizeof(acstate_t));
             if (!p)
                 return -1;
@@ -950,7 +964,7 @@ static int Conv_Full_DFA_To_Banded(ACSM_STRUCT2* acsm)
         /* calc band width */
         int cnt= last - first + 1;
 
-        p = (acstate_t*)AC_MALLOC_DFA(sizeof(acstate_t)*(4+cnt), sizeof(acstate_t));
+        p = (acstate_t*)AC_MALLOC_DFA(acsm, sizeof(acstate_t)*(4+cnt), sizeof(acstate_t));
 
         if (!p)
             return -1;
@@ -1063,7 +1077,7 @@ static int Conv_Full_DFA_To_SparseBands(ACSM_STRUCT2* acsm)
               cnt=%d\n",k,i,band_begin[i],band_end[i],band_end[i]-band_begin[i]+1); */
         }
 
-        acstate_t* p = (acstate_t*)AC_MALLOC_DFA(sizeof(acstate_t)*(cnt), sizeof(acstate_t));
+        acstate_t* p = (acstate_t*)AC_MALLOC_DFA(acsm, sizeof(acstate_t)*(cnt), sizeof(acstate_t));
 
         if (!p)
             return -1;
@@ -1082,7 +1096,7 @@ static int Conv_Full_DFA_To_SparseBands(ACSM_STRUCT2* acsm)
             {
                 if (j >= MAX_ALPHABET_SIZE)
                 {
-                    AC_FREE_DFA(p, sizeof(acstate_t)*(cnt), sizeof(acstate_t));
+                    AC_FREE_DFA(acsm, p, sizeof(acstate_t)*(cnt), sizeof(acstate_t));
                     return -1;
                 }
 
@@ -1101,7 +1115,7 @@ static int Conv_Full_DFA_To_SparseBands(ACSM_STRUCT2* acsm)
 */
 ACSM_STRUCT2* acsmNew2(const MpseAgent* agent, int format)
 {
-    ACSM_STRUCT2* p = (ACSM_STRUCT2*)AC_MALLOC(sizeof (ACSM_STRUCT2), ACSM2_MEMORY_TYPE__NONE);
+    ACSM_STRUCT2* p = (ACSM_STRUCT2*)AC_MALLOC(nullptr, sizeof (ACSM_STRUCT2), ACSM2_MEMORY_TYPE__NONE);
     MEMASSERT(p, "acsmNew");
 
     if (p)
@@ -1114,6 +1128,7 @@ ACSM_STRUCT2* acsmNew2(const MpseAgent* agent, int format)
         p->acsmSparseMaxRowNodes = 256;
         p->acsmSparseMaxZcnt = 10;
         p->dfa = false;
+        p->memory = sizeof(ACSM_STRUCT2);
     }
 
     return p;
@@ -1130,17 +1145,17 @@ int acsmAddPattern2(
     ACSM_PATTERN2* plist;
 
     plist = (ACSM_PATTERN2*)
-        AC_MALLOC(sizeof (ACSM_PATTERN2), ACSM2_MEMORY_TYPE__PATTERN);
+        AC_MALLOC(p, sizeof (ACSM_PATTERN2), ACSM2_MEMORY_TYPE__PATTERN);
     MEMASSERT(plist, "acsmAddPattern");
 
     plist->patrn =
-        (uint8_t*)AC_MALLOC(n, ACSM2_MEMORY_TYPE__PATTERN);
+        (uint8_t*)AC_MALLOC(p, n, ACSM2_MEMORY_TYPE__PATTERN);
     MEMASSERT(plist->patrn, "acsmAddPattern");
 
     ConvertCaseEx(plist->patrn, pat, n);
 
     plist->casepatrn =
-        (uint8_t*)AC_MALLOC(n, ACSM2_MEMORY_TYPE__PATTERN);
+        (uint8_t*)AC_MALLOC(p, n, ACSM2_MEMORY_TYPE__PATTERN);
     MEMASSERT(plist->casepatrn, "acsmAddPattern");
 
     memcpy(plist->casepatrn, pat, n);
@@ -1184,8 +1199,6 @@ static void acsmUpdateMatchStates(ACSM_STRUCT2* acsm)
                 p[1] = 1;
                 break;
             }
-
-            summary.num_match_states++;
         }
     }
 }
@@ -1246,13 +1259,13 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
 
     /* Alloc a List based State Transition table */
     acsm->acsmTransTable =
-        (trans_node_t**)AC_MALLOC(sizeof(trans_node_t*) * acsm->acsmMaxStates,
+        (trans_node_t**)AC_MALLOC(acsm, sizeof(trans_node_t*) * acsm->acsmMaxStates,
             ACSM2_MEMORY_TYPE__TRANSTABLE);
     MEMASSERT(acsm->acsmTransTable, "_acsmCompile2");
 
     /* Alloc a MatchList table - this has a list of pattern matches for each state, if any */
     acsm->acsmMatchList =
-        (ACSM_PATTERN2**)AC_MALLOC(sizeof(ACSM_PATTERN2*) * acsm->acsmMaxStates,
+        (ACSM_PATTERN2**)AC_MALLOC(acsm, sizeof(ACSM_PATTERN2*) * acsm->acsmMaxStates,
             ACSM2_MEMORY_TYPE__MATCHLIST);
     MEMASSERT(acsm->acsmMatchList, "_acsmCompile2");
 
@@ -1261,11 +1274,7 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
 
     /* Add each Pattern to the State Table - This forms a keywords state table  */
     for (plist = acsm->acsmPatterns; plist != nullptr; plist = plist->next)
-    {
-        summary.num_patterns++;
-        summary.num_characters += plist->n;
         AddPatternStates(acsm, plist);
-    }
 
     /* Add the 0'th state */
     acsm->acsmNumStates++;
@@ -1273,20 +1282,13 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
     if (acsm->compress_states)
     {
         if (acsm->acsmNumStates < UINT8_MAX)
-        {
             acsm->sizeofstate = 1;
-            summary.num_1byte_instances++;
-        }
+
         else if (acsm->acsmNumStates < UINT16_MAX)
-        {
             acsm->sizeofstate = 2;
-            summary.num_2byte_instances++;
-        }
+
         else
-        {
             acsm->sizeofstate = 4;
-            summary.num_4byte_instances++;
-        }
     }
     else
     {
@@ -1295,7 +1297,7 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
 
     /* Alloc a failure table - this has a failure state, and a match list for each state */
     acsm->acsmFailState =
-        (acstate_t*)AC_MALLOC(sizeof(acstate_t) * acsm->acsmNumStates,
+        (acstate_t*)AC_MALLOC(acsm, sizeof(acstate_t) * acsm->acsmNumStates,
             ACSM2_MEMORY_TYPE__FAILSTATE);
 
     MEMASSERT(acsm->acsmFailState, "_acsmCompile2");
@@ -1303,7 +1305,7 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
     /* Alloc a separate state transition table == in state 's' due to event 'k', transition to
       'next' state */
     acsm->acsmNextState =
-        (acstate_t**)AC_MALLOC_DFA(acsm->acsmNumStates * sizeof(acstate_t*), acsm->sizeofstate);
+        (acstate_t**)AC_MALLOC_DFA(acsm, acsm->acsmNumStates * sizeof(acstate_t*), acsm->sizeofstate);
 
     MEMASSERT(acsm->acsmNextState, "_acsmCompile2-NextState");
 
@@ -1316,7 +1318,7 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
         Convert_NFA_To_DFA(acsm);
 
         /* Don't need the FailState table anymore */
-        AC_FREE(acsm->acsmFailState, sizeof(acstate_t) * acsm->acsmNumStates,
+        AC_FREE(acsm, acsm->acsmFailState, sizeof(acstate_t) * acsm->acsmNumStates,
             ACSM2_MEMORY_TYPE__FAILSTATE);
 
         acsm->acsmFailState = nullptr;
@@ -1353,24 +1355,62 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
     /* Free up the Table Of Transition Lists */
     List_FreeTransTable(acsm);
 
-    /* Accrue Summary State Stats */
+    return 0;
+}
+
+/* Accrue Summary State Stats */
+static void acsmAccumSummary2(ACSM_STRUCT2* acsm)
+{
+    for ( ACSM_PATTERN2* plist = acsm->acsmPatterns; plist != nullptr; plist = plist->next )
+    {
+        summary.num_patterns++;
+        summary.num_characters += plist->n;
+    }
+
+    if ( acsm->compress_states )
+    {
+        if ( acsm->sizeofstate == 1 )
+            summary.num_1byte_instances++;
+
+        else if ( acsm->sizeofstate == 2 )
+            summary.num_2byte_instances++;
+
+        else
+            summary.num_4byte_instances++;
+    }
+
+    for ( int i = 0; i < acsm->acsmNumStates; i++ )
+    {
+        if ( acsm->acsmMatchList[i] )
+            summary.num_match_states++;
+    }
+
     summary.num_states += acsm->acsmNumStates;
     summary.num_transitions += acsm->acsmNumTrans;
     summary.num_instances++;
 
     memcpy(&summary.acsm, acsm, sizeof(ACSM_STRUCT2));
+}
 
-    return 0;
+int acsmCompileStates2(ACSM_STRUCT2* acsm)
+{
+    return _acsmCompile2(acsm);
 }
 
-int acsmCompile2(snort::SnortConfig* sc, ACSM_STRUCT2* acsm)
+void acsmBuildTrees2(snort::SnortConfig* sc, ACSM_STRUCT2* acsm)
 {
-    if ( int rval = _acsmCompile2(acsm) )
-        return rval;
+    acsmAccumSummary2(acsm);
 
     if ( acsm->agent )
         acsmBuildMatchStateTrees2(sc, acsm);
+}
+
+int acsmCompile2(snort::SnortConfig* sc, ACSM_STRUCT2* acsm)
+{
+    if ( int rval = acsmCompileStates2(acsm) )
+        return rval;
 
+    acsmBuildTrees2(sc, acsm);
     return 0;
 }
 
@@ -1979,10 +2019,10 @@ void acsmFree2(ACSM_STRUCT2* acsm)
             if (ilist->neg_list && acsm->agent)
                 acsm->agent->list_free(&(ilist->neg_list));
 
-            AC_FREE(ilist, 0, ACSM2_MEMORY_TYPE__NONE);
+            AC_FREE(nullptr, ilist, 0, ACSM2_MEMORY_TYPE__NONE);
         }
 
-        AC_FREE_DFA(acsm->acsmNextState[i], 0, 0);
+        AC_FREE_DFA(nullptr, acsm->acsmNextState[i], 0, 0);
     }
 
     for (plist = acsm->acsmPatterns; plist; )
@@ -1992,17 +2032,17 @@ void acsmFree2(ACSM_STRUCT2* acsm)
         if (acsm->agent && (plist->udata != nullptr))
             acsm->agent->user_free(plist->udata);
 
-        AC_FREE(plist->patrn, 0, ACSM2_MEMORY_TYPE__NONE);
-        AC_FREE(plist->casepatrn, 0, ACSM2_MEMORY_TYPE__NONE);
-        AC_FREE(plist, 0, ACSM2_MEMORY_TYPE__NONE);
+        AC_FREE(nullptr, plist->patrn, 0, ACSM2_MEMORY_TYPE__NONE);
+        AC_FREE(nullptr, plist->casepatrn, 0, ACSM2_MEMORY_TYPE__NONE);
+        AC_FREE(nullptr, plist, 0, ACSM2_MEMORY_TYPE__NONE);
 
         plist = tmpPlist;
     }
 
-    AC_FREE_DFA(acsm->acsmNextState, 0, 0);
-    AC_FREE(acsm->acsmFailState, 0, ACSM2_MEMORY_TYPE__NONE);
-    AC_FREE(acsm->acsmMatchList, 0, ACSM2_MEMORY_TYPE__NONE);
-    AC_FREE(acsm, 0, ACSM2_MEMORY_TYPE__NONE);
+    AC_FREE_DFA(nullptr, acsm->acsmNextState, 0, 0);
+    AC_FREE(nullptr, acsm->acsmFailState, 0, ACSM2_MEMORY_TYPE__NONE);
+    AC_FREE(nullptr, acsm->acsmMatchList, 0, ACSM2_MEMORY_TYPE__NONE);
+    AC_FREE(nullptr, acsm, 0, ACSM2_MEMORY_TYPE__NONE);
 }
 
 int acsmPatternCount2(ACSM_STRUCT2* acsm)
@@ -126,6 +126,8 @@ struct ACSM_STRUCT2
     int sizeofstate;
     int compress_states;
 
+    int memory;  // bytes currently allocated for this instance
+
     bool dfa;
 
     void enable_dfa()
@@ -148,6 +150,11 @@ int acsmAddPattern2(
 
 int acsmCompile2(snort::SnortConfig*, ACSM_STRUCT2*);
 
+// acsmCompile2() in two steps; the states may be compiled on any thread
+// but the trees and summary must be built serially on the main thread
+int acsmCompileStates2(ACSM_STRUCT2*);
+void acsmBuildTrees2(snort::SnortConfig*, ACSM_STRUCT2*);
+
 int acsm_search_nfa(
     ACSM_STRUCT2*, const uint8_t* T, int n, MpseMatch, void* context, int* current_state);
 
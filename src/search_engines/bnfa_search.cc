@@ -1446,19 +1446,28 @@ static inline int _bnfaCompile(bnfa_struct_t* bnfa)
 
     bnfa->bnfaMatchStates = cntMatchStates;
 
-    bnfaAccumInfo(bnfa);
-
     return 0;
 }
 
-int bnfaCompile(snort::SnortConfig* sc, bnfa_struct_t* bnfa)
+int bnfaCompileStates(bnfa_struct_t* bnfa)
 {
-    if ( int rval = _bnfaCompile (bnfa) )
-        return rval;
+    return _bnfaCompile(bnfa);
+}
+
+void bnfaBuildTrees(snort::SnortConfig* sc, bnfa_struct_t* bnfa)
+{
+    bnfaAccumInfo(bnfa);
 
     if ( bnfa->agent )
         bnfaBuildMatchStateTrees(sc, bnfa);
+}
 
+int bnfaCompile(snort::SnortConfig* sc, bnfa_struct_t* bnfa)
+{
+    if ( int rval = bnfaCompileStates(bnfa) )
+        return rval;
+
+    bnfaBuildTrees(sc, bnfa);
     return 0;
 }
 
@@ -2005,6 +2014,12 @@ int bnfaPatternCount(bnfa_struct_t* p)
     return p->bnfaPatternCnt;
 }
 
+unsigned bnfaMemoryUsed(bnfa_struct_t* p)
+{
+    return p->bnfa_memory + p->pat_memory + p->list_memory +
+        p->matchlist_memory + p->failstate_memory + p->nextstate_memory;
+}
+
 /*
  *  Summary Info Data
  */
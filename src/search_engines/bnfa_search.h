@@ -170,11 +170,17 @@ int bnfaAddPattern(
 
 int bnfaCompile(snort::SnortConfig*, bnfa_struct_t*);
 
+// bnfaCompile() in two steps; the states may be compiled on any thread
+// but the trees and summary must be built serially on the main thread
+int bnfaCompileStates(bnfa_struct_t*);
+void bnfaBuildTrees(snort::SnortConfig*, bnfa_struct_t*);
+
 unsigned _bnfa_search_csparse_nfa(
     bnfa_struct_t * pstruct, const uint8_t* t, int tlen, MpseMatch,
     void* context, unsigned sindex, int* current_state);
 
 int bnfaPatternCount(bnfa_struct_t* p);
+unsigned bnfaMemoryUsed(bnfa_struct_t* p);
 
 void bnfaPrint(bnfa_struct_t* pstruct);   /* prints the nfa states-verbose!! */
 void bnfaPrintInfo(bnfa_struct_t* pstruct);    /* print info on this search engine */
@@ -135,12 +135,16 @@ public:
     }
 
     int prep_patterns(SnortConfig*) override;
+    int compile(SnortConfig*) override;
+    int build_trees(SnortConfig*) override;
 
     int _search(const uint8_t*, int, MpseMatch, void*, int*) override;
 
     int get_pattern_count() override
     { return pvector.size(); }
 
+    size_t get_memory_used() override;
+
     int match(unsigned id, unsigned long long to);
 
     static int match(
@@ -209,6 +213,14 @@ void HyperscanMpse::user_dtor()
 }
 
 int HyperscanMpse::prep_patterns(SnortConfig* sc)
+{
+    if ( int rval = compile(sc) )
+        return rval;
+
+    return build_trees(sc);
+}
+
+int HyperscanMpse::compile(SnortConfig*)
 {
     if ( pvector.empty() )
         return -1;
@@ -243,6 +255,12 @@ int HyperscanMpse::prep_patterns(SnortConfig* sc)
         return -2;
     }
 
+    return 0;
+}
+
+// scratch is shared by all instances so it is grown here, serially
+int HyperscanMpse::build_trees(SnortConfig* sc)
+{
     if ( hs_error_t err = hs_alloc_scratch(hs_db, &s_scratch) )
     {
         ParseError("can't allocate search scratch space (%d)", err);
@@ -255,6 +273,16 @@ int HyperscanMpse::prep_patterns(SnortConfig* sc)
     return 0;
 }
 
+size_t HyperscanMpse::get_memory_used()
+{
+    size_t size = 0;
+
+    if ( hs_db and hs_database_size(hs_db, &size) != HS_SUCCESS )
+        size = 0;
+
+    return size;
+}
+
 int HyperscanMpse::match(unsigned id, unsigned long long to)
 {
     assert(id < pvector.size());
@@ -368,7 +396,7 @@ static const MpseApi hs_api =
         nullptr,
         nullptr
     },
-    MPSE_REGEX,
+    MPSE_REGEX | MPSE_MTBLD,
     nullptr,  // activate
     nullptr,  // setup
     nullptr,  // start
@@ -145,7 +145,7 @@ TEST(mpse_hs_base, base)
 TEST(mpse_hs_base, mpse)
 {
     const MpseApi* mpse_api = (MpseApi*)se_hyperscan;
-    CHECK(mpse_api->flags == MPSE_REGEX);
+    CHECK(mpse_api->flags == (MPSE_REGEX | MPSE_MTBLD));
 
     CHECK(mpse_api->ctor);
     CHECK(mpse_api->dtor);
@@ -214,6 +214,22 @@ TEST(mpse_hs_match, single)
     CHECK(hits == 1);
 }
 
+TEST(mpse_hs_match, split)
+{
+    Mpse::PatternDescriptor desc;
+
+    CHECK(hs->add_pattern(nullptr, (uint8_t*)"foo", 3, desc, s_user) == 0);
+    CHECK(hs->compile(snort_conf) == 0);
+    CHECK(hs->build_trees(snort_conf) == 0);
+    CHECK(hs->get_pattern_count() == 1);
+
+    hyperscan_setup(snort_conf);
+
+    int state = 0;
+    CHECK(hs->search((uint8_t*)"foo", 3, match, nullptr, &state) == 1);
+    CHECK(hits == 1);
+}
+
 TEST(mpse_hs_match, nocase)
 {
     Mpse::PatternDescriptor desc(true, true, false);
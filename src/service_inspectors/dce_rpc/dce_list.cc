@@ -31,7 +31,7 @@
 
 #include "dce_list.h"
 
-#include "utils/util.h"
+#include "dce_pool.h"
 
 /********************************************************************
  * Private function prototyes
@@ -79,7 +79,7 @@ DCE2_List* DCE2_ListNew(DCE2_ListType type, DCE2_ListKeyCompare kc,
     if (kc == nullptr)
         return nullptr;
 
-    list = (DCE2_List*)snort_calloc(sizeof(DCE2_List));
+    list = (DCE2_List*)DCE2_PoolAlloc(DCE2_POOL__LIST);
 
     list->type = type;
     list->compare = kc;
@@ -254,7 +254,7 @@ DCE2_Ret DCE2_ListInsert(DCE2_List* list, void* key, void* data)
         dup_check = 1;
     }
 
-    n = (DCE2_ListNode*)snort_calloc(sizeof(DCE2_ListNode));
+    n = (DCE2_ListNode*)DCE2_PoolAlloc(DCE2_POOL__LIST_NODE);
 
     n->key = key;
     n->data = data;
@@ -400,7 +400,7 @@ void DCE2_ListEmpty(DCE2_List* list)
         if (list->key_free != nullptr)
             list->key_free(n->key);
 
-        snort_free((void*)n);
+        DCE2_PoolFree(DCE2_POOL__LIST_NODE, n);
         n = tmp;
     }
 
@@ -426,7 +426,7 @@ void DCE2_ListDestroy(DCE2_List* list)
         return;
 
     DCE2_ListEmpty(list);
-    snort_free(list);
+    DCE2_PoolFree(DCE2_POOL__LIST, list);
 }
 
 /********************************************************************
@@ -624,7 +624,7 @@ DCE2_Ret DCE2_ListRemove(DCE2_List* list, void* key)
     if (list->data_free != nullptr)
         list->data_free(n->data);
 
-    snort_free((void*)n);
+    DCE2_PoolFree(DCE2_POOL__LIST_NODE, n);
 
     list->num_nodes--;
 
@@ -674,7 +674,7 @@ void DCE2_ListRemoveCurrent(DCE2_List* list)
     if (list->data_free != nullptr)
         list->data_free(list->current->data);
 
-    snort_free((void*)list->current);
+    DCE2_PoolFree(DCE2_POOL__LIST_NODE, list->current);
     list->current = nullptr;
 
     list->num_nodes--;
@@ -700,7 +700,7 @@ DCE2_Queue* DCE2_QueueNew(DCE2_QueueDataFree df)
 {
     DCE2_Queue* queue;
 
-    queue = (DCE2_Queue*)snort_calloc(sizeof(DCE2_Queue));
+    queue = (DCE2_Queue*)DCE2_PoolAlloc(DCE2_POOL__QUEUE);
     queue->data_free = df;
 
     return queue;
@@ -731,7 +731,7 @@ DCE2_Ret DCE2_QueueEnqueue(DCE2_Queue* queue, void* data)
     if (queue == nullptr)
         return DCE2_RET__ERROR;
 
-    n = (DCE2_QueueNode*)snort_calloc(sizeof(DCE2_QueueNode));
+    n = (DCE2_QueueNode*)DCE2_PoolAlloc(DCE2_POOL__QUEUE_NODE);
     n->data = data;
 
     if (queue->tail == nullptr)
@@ -793,7 +793,7 @@ void* DCE2_QueueDequeue(DCE2_Queue* queue)
             queue->head = queue->head->next;
         }
 
-        snort_free((void*)n);
+        DCE2_PoolFree(DCE2_POOL__QUEUE_NODE, n);
 
         queue->num_nodes--;
 
@@ -833,7 +833,7 @@ void DCE2_QueueEmpty(DCE2_Queue* queue)
         if (queue->data_free != nullptr)
             queue->data_free(n->data);
 
-        snort_free((void*)n);
+        DCE2_PoolFree(DCE2_POOL__QUEUE_NODE, n);
         n = tmp;
     }
 
@@ -859,7 +859,7 @@ void DCE2_QueueDestroy(DCE2_Queue* queue)
         return;
 
     DCE2_QueueEmpty(queue);
-    snort_free((void*)queue);
+    DCE2_PoolFree(DCE2_POOL__QUEUE, queue);
 }
 
 /********************************************************************
@@ -974,7 +974,7 @@ void DCE2_QueueRemoveCurrent(DCE2_Queue* queue)
     if (queue->data_free != nullptr)
         queue->data_free(queue->current->data);
 
-    snort_free((void*)queue->current);
+    DCE2_PoolFree(DCE2_POOL__QUEUE_NODE, queue->current);
     queue->current = nullptr;
 
     queue->num_nodes--;
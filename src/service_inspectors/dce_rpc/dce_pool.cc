@@ -0,0 +1,124 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// dce_pool.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "dce_pool.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "main/thread.h"
+#include "utils/util.h"
+
+#include "dce_co.h"
+#include "dce_list.h"
+#include "dce_smb.h"
+
+// cap what a thread holds on to after a burst of opens / pipelined requests
+#define DCE2_POOL__MAX_CACHED 4096
+
+struct DCE2_PoolEntry
+{
+    DCE2_PoolEntry* next;
+};
+
+struct DCE2_FreeList
+{
+    DCE2_PoolEntry* head;
+    unsigned count;
+};
+
+static const size_t pool_sizes[DCE2_POOL__MAX] =
+{
+    sizeof(DCE2_List),
+    sizeof(DCE2_ListNode),
+    sizeof(DCE2_Queue),
+    sizeof(DCE2_QueueNode),
+    sizeof(DCE2_CoTracker),
+    sizeof(DCE2_SmbRequestTracker),
+    sizeof(DCE2_SmbFileTracker),
+    sizeof(DCE2_SmbFileChunk),
+};
+
+static THREAD_LOCAL bool pool_active = false;
+static THREAD_LOCAL DCE2_FreeList pools[DCE2_POOL__MAX];
+
+void DCE2_PoolInit()
+{
+    pool_active = true;
+}
+
+void DCE2_PoolTerm()
+{
+    if ( !pool_active )
+        return;
+
+    for ( auto& fl : pools )
+    {
+        while ( fl.head )
+        {
+            DCE2_PoolEntry* e = fl.head;
+            fl.head = e->next;
+            snort_free(e);
+        }
+        fl.count = 0;
+    }
+    pool_active = false;
+}
+
+void* DCE2_PoolAlloc(DCE2_PoolType type)
+{
+    assert(type < DCE2_POOL__MAX);
+    DCE2_FreeList& fl = pools[type];
+
+    if ( !fl.head )
+        return snort_calloc(pool_sizes[type]);
+
+    DCE2_PoolEntry* e = fl.head;
+    fl.head = e->next;
+    fl.count--;
+
+    memset(e, 0, pool_sizes[type]);
+    return e;
+}
+
+void DCE2_PoolFree(DCE2_PoolType type, void* p)
+{
+    assert(type < DCE2_POOL__MAX);
+
+    if ( !p )
+        return;
+
+    DCE2_FreeList& fl = pools[type];
+
+    if ( !pool_active or fl.count >= DCE2_POOL__MAX_CACHED )
+    {
+        snort_free(p);
+        return;
+    }
+
+    DCE2_PoolEntry* e = (DCE2_PoolEntry*)p;
+    e->next = fl.head;
+    fl.head = e;
+    fl.count++;
+}
@@ -0,0 +1,53 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// dce_pool.h
+
+// Per-thread free lists for the small fixed size objects the DCE/RPC
+// inspectors allocate and release for every request: SMB request and file
+// trackers, CO trackers, file chunks and the list / queue nodes that hold
+// them.  Pooling is only active on packet threads between DCE2_PoolInit()
+// and DCE2_PoolTerm(); otherwise (e.g. config on the main thread) these
+// fall through to snort_calloc / snort_free.  Objects are allocated one at
+// a time so anything released after DCE2_PoolTerm() goes back to the heap.
+
+#ifndef DCE_POOL_H
+#define DCE_POOL_H
+
+enum DCE2_PoolType
+{
+    DCE2_POOL__LIST = 0,
+    DCE2_POOL__LIST_NODE,
+    DCE2_POOL__QUEUE,
+    DCE2_POOL__QUEUE_NODE,
+    DCE2_POOL__CO_TRACKER,
+    DCE2_POOL__SMB_RTRACKER,
+    DCE2_POOL__SMB_FTRACKER,
+    DCE2_POOL__SMB_FILE_CHUNK,
+    DCE2_POOL__MAX
+};
+
+// thread local; idempotent so each dce inspector type may call these
+void DCE2_PoolInit();
+void DCE2_PoolTerm();
+
+// returns zeroed memory like snort_calloc
+void* DCE2_PoolAlloc(DCE2_PoolType);
+void DCE2_PoolFree(DCE2_PoolType, void*);
+
+#endif
@@ -30,6 +30,7 @@
 #include "utils/util.h"
 #include "packet_io/active.h"
 
+#include "dce_pool.h"
 #include "dce_smb_commands.h"
 #include "dce_smb_module.h"
 #include "dce_smb_paf.h"
@@ -430,6 +431,16 @@ static void dce2_smb_init()
     DCE2_SmbInitDeletePdu();
 }
 
+static void dce2_smb_tinit()
+{
+    DCE2_PoolInit();
+}
+
+static void dce2_smb_tterm()
+{
+    DCE2_PoolTerm();
+}
+
 static snort::Inspector* dce2_smb_ctor(snort::Module* m)
 {
     Dce2SmbModule* mod = (Dce2SmbModule*)m;
@@ -463,8 +474,8 @@ const snort::InspectApi dce2_smb_api =
     "netbios-ssn",
     dce2_smb_init,
     nullptr, // pterm
-    nullptr, // tinit
-    nullptr, // tterm
+    dce2_smb_tinit,
+    dce2_smb_tterm,
     dce2_smb_ctor,
     dce2_smb_dtor,
     nullptr, // ssn
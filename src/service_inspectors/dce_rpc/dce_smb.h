@@ -401,6 +401,10 @@ struct DCE2_SmbRequestTracker
 
     // For TreeConnect to know whether it's to IPC
     bool is_ipc;
+
+    // Links for DCE2_SmbSsnData::rtrackers
+    DCE2_SmbRequestTracker* next;
+    DCE2_SmbRequestTracker* prev;
 };
 
 struct DCE2_SmbSsnData
@@ -428,7 +432,8 @@ struct DCE2_SmbSsnData
 
     // For tracking requests / responses
     DCE2_SmbRequestTracker rtracker;
-    DCE2_Queue* rtrackers;
+    DCE2_SmbRequestTracker* rtrackers;  // Pooled overflow, oldest first
+    DCE2_SmbRequestTracker* rtrackers_tail;
     uint16_t max_outstanding_requests;
     uint16_t outstanding_requests;
 
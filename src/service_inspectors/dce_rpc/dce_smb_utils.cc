@@ -32,6 +32,7 @@
 #include "packet_io/active.h"
 #include "utils/util.h"
 
+#include "dce_pool.h"
 #include "dce_smb_module.h"
 
 using namespace snort;
@@ -287,9 +288,9 @@ DCE2_SmbRequestTracker* DCE2_SmbNewRequestTracker(DCE2_SmbSsnData* ssd,
 
         // Look at the next request in the queue
         if (tmp_rtracker == &ssd->rtracker)
-            tmp_rtracker = (DCE2_SmbRequestTracker*)DCE2_QueueFirst(ssd->rtrackers);
+            tmp_rtracker = ssd->rtrackers;
         else
-            tmp_rtracker = (DCE2_SmbRequestTracker*)DCE2_QueueNext(ssd->rtrackers);
+            tmp_rtracker = tmp_rtracker->next;
     }
 
     DCE2_SmbRequestTracker* rtracker = nullptr;
@@ -299,26 +300,14 @@ DCE2_SmbRequestTracker* DCE2_SmbNewRequestTracker(DCE2_SmbSsnData* ssd,
     }
     else
     {
-        if (ssd->rtrackers == nullptr)
-        {
-            ssd->rtrackers = DCE2_QueueNew(DCE2_SmbRequestTrackerDataFree);
-            if (ssd->rtrackers == nullptr)
-            {
-                return nullptr;
-            }
-        }
-
-        rtracker = (DCE2_SmbRequestTracker*)snort_calloc(sizeof(DCE2_SmbRequestTracker));
-        if (rtracker == nullptr)
-        {
-            return nullptr;
-        }
+        rtracker = (DCE2_SmbRequestTracker*)DCE2_PoolAlloc(DCE2_POOL__SMB_RTRACKER);
 
-        if (DCE2_QueueEnqueue(ssd->rtrackers, (void*)rtracker) != DCE2_RET__SUCCESS)
-        {
-            snort_free((void*)rtracker);
-            return nullptr;
-        }
+        rtracker->prev = ssd->rtrackers_tail;
+        if (ssd->rtrackers_tail != nullptr)
+            ssd->rtrackers_tail->next = rtracker;
+        else
+            ssd->rtrackers = rtracker;
+        ssd->rtrackers_tail = rtracker;
     }
 
     rtracker->smb_com = SmbCom(smb_hdr);
@@ -362,18 +351,13 @@ DCE2_SmbFileTracker* DCE2_SmbNewFileTracker(DCE2_SmbSsnData* ssd,
     }
     else
     {
-        ftracker = (DCE2_SmbFileTracker*)snort_calloc(sizeof(DCE2_SmbFileTracker));
-
-        if (ftracker == nullptr)
-        {
-            return nullptr;
-        }
+        ftracker = (DCE2_SmbFileTracker*)DCE2_PoolAlloc(DCE2_POOL__SMB_FTRACKER);
 
         if (DCE2_SmbInitFileTracker(ssd, ftracker, is_ipc, uid, tid, (int)fid) !=
             DCE2_RET__SUCCESS)
         {
             DCE2_SmbCleanFileTracker(ftracker);
-            snort_free((void*)ftracker);
+            DCE2_PoolFree(DCE2_POOL__SMB_FTRACKER, ftracker);
             return nullptr;
         }
 
@@ -417,9 +401,7 @@ DCE2_Ret DCE2_SmbInitFileTracker(DCE2_SmbSsnData* ssd,
     ftracker->file_name_size = 0;
     if (is_ipc)
     {
-        DCE2_CoTracker* co_tracker = (DCE2_CoTracker*)snort_calloc(sizeof(DCE2_CoTracker));
-        if (co_tracker == nullptr)
-            return DCE2_RET__ERROR;
+        DCE2_CoTracker* co_tracker = (DCE2_CoTracker*)DCE2_PoolAlloc(DCE2_POOL__CO_TRACKER);
         DCE2_CoInitTracker(co_tracker);
         ftracker->fp_co_tracker = co_tracker;
         ftracker->fp_byte_mode = false;
@@ -596,7 +578,7 @@ void DCE2_SmbCleanFileTracker(DCE2_SmbFileTracker* ftracker)
         if (ftracker->fp_co_tracker != nullptr)
         {
             DCE2_CoCleanTracker(ftracker->fp_co_tracker);
-            snort_free((void*)ftracker->fp_co_tracker);
+            DCE2_PoolFree(DCE2_POOL__CO_TRACKER, ftracker->fp_co_tracker);
             ftracker->fp_co_tracker = nullptr;
         }
     }
@@ -624,7 +606,7 @@ void DCE2_SmbFileTrackerDataFree(void* data)
         return;
 
     DCE2_SmbCleanFileTracker(ftracker);
-    snort_free((void*)ftracker);
+    DCE2_PoolFree(DCE2_POOL__SMB_FTRACKER, ftracker);
 }
 
 /********************************************************************
@@ -635,7 +617,7 @@ void DCE2_SmbFileTrackerDataFree(void* data)
 void DCE2_SmbCleanSessionFileTracker(DCE2_SmbSsnData* ssd, DCE2_SmbFileTracker* ftracker)
 {
     DCE2_SmbCleanFileTracker(ftracker);
-    snort_free((void*)ftracker);
+    DCE2_PoolFree(DCE2_POOL__SMB_FTRACKER, ftracker);
     if (ssd->fapi_ftracker == ftracker)
         ssd->fapi_ftracker = nullptr;
 }
@@ -707,19 +689,42 @@ void DCE2_SmbRemoveRequestTracker(DCE2_SmbSsnData* ssd,
     }
 
     DCE2_SmbRequestTracker* tmp_node;
-    for (tmp_node = (DCE2_SmbRequestTracker*)DCE2_QueueFirst(ssd->rtrackers);
-        tmp_node != nullptr;
-        tmp_node = (DCE2_SmbRequestTracker*)DCE2_QueueNext(ssd->rtrackers))
+    for (tmp_node = ssd->rtrackers; tmp_node != nullptr; tmp_node = tmp_node->next)
     {
-        if (tmp_node == (void*)rtracker)
+        if (tmp_node == rtracker)
         {
-            DCE2_QueueRemoveCurrent(ssd->rtrackers);
+            if (rtracker->prev != nullptr)
+                rtracker->prev->next = rtracker->next;
+            else
+                ssd->rtrackers = rtracker->next;
+
+            if (rtracker->next != nullptr)
+                rtracker->next->prev = rtracker->prev;
+            else
+                ssd->rtrackers_tail = rtracker->prev;
+
+            DCE2_SmbRequestTrackerDataFree(rtracker);
             ssd->outstanding_requests--;
             return;
         }
     }
 }
 
+void DCE2_SmbFreeRequestTrackers(DCE2_SmbSsnData* ssd)
+{
+    DCE2_SmbCleanRequestTracker(&ssd->rtracker);
+
+    DCE2_SmbRequestTracker* rtracker = ssd->rtrackers;
+    while (rtracker != nullptr)
+    {
+        DCE2_SmbRequestTracker* next = rtracker->next;
+        DCE2_SmbRequestTrackerDataFree(rtracker);
+        rtracker = next;
+    }
+
+    ssd->rtrackers = ssd->rtrackers_tail = nullptr;
+}
+
 void DCE2_SmbRemoveFileTrackerFromRequestTrackers(DCE2_SmbSsnData* ssd,
     DCE2_SmbFileTracker* ftracker)
 {
@@ -735,9 +740,7 @@ void DCE2_SmbRemoveFileTrackerFromRequestTrackers(DCE2_SmbSsnData* ssd,
         ssd->cur_rtracker->ftracker = nullptr;
 
     DCE2_SmbRequestTracker* rtracker;
-    for (rtracker = (DCE2_SmbRequestTracker*)DCE2_QueueFirst(ssd->rtrackers);
-        rtracker != nullptr;
-        rtracker = (DCE2_SmbRequestTracker*)DCE2_QueueNext(ssd->rtrackers))
+    for (rtracker = ssd->rtrackers; rtracker != nullptr; rtracker = rtracker->next)
     {
         if (rtracker->ftracker == ftracker)
             rtracker->ftracker = nullptr;
@@ -759,7 +762,7 @@ DCE2_SmbFileTracker* DCE2_SmbDequeueTmpFileTracker(DCE2_SmbSsnData* ssd,
     if (ssd->ftracker.fid_v1 == DCE2_SENTINEL)
     {
         memcpy(&ssd->ftracker, ftracker, sizeof(DCE2_SmbFileTracker));
-        snort_free((void*)ftracker);
+        DCE2_PoolFree(DCE2_POOL__SMB_FTRACKER, ftracker);
         if (ssd->fapi_ftracker == ftracker)
             ssd->fapi_ftracker = &ssd->ftracker;
         ftracker = &ssd->ftracker;
@@ -801,7 +804,7 @@ void DCE2_SmbRequestTrackerDataFree(void* data)
         return;
 
     DCE2_SmbCleanRequestTracker(rtracker);
-    snort_free((void*)rtracker);
+    DCE2_PoolFree(DCE2_POOL__SMB_RTRACKER, rtracker);
 }
 
 DCE2_Ret DCE2_SmbFindTid(DCE2_SmbSsnData* ssd, const uint16_t tid)
@@ -979,19 +982,14 @@ void DCE2_SmbQueueTmpFileTracker(DCE2_SmbSsnData* ssd,
     Profile profile(dce2_smb_pstat_smb_fid);
 
     DCE2_SmbFileTracker* ftracker = (DCE2_SmbFileTracker*)
-        snort_calloc(sizeof(DCE2_SmbFileTracker));
-
-    if (ftracker == nullptr)
-    {
-        return;
-    }
+        DCE2_PoolAlloc(DCE2_POOL__SMB_FTRACKER);
 
     bool is_ipc = DCE2_SmbIsTidIPC(ssd, tid);
     if (DCE2_SmbInitFileTracker(ssd, ftracker, is_ipc, uid, tid, DCE2_SENTINEL) !=
         DCE2_RET__SUCCESS)
     {
         DCE2_SmbCleanFileTracker(ftracker);
-        snort_free((void*)ftracker);
+        DCE2_PoolFree(DCE2_POOL__SMB_FTRACKER, ftracker);
         return;
     }
 
@@ -1638,7 +1636,7 @@ static void DCE2_SmbFileChunkFree(void* data)
     if (fc->data != nullptr)
         snort_free((void*)fc->data);
 
-    snort_free((void*)fc);
+    DCE2_PoolFree(DCE2_POOL__SMB_FILE_CHUNK, fc);
 }
 
 static DCE2_Ret DCE2_SmbHandleOutOfOrderFileData(DCE2_SmbSsnData* ssd,
@@ -1704,8 +1702,8 @@ static DCE2_Ret DCE2_SmbHandleOutOfOrderFileData(DCE2_SmbSsnData* ssd,
                 return DCE2_RET__ERROR;
         }
 
-        DCE2_SmbFileChunk* file_chunk = (DCE2_SmbFileChunk*)snort_calloc(
-            sizeof(DCE2_SmbFileChunk));
+        DCE2_SmbFileChunk* file_chunk = (DCE2_SmbFileChunk*)DCE2_PoolAlloc(
+            DCE2_POOL__SMB_FILE_CHUNK);
         file_chunk->data = (uint8_t*)snort_calloc(data_len);
 
         file_chunk->offset = ftracker->ff_file_offset;
@@ -1718,7 +1716,7 @@ static DCE2_Ret DCE2_SmbHandleOutOfOrderFileData(DCE2_SmbSsnData* ssd,
                 (void*)file_chunk, (void*)file_chunk)) != DCE2_RET__SUCCESS)
         {
             snort_free((void*)file_chunk->data);
-            snort_free((void*)file_chunk);
+            DCE2_PoolFree(DCE2_POOL__SMB_FILE_CHUNK, file_chunk);
 
             if (ret != DCE2_RET__DUPLICATE)
                 return DCE2_RET__ERROR;
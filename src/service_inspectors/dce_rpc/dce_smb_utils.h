@@ -158,6 +158,7 @@ DCE2_Ret DCE2_SmbInitFileTracker(DCE2_SmbSsnData*,
     DCE2_SmbFileTracker*, const bool, const uint16_t,
     const uint16_t, const int);
 void DCE2_SmbRequestTrackerDataFree(void*);
+void DCE2_SmbFreeRequestTrackers(DCE2_SmbSsnData*);
 DCE2_SmbFileTracker* DCE2_SmbFindFileTracker(DCE2_SmbSsnData*,
     const uint16_t, const uint16_t, const uint16_t);
 DCE2_Ret DCE2_SmbProcessRequestData(DCE2_SmbSsnData*, const uint16_t,
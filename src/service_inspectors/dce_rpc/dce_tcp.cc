@@ -29,6 +29,7 @@
 #include "utils/util.h"
 
 #include "dce_common.h"
+#include "dce_pool.h"
 #include "dce_tcp_module.h"
 #include "dce_tcp_paf.h"
 
@@ -209,6 +210,16 @@ static void dce2_tcp_init()
     Dce2TcpFlowData::init();
 }
 
+static void dce2_tcp_tinit()
+{
+    DCE2_PoolInit();
+}
+
+static void dce2_tcp_tterm()
+{
+    DCE2_PoolTerm();
+}
+
 const InspectApi dce2_tcp_api =
 {
     {
@@ -229,8 +240,8 @@ const InspectApi dce2_tcp_api =
     DCE_RPC_SERVICE_NAME,
     dce2_tcp_init,
     nullptr, // pterm
-    nullptr, // tinit
-    nullptr, // tterm
+    dce2_tcp_tinit,
+    dce2_tcp_tterm,
     dce2_tcp_ctor,
     dce2_tcp_dtor,
     nullptr, // ssn
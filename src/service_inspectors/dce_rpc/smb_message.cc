@@ -528,9 +528,9 @@ static DCE2_SmbRequestTracker* DCE2_SmbFindRequestTracker(DCE2_SmbSsnData* ssd,
 
         // Look at the next request in the queue
         if (tmp_rtracker == &ssd->rtracker)
-            tmp_rtracker = (DCE2_SmbRequestTracker*)DCE2_QueueFirst(ssd->rtrackers);
+            tmp_rtracker = ssd->rtrackers;
         else
-            tmp_rtracker = (DCE2_SmbRequestTracker*)DCE2_QueueNext(ssd->rtrackers);
+            tmp_rtracker = tmp_rtracker->next;
     }
 
     DCE2_Policy policy = DCE2_SsnGetPolicy(&ssd->sd);
@@ -1256,12 +1256,7 @@ static void DCE2_SmbDataFree(DCE2_SmbSsnData* ssd)
         ssd->ftrackers = nullptr;
     }
 
-    DCE2_SmbCleanRequestTracker(&ssd->rtracker);
-    if (ssd->rtrackers != nullptr)
-    {
-        DCE2_QueueDestroy(ssd->rtrackers);
-        ssd->rtrackers = nullptr;
-    }
+    DCE2_SmbFreeRequestTrackers(ssd);
 
     if (ssd->cli_seg != nullptr)
     {
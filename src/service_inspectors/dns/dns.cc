@@ -35,6 +35,12 @@
 
 #include "dns_module.h"
 
+#ifdef UNIT_TEST
+#include <vector>
+
+#include "catch/snort_catch.h"
+#endif
+
 using namespace snort;
 
 #define MAX_UDP_PAYLOAD 0x1FFF
@@ -695,6 +701,250 @@ static uint16_t ParseDNSRData(
     return bytes_unused;
 }
 
+//-------------------------------------------------------------------------
+// fast path
+//-------------------------------------------------------------------------
+
+// Nearly all UDP responses arrive whole, so whole records are parsed in
+// place instead of a byte at a time through the states above.  The first
+// record that does not fit in the remaining data, or that the state
+// machine treats specially, is handed back to the state machine at the
+// start of that record.  Records handled here produce the same events and
+// session state as the state machine.
+
+enum DNSFastResult
+{
+    DNS_FAST_DONE,
+    DNS_FAST_SPLIT,
+    DNS_FAST_NOT_DNS
+};
+
+static inline uint16_t get_dns16(const unsigned char* data)
+{ return (data[0] << 8) | data[1]; }
+
+// return the length of the name or 0 if it does not fit
+static inline unsigned SkipDNSNameFast(const unsigned char* data, unsigned len)
+{
+    unsigned i = 0;
+
+    while ( i < len )
+    {
+        uint8_t label = data[i];
+
+        if ( !label )
+            return i + 1;
+
+        // compression pointers end the name; they are not followed
+        if ( (label & DNS_RR_PTR) == DNS_RR_PTR )
+            return (i + 2 <= len) ? i + 2 : 0;
+
+        i += label + 1;
+    }
+    return 0;
+}
+
+// the state machine runs over the end of rdata if the strings don't fit
+static inline bool FitDNSTxtFast(const unsigned char* rdata, unsigned len)
+{
+    unsigned i = 0;
+
+    while ( i < len )
+        i += rdata[i] + 1;
+
+    return i == len;
+}
+
+static void CheckRRTypeTXTVulnFast(const unsigned char* rdata, unsigned len)
+{
+    uint32_t txt_count = 0;
+    uint32_t total_txt_len = 0;
+
+    for ( unsigned i = 0; i < len; i += rdata[i] + 1 )
+    {
+        txt_count++;
+        total_txt_len += rdata[i] + 1;
+
+        if ( (txt_count * 4) + (total_txt_len * 2) + 4 > 0xFFFF )
+        {
+            DetectionEngine::queue_event(GID_DNS, DNS_EVENT_RDATA_OVERFLOW);
+            return;
+        }
+    }
+}
+
+static DNSFastResult ParseDNSRRFast(
+    const unsigned char* data, unsigned len, unsigned& used, DNSData* dnsSessionData)
+{
+    unsigned name_len = SkipDNSNameFast(data, len);
+
+    if ( !name_len or len - name_len < 10 )
+        return DNS_FAST_SPLIT;
+
+    const unsigned char* rr = data + name_len;
+    uint16_t rdlength = get_dns16(rr + 8);
+
+    if ( len - name_len - 10 < rdlength )
+        return DNS_FAST_SPLIT;
+
+    const unsigned char* rdata = rr + 10;
+
+    dnsSessionData->curr_rr.type = get_dns16(rr);
+    dnsSessionData->curr_rr.dns_class = get_dns16(rr + 2);
+    dnsSessionData->curr_rr.ttl = ((uint32_t)get_dns16(rr + 4) << 16) | get_dns16(rr + 6);
+    dnsSessionData->curr_rr.length = rdlength;
+
+    switch ( dnsSessionData->curr_rr.type )
+    {
+    case DNS_RR_TYPE_TXT:
+        if ( !FitDNSTxtFast(rdata, rdlength) )
+            return DNS_FAST_SPLIT;
+
+        CheckRRTypeTXTVulnFast(rdata, rdlength);
+        break;
+
+    case DNS_RR_TYPE_MD:
+    case DNS_RR_TYPE_MF:
+        DetectionEngine::queue_event(GID_DNS, DNS_EVENT_OBSOLETE_TYPES);
+        break;
+
+    case DNS_RR_TYPE_MB:
+    case DNS_RR_TYPE_MG:
+    case DNS_RR_TYPE_MR:
+    case DNS_RR_TYPE_NULL:
+    case DNS_RR_TYPE_MINFO:
+        DetectionEngine::queue_event(GID_DNS, DNS_EVENT_EXPERIMENTAL_TYPES);
+        break;
+
+    case DNS_RR_TYPE_A:
+    case DNS_RR_TYPE_NS:
+    case DNS_RR_TYPE_CNAME:
+    case DNS_RR_TYPE_SOA:
+    case DNS_RR_TYPE_WKS:
+    case DNS_RR_TYPE_PTR:
+    case DNS_RR_TYPE_HINFO:
+    case DNS_RR_TYPE_MX:
+        break;
+
+    default:
+        // leave the session where the state machine would
+        dnsSessionData->curr_rec_state = DNS_RESP_STATE_RR_RDATA_MID;
+        dnsSessionData->bytes_seen_curr_rec = 0;
+        dnsSessionData->flags |= DNS_FLAG_NOT_DNS;
+        return DNS_FAST_NOT_DNS;
+    }
+
+    dnsSessionData->bytes_seen_curr_rec = rdlength;
+
+    used = name_len + 10 + rdlength;
+    return DNS_FAST_DONE;
+}
+
+// parse one response from the top of a UDP payload; returns false if this
+// is no longer DNS.  bytes_unused is updated to what is left over.
+static bool ParseDNSResponseFast(
+    const unsigned char* data, uint16_t& bytes_unused, DNSData* dnsSessionData)
+{
+    if ( bytes_unused < sizeof(DNSHdr) )
+        return true;
+
+    DNSHdr& hdr = dnsSessionData->hdr;
+
+    hdr.id = get_dns16(data);
+    hdr.flags = get_dns16(data + 2);
+    hdr.questions = get_dns16(data + 4);
+    hdr.answers = get_dns16(data + 6);
+    hdr.authorities = get_dns16(data + 8);
+    hdr.additionals = get_dns16(data + 10);
+
+    if (hdr.flags & DNS_HDR_FLAG_RESPONSE)
+        dnsstats.responses++;
+
+    const unsigned char* cur = data + sizeof(DNSHdr);
+    unsigned left = bytes_unused - sizeof(DNSHdr);
+
+    dnsSessionData->state = DNS_RESP_STATE_QUESTION;
+    memset(&dnsSessionData->curr_txt, 0, sizeof(DNSNameState));
+
+    // stop where the state machine does when out of data
+    if ( !left )
+    {
+        bytes_unused = left;
+        return true;
+    }
+    dnsSessionData->curr_rec_state = DNS_RESP_STATE_Q_NAME;
+    dnsSessionData->curr_rec = 0;
+
+    if ( !(hdr.flags & DNS_HDR_FLAG_RESPONSE) )
+    {
+        bytes_unused = left;
+        return true;
+    }
+
+    for ( ; dnsSessionData->curr_rec < hdr.questions; dnsSessionData->curr_rec++ )
+    {
+        unsigned name_len = SkipDNSNameFast(cur, left);
+
+        if ( !name_len or left - name_len < 4 )
+        {
+            bytes_unused = left;
+            return true;
+        }
+        dnsSessionData->curr_q.type = get_dns16(cur + name_len);
+        dnsSessionData->curr_q.dns_class = get_dns16(cur + name_len + 2);
+
+        cur += name_len + 4;
+        left -= name_len + 4;
+
+        if ( !left )
+        {
+            dnsSessionData->curr_rec++;
+            bytes_unused = left;
+            return true;
+        }
+    }
+
+    // FIXIT-L additionals are counted with authorities to match the state
+    // machine; fix both together
+    const uint16_t counts[] = { hdr.answers, hdr.authorities, hdr.authorities };
+    const uint32_t states[] =
+        { DNS_RESP_STATE_ANS_RR, DNS_RESP_STATE_AUTH_RR, DNS_RESP_STATE_ADD_RR };
+
+    for ( unsigned sect = 0; sect < 3; ++sect )
+    {
+        dnsSessionData->state = states[sect];
+        dnsSessionData->curr_rec_state = DNS_RESP_STATE_RR_NAME_SIZE;
+        dnsSessionData->curr_rec = 0;
+
+        for ( ; dnsSessionData->curr_rec < counts[sect]; dnsSessionData->curr_rec++ )
+        {
+            unsigned used = 0;
+
+            switch ( ParseDNSRRFast(cur, left, used, dnsSessionData) )
+            {
+            case DNS_FAST_SPLIT:
+                bytes_unused = left;
+                return true;
+
+            case DNS_FAST_NOT_DNS:
+                bytes_unused = left;
+                return false;
+
+            case DNS_FAST_DONE:
+                cur += used;
+                left -= used;
+                break;
+            }
+        }
+    }
+
+    dnsSessionData->state = DNS_RESP_STATE_LENGTH;
+    dnsSessionData->curr_rec_state = 0;
+    dnsSessionData->curr_rec = 0;
+
+    bytes_unused = left;
+    return true;
+}
+
 static void ParseDNSResponseMessage(Packet* p, DNSData* dnsSessionData)
 {
     uint16_t bytes_unused = p->dsize;
@@ -703,6 +953,22 @@ static void ParseDNSResponseMessage(Packet* p, DNSData* dnsSessionData)
 
     while (bytes_unused)
     {
+        if ((dnsSessionData->state == DNS_RESP_STATE_LENGTH) && p->is_udp() &&
+            (bytes_unused >= sizeof(DNSHdr)))
+        {
+            if ( !ParseDNSResponseFast(data, bytes_unused, dnsSessionData) )
+                return;
+
+            data = p->data + (p->dsize - bytes_unused);
+
+            // whole message done; may be another in this packet
+            if (dnsSessionData->state == DNS_RESP_STATE_LENGTH)
+                continue;
+
+            if ( !bytes_unused )
+                return;
+        }
+
         /* Parse through the DNS Header */
         if (dnsSessionData->state < DNS_RESP_STATE_QUESTION)
         {
@@ -1063,3 +1329,313 @@ SO_PUBLIC const BaseApi* snort_plugins[] =
 const BaseApi* sin_dns = &dns_api.base;
 #endif
 
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+// www.example.com A -> CNAME + 2 A, 2 NS, 2 A glue
+static const uint8_t dns_resp[] =
+{
+    0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x03, 0x00, 0x02, 0x00, 0x02,
+
+    3, 'w', 'w', 'w', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0,
+    0x00, 0x01, 0x00, 0x01,
+
+    0xc0, 0x0c, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10, 0x00, 0x06,
+    3, 'c', 'd', 'n', 0xc0, 0x10,
+    0xc0, 0x2d, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x04,
+    192, 0, 2, 1,
+    0xc0, 0x2d, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x04,
+    192, 0, 2, 2,
+
+    0xc0, 0x10, 0x00, 0x02, 0x00, 0x01, 0x00, 0x01, 0x51, 0x80, 0x00, 0x06,
+    3, 'n', 's', '1', 0xc0, 0x10,
+    0xc0, 0x10, 0x00, 0x02, 0x00, 0x01, 0x00, 0x01, 0x51, 0x80, 0x00, 0x06,
+    3, 'n', 's', '2', 0xc0, 0x10,
+
+    0xc0, 0x5f, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x51, 0x80, 0x00, 0x04,
+    198, 51, 100, 1,
+    0xc0, 0x71, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x51, 0x80, 0x00, 0x04,
+    198, 51, 100, 2,
+};
+
+static void parse_slow(const uint8_t* data, uint16_t len, DNSData& dd)
+{
+    Packet p(false);
+    p.data = data;
+    p.dsize = len;
+
+    memset(&dd, 0, sizeof(dd));
+    dd.state = DNS_RESP_STATE_HDR_ID;
+    ParseDNSResponseMessage(&p, &dd);
+}
+
+static uint16_t parse_fast(const uint8_t* data, uint16_t len, DNSData& dd)
+{
+    memset(&dd, 0, sizeof(dd));
+    ParseDNSResponseFast(data, len, &dd);
+    return len;
+}
+
+static void check_same(const DNSData& a, const DNSData& b)
+{
+    CHECK(a.state == b.state);
+    CHECK(a.curr_rec == b.curr_rec);
+    CHECK(a.curr_rec_state == b.curr_rec_state);
+    CHECK(a.flags == b.flags);
+    CHECK(!memcmp(&a.hdr, &b.hdr, sizeof(a.hdr)));
+    CHECK(a.curr_q.type == b.curr_q.type);
+    CHECK(a.curr_rr.type == b.curr_rr.type);
+    CHECK(a.curr_rr.ttl == b.curr_rr.ttl);
+    CHECK(a.curr_rr.length == b.curr_rr.length);
+}
+
+TEST_CASE("fast path whole response", "[dns]")
+{
+    DNSData fast, slow;
+
+    CHECK(parse_fast(dns_resp, sizeof(dns_resp), fast) == 0);
+    CHECK(fast.state == DNS_RESP_STATE_LENGTH);
+    CHECK(fast.hdr.answers == 3);
+    CHECK(fast.curr_rr.type == DNS_RR_TYPE_A);
+    CHECK(fast.curr_rr.ttl == 86400);
+
+    parse_slow(dns_resp, sizeof(dns_resp), slow);
+    check_same(fast, slow);
+}
+
+TEST_CASE("fast path hands off split record", "[dns]")
+{
+    // cut in the middle of the first NS record
+    DNSData fast;
+
+    CHECK(parse_fast(dns_resp, 0x58, fast) == 5);
+    CHECK(fast.state == DNS_RESP_STATE_AUTH_RR);
+    CHECK(fast.curr_rec == 0);
+    CHECK(fast.curr_rec_state == DNS_RESP_STATE_RR_NAME_SIZE);
+}
+
+TEST_CASE("fast path matches state machine", "[dns]")
+{
+    // wherever the fast path stops, the state machine ends up in the same place
+    for ( uint16_t len = sizeof(DNSHdr); len <= sizeof(dns_resp); ++len )
+    {
+        DNSData fast, slow;
+        uint16_t left = parse_fast(dns_resp, len, fast);
+
+        Packet p(false);
+        p.data = dns_resp + (len - left);
+        p.dsize = left;
+        ParseDNSResponseMessage(&p, &fast);
+
+        parse_slow(dns_resp, len, slow);
+        check_same(fast, slow);
+    }
+}
+
+TEST_CASE("fast path unknown type", "[dns]")
+{
+    uint8_t buf[sizeof(dns_resp)];
+    memcpy(buf, dns_resp, sizeof(buf));
+
+    // make the second A record type 99
+    buf[0x45] = 0x00;
+    buf[0x46] = 0x63;
+
+    DNSData fast, slow;
+    uint16_t left = sizeof(buf);
+    memset(&fast, 0, sizeof(fast));
+
+    CHECK(!ParseDNSResponseFast(buf, left, &fast));
+    parse_slow(buf, sizeof(buf), slow);
+    check_same(fast, slow);
+    CHECK((fast.flags & DNS_FLAG_NOT_DNS) != 0);
+}
+
+// responses for the mixed set are built around the same question
+class DnsResponse
+{
+public:
+    DnsResponse(uint16_t answers, uint16_t flags = 0x8180)
+    {
+        u16(0x1234); u16(flags); u16(1); u16(answers); u16(0); u16(0);
+
+        const uint8_t name[] = { 3, 'w', 'w', 'w', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e',
+            3, 'c', 'o', 'm', 0 };
+        buf.insert(buf.end(), name, name + sizeof(name));
+        u16(DNS_RR_TYPE_A); u16(1);
+    }
+
+    void add_rr(uint16_t type, const uint8_t* rdata, uint16_t len)
+    {
+        u16(0xc00c); u16(type); u16(1); u16(0); u16(60); u16(len);
+        buf.insert(buf.end(), rdata, rdata + len);
+    }
+
+    void add_a(uint8_t last)
+    {
+        const uint8_t rdata[] = { 192, 0, 2, last };
+        add_rr(DNS_RR_TYPE_A, rdata, sizeof(rdata));
+    }
+
+    // one TXT record holding strings of the given lengths
+    void add_txt(unsigned num, uint8_t len)
+    {
+        std::vector<uint8_t> rdata;
+
+        for ( unsigned i = 0; i < num; ++i )
+        {
+            rdata.push_back(len);
+            rdata.insert(rdata.end(), len, 'v');
+        }
+        add_rr(DNS_RR_TYPE_TXT, rdata.data(), rdata.size());
+    }
+
+    std::vector<uint8_t> buf;
+
+private:
+    void u16(uint16_t v)
+    { buf.push_back(v >> 8); buf.push_back(v & 0xFF); }
+};
+
+struct DnsSample
+{
+    const char* name;
+    std::vector<uint8_t> payload;
+    std::vector<uint16_t> messages;  // length of each message in payload
+};
+
+static void add_sample(
+    std::vector<DnsSample>& set, const char* name, const std::vector<const DnsResponse*>& msgs,
+    uint16_t cut = 0)
+{
+    DnsSample s { name, { }, { } };
+
+    for ( const auto* m : msgs )
+    {
+        s.payload.insert(s.payload.end(), m->buf.begin(), m->buf.end());
+        s.messages.push_back(m->buf.size());
+    }
+    // a cut only applies to the last message
+    if ( cut )
+    {
+        s.payload.resize(s.payload.size() - s.messages.back() + cut);
+        s.messages.back() = cut;
+    }
+    set.emplace_back(s);
+}
+
+// typical, TXT heavy, large, truncated, and two messages in one datagram
+static const std::vector<DnsSample>& get_mixed_set()
+{
+    static std::vector<DnsSample> set;
+
+    if ( !set.empty() )
+        return set;
+
+    DnsResponse small(1);
+    small.add_a(1);
+
+    // the state machine only sees that a TXT record is done at the next
+    // byte so end these with another record to compare them
+    DnsResponse txt(4);
+    txt.add_txt(1, 40);
+    txt.add_txt(4, 200);
+    txt.add_txt(16, 60);
+    txt.add_a(1);
+
+    DnsResponse large(100);
+    for ( unsigned i = 0; i < 100; ++i )
+        large.add_a(i);
+
+    DnsResponse truncated(100, 0x8380);
+    for ( unsigned i = 0; i < 100; ++i )
+        truncated.add_a(i);
+
+    DnsResponse typical(0);
+    typical.buf.assign(dns_resp, dns_resp + sizeof(dns_resp));
+
+    add_sample(set, "typical", { &typical });
+    add_sample(set, "txt", { &txt });
+    add_sample(set, "large", { &large });
+    add_sample(set, "truncated", { &truncated }, 512);
+    add_sample(set, "multiple", { &small, &txt, &typical });
+
+    return set;
+}
+
+// the fast path as the inspector uses it, with the state machine picking
+// up whatever it leaves
+static void parse_udp(const DnsSample& s, DNSData& dd)
+{
+    Packet p(false);
+    p.ptrs.set_pkt_type(PktType::UDP);
+    p.data = s.payload.data();
+    p.dsize = s.payload.size();
+
+    memset(&dd, 0, sizeof(dd));
+    ParseDNSResponseMessage(&p, &dd);
+}
+
+// the state machine alone, one message at a time
+static void parse_slow(const DnsSample& s, DNSData& dd)
+{
+    const uint8_t* data = s.payload.data();
+
+    for ( auto len : s.messages )
+    {
+        parse_slow(data, len, dd);
+        data += len;
+    }
+}
+
+TEST_CASE("fast path mixed responses", "[dns]")
+{
+    for ( const auto& s : get_mixed_set() )
+    {
+        INFO(s.name);
+        DNSData fast, slow;
+
+        parse_udp(s, fast);
+        parse_slow(s, slow);
+        check_same(fast, slow);
+        CHECK((fast.flags & DNS_FLAG_NOT_DNS) == 0);
+    }
+}
+
+TEST_CASE("fast path benchmark", "[dns][!benchmark]")
+{
+    const auto& set = get_mixed_set();
+    DNSData dd;
+
+    for ( const auto& s : set )
+    {
+        BENCHMARK(std::string("fast ") + s.name)
+        {
+            for ( unsigned i = 0; i < 100000; ++i )
+                parse_udp(s, dd);
+        }
+        BENCHMARK(std::string("state machine ") + s.name)
+        {
+            for ( unsigned i = 0; i < 100000; ++i )
+                parse_slow(s, dd);
+        }
+    }
+    BENCHMARK("fast mixed")
+    {
+        for ( unsigned i = 0; i < 20000; ++i )
+            for ( const auto& s : set )
+                parse_udp(s, dd);
+    }
+    BENCHMARK("state machine mixed")
+    {
+        for ( unsigned i = 0; i < 20000; ++i )
+            for ( const auto& s : set )
+                parse_slow(s, dd);
+    }
+}
+
+#endif
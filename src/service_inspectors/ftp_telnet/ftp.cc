@@ -304,6 +304,7 @@ public:
     ~FtpServer() override;
 
     bool configure(SnortConfig*) override;
+    void apply(SnortConfig*) override;
     void show(SnortConfig*) override;
     void eval(Packet*) override;
     StreamSplitter* get_splitter(bool) override;
@@ -324,10 +325,14 @@ FtpServer::~FtpServer ()
 
 bool FtpServer::configure(SnortConfig* sc)
 {
-    ftp_data_snort_protocol_id = sc->proto_ref->add("ftp-data");
     return !FTPCheckConfigs(sc, ftp_server);
 }
 
+void FtpServer::apply(SnortConfig* sc)
+{
+    ftp_data_snort_protocol_id = sc->proto_ref->add("ftp-data");
+}
+
 void FtpServer::show(SnortConfig*)
 {
     PrintFTPServerConf(ftp_server);
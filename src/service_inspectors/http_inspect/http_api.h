@@ -43,7 +43,7 @@ private:
     static snort::Inspector* http_ctor(snort::Module* mod);
     static void http_dtor(snort::Inspector* p) { delete p; }
     static void http_tinit() { }
-    static void http_tterm() { }
+    static void http_tterm() { HttpFlowData::term_compress_pool(); }
 };
 
 #endif
@@ -0,0 +1,111 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "http_arena.h"
+
+#include <new>
+
+HttpArena::~HttpArena()
+{
+    while (head != nullptr)
+    {
+        Block* const next = head->next;
+        ::operator delete(head);
+        head = next;
+    }
+}
+
+HttpArena::Block* HttpArena::new_block(uint32_t size, uint32_t used)
+{
+    Block* const block = (Block*)::operator new(sizeof(Block) + size);
+    block->next = nullptr;
+    block->size = size;
+    block->used = used;
+    num_blocks++;
+    block_bytes += size;
+    return block;
+}
+
+uint8_t* HttpArena::allocate(uint32_t length)
+{
+    length = align(length);
+    if (length == 0)
+        length = ALIGNMENT;
+
+    // Oversized requests get a block of their own placed ahead of current so the unused
+    // tail of current is still available for later small requests
+    if (length > block_size)
+    {
+        Block* const block = new_block(length, length);
+        block->next = head;
+        head = block;
+        if (current == nullptr)
+            current = block;
+        return block->data();
+    }
+
+    // Blocks beyond current are left over from before the last reset and are empty
+    for (; current != nullptr; current = current->next)
+    {
+        if (current->size - current->used >= length)
+        {
+            uint8_t* const buffer = current->data() + current->used;
+            current->used += length;
+            return buffer;
+        }
+        if (current->next == nullptr)
+            break;
+    }
+
+    Block* const block = new_block(block_size, length);
+
+    if (current != nullptr)
+        current->next = block;
+    else
+        head = block;
+    current = block;
+    return block->data();
+}
+
+void HttpArena::reset()
+{
+    Block** link = &head;
+    uint32_t kept = 0;
+
+    while (*link != nullptr)
+    {
+        Block* const block = *link;
+        if ((block->size == block_size) && (kept < keep_blocks))
+        {
+            block->used = 0;
+            kept++;
+            link = &block->next;
+            continue;
+        }
+        *link = block->next;
+        num_blocks--;
+        block_bytes -= block->size;
+        ::operator delete(block);
+    }
+    current = head;
+}
+
@@ -0,0 +1,77 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef HTTP_ARENA_H
+#define HTTP_ARENA_H
+
+#include <cstdint>
+
+//-------------------------------------------------------------------------
+// HttpArena class
+// Bump allocator for buffers that share the lifetime of a transaction or a message section.
+// Nothing is freed individually. Everything goes away together when the arena is reset or
+// destroyed. Reset keeps the blocks so the next round of allocations does not touch the heap.
+// The block size should cover the largest request the owner makes routinely. Larger requests
+// get a block of their own that reset() frees.
+//-------------------------------------------------------------------------
+
+class HttpArena
+{
+public:
+    HttpArena(uint32_t block_size_ = DEFAULT_BLOCK_SIZE, uint32_t keep_blocks_ = DEFAULT_KEEP)
+        : block_size(align(block_size_)), keep_blocks(keep_blocks_) { }
+    ~HttpArena();
+    HttpArena(const HttpArena&) = delete;
+    HttpArena& operator=(const HttpArena&) = delete;
+
+    uint8_t* allocate(uint32_t length);
+    void reset();
+
+    uint32_t get_num_blocks() const { return num_blocks; }
+    uint64_t get_block_bytes() const { return block_bytes; }
+
+    static const uint32_t DEFAULT_BLOCK_SIZE = 8192;
+
+    // Standard blocks kept across reset(). Anything more was needed by an unusually large
+    // message and is freed rather than held for the life of the flow.
+    static const uint32_t DEFAULT_KEEP = 4;
+
+private:
+    struct Block
+    {
+        Block* next;
+        uint32_t size;
+        uint32_t used;
+        uint8_t* data() { return (uint8_t*)(this + 1); }
+    };
+
+    Block* new_block(uint32_t size, uint32_t used);
+
+    static const uint32_t ALIGNMENT = 8;
+    static uint32_t align(uint32_t length) { return (length + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    const uint32_t block_size;
+    const uint32_t keep_blocks;
+    Block* head = nullptr;
+    Block* current = nullptr;
+    uint32_t num_blocks = 0;
+    uint64_t block_bytes = 0;
+};
+
+#endif
+
@@ -24,6 +24,8 @@
 #include "http_flow_data.h"
 
 #include "decompress/file_decomp.h"
+#include "main/thread.h"
+#include "utils/util_jsnorm.h"
 
 #include "http_module.h"
 #include "http_test_manager.h"
@@ -33,6 +35,12 @@ using namespace HttpEnums;
 
 unsigned HttpFlowData::inspector_id = 0;
 
+// Inflate streams that are not attached to a message body. Each one carries zlib's state and a
+// 32 KB window so only a few are kept per packet thread and the rest are freed.
+static const unsigned COMPRESS_POOL_SIZE = 16;
+static THREAD_LOCAL z_stream* compress_pool[COMPRESS_POOL_SIZE];
+static THREAD_LOCAL unsigned compress_pool_count = 0;
+
 #ifdef REG_TEST
 uint64_t HttpFlowData::instance_count = 0;
 #endif
@@ -75,11 +83,7 @@ HttpFlowData::~HttpFlowData()
         delete[] section_buffer[k];
         HttpTransaction::delete_transaction(transaction[k]);
         delete cutter[k];
-        if (compress_stream[k] != nullptr)
-        {
-            inflateEnd(compress_stream[k]);
-            delete compress_stream[k];
-        }
+        release_compress_stream(compress_stream[k]);
         if (mime_state[k] != nullptr)
         {
             delete mime_state[k];
@@ -89,9 +93,58 @@ HttpFlowData::~HttpFlowData()
     delete utf_state;
     if (fd_state != nullptr)
         File_Decomp_StopFree(fd_state);
+    delete js_norm_state;
     delete_pipeline();
 }
 
+z_stream* HttpFlowData::get_compress_stream(int window_bits)
+{
+    while (compress_pool_count > 0)
+    {
+        z_stream* compress_stream = compress_pool[--compress_pool_count];
+        if (inflateReset2(compress_stream, window_bits) == Z_OK)
+            return compress_stream;
+        inflateEnd(compress_stream);
+        delete compress_stream;
+    }
+
+    z_stream* compress_stream = new z_stream;
+    compress_stream->zalloc = Z_NULL;
+    compress_stream->zfree = Z_NULL;
+    compress_stream->next_in = Z_NULL;
+    compress_stream->avail_in = 0;
+    if (inflateInit2(compress_stream, window_bits) != Z_OK)
+    {
+        delete compress_stream;
+        return nullptr;
+    }
+    return compress_stream;
+}
+
+void HttpFlowData::release_compress_stream(z_stream*& compress_stream)
+{
+    if (compress_stream == nullptr)
+        return;
+    if (compress_pool_count < COMPRESS_POOL_SIZE)
+        compress_pool[compress_pool_count++] = compress_stream;
+    else
+    {
+        inflateEnd(compress_stream);
+        delete compress_stream;
+    }
+    compress_stream = nullptr;
+}
+
+void HttpFlowData::term_compress_pool()
+{
+    while (compress_pool_count > 0)
+    {
+        z_stream* compress_stream = compress_pool[--compress_pool_count];
+        inflateEnd(compress_stream);
+        delete compress_stream;
+    }
+}
+
 void HttpFlowData::half_reset(SourceId source_id)
 {
     assert((source_id == SRC_CLIENT) || (source_id == SRC_SERVER));
@@ -107,12 +160,7 @@ void HttpFlowData::half_reset(SourceId source_id)
     detection_status[source_id] = DET_REACTIVATING;
 
     compression[source_id] = CMP_NONE;
-    if (compress_stream[source_id] != nullptr)
-    {
-        inflateEnd(compress_stream[source_id]);
-        delete compress_stream[source_id];
-        compress_stream[source_id] = nullptr;
-    }
+    release_compress_stream(compress_stream[source_id]);
     if (mime_state[source_id] != nullptr)
     {
         delete mime_state[source_id];
@@ -145,6 +193,8 @@ void HttpFlowData::half_reset(SourceId source_id)
             File_Decomp_StopFree(fd_state);
             fd_state = nullptr;
         }
+        delete js_norm_state;
+        js_norm_state = nullptr;
     }
 }
 
@@ -152,12 +202,7 @@ void HttpFlowData::trailer_prep(SourceId source_id)
 {
     type_expected[source_id] = SEC_TRAILER;
     compression[source_id] = CMP_NONE;
-    if (compress_stream[source_id] != nullptr)
-    {
-        inflateEnd(compress_stream[source_id]);
-        delete compress_stream[source_id];
-        compress_stream[source_id] = nullptr;
-    }
+    release_compress_stream(compress_stream[source_id]);
     detection_status[source_id] = DET_REACTIVATING;
 }
 
@@ -33,6 +33,7 @@
 #include "http_infractions.h"
 #include "http_event_gen.h"
 
+struct JSState;
 class HttpTransaction;
 class HttpJsNorm;
 class HttpMsgSection;
@@ -45,6 +46,12 @@ public:
     static unsigned inspector_id;
     static void init() { inspector_id = snort::FlowData::create_flow_data_id(); }
 
+    // Inflate streams are taken from a small per thread pool when a compressed message body
+    // starts and returned when it ends, so idle flows do not hold zlib state and window memory
+    static z_stream* get_compress_stream(int window_bits);
+    static void release_compress_stream(z_stream*& compress_stream);
+    static void term_compress_pool();
+
     friend class HttpInspect;
     friend class HttpMsgSection;
     friend class HttpMsgStart;
@@ -140,6 +147,7 @@ private:
         HttpEventGen* events = nullptr;
     };
     FdCallbackContext fd_alert_context; // SRC_SERVER only
+    JSState* js_norm_state = nullptr; // SRC_SERVER only
     uint64_t expected_trans_num[2] = { 1, 1 };
     HttpMsgSection* latest_section = nullptr;
 
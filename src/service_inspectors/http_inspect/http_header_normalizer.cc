@@ -66,7 +66,8 @@ static int32_t derive_header_content(const uint8_t* value, int32_t length, uint8
 // This method normalizes the header field value for headId.
 void HeaderNormalizer::normalize(const HeaderId head_id, const int count,
     HttpInfractions* infractions, HttpEventGen* events, const HeaderId header_name_id[],
-    const Field header_value[], const int32_t num_headers, Field& result_field) const
+    const Field header_value[], const int32_t num_headers, Field& result_field,
+    HttpArena* arena) const
 {
     if (result_field.length() != STAT_NOT_COMPUTE)
     {
@@ -108,8 +109,8 @@ void HeaderNormalizer::normalize(const HeaderId head_id, const int count,
     // number of normalization functions is odd or even, the initial buffer is chosen so that the
     // final normalization leaves the normalized header value in norm_value.
 
-    uint8_t* const norm_value = new uint8_t[buffer_length];
-    uint8_t* const temp_space = new uint8_t[buffer_length];
+    uint8_t* const norm_value = arena->allocate(buffer_length);
+    uint8_t* const temp_space = arena->allocate(buffer_length);
     uint8_t* const norm_start = (num_normalizers%2 == 0) ? norm_value : temp_space;
     uint8_t* working = norm_start;
     int32_t data_length = 0;
@@ -163,7 +164,6 @@ void HeaderNormalizer::normalize(const HeaderId head_id, const int count,
             data_length = normalizer[i](norm_value, data_length, temp_space, infractions, events);
         }
     }
-    delete[] temp_space;
-    result_field.set(data_length, norm_value, true);
+    result_field.set(data_length, norm_value);
 }
 
@@ -23,7 +23,9 @@
 
 #include "http_js_norm.h"
 
-#include "utils/util_jsnorm.h"
+#include <algorithm>
+#include <strings.h>
+
 #include "utils/safec.h"
 
 using namespace HttpEnums;
@@ -71,20 +73,112 @@ void HttpJsNorm::configure()
     htmltype_search_mpse->prep();
 }
 
+void HttpJsNorm::init_state(JSState& js) const
+{
+    js = JSState();
+    js.allowed_spaces = max_javascript_whitespaces;
+    js.allowed_levels = MAX_ALLOWED_OBFUSCATION;
+    js.alerts = 0;
+}
+
+// A script tag that was cut off at the end of the last section is completed with the start of
+// this one. Its bytes were already passed through as HTML so only the type and the location of
+// the closing '>' in this section are needed.
+HttpJsNorm::TagResult HttpJsNorm::finish_tag(const char* ptr, const char* end, JSState& js,
+    const char*& angle_bracket) const
+{
+    const unsigned saved = js.tag_len;
+    const unsigned added = std::min((unsigned)(end - ptr), (unsigned)sizeof(js.tag) - saved);
+    const unsigned length = saved + added;
+
+    memcpy(js.tag + saved, ptr, added);
+    js.tag_len = 0;
+
+    if (strncasecmp(js.tag, script_start, std::min(length, (unsigned)script_start_length)) != 0)
+        return TAG_NONE;
+
+    const char* const tag_end = (length > saved) ?
+        (const char*)memchr(js.tag + saved, '>', added) : nullptr;
+
+    if (tag_end == nullptr)
+    {
+        // Still cut off. Keep waiting unless the tag is too long to hold.
+        if ((added < (unsigned)(end - ptr)) || (length == sizeof(js.tag)))
+            return TAG_NONE;
+        js.tag_len = length;
+        return TAG_PARTIAL;
+    }
+
+    angle_bracket = ptr + (tag_end - (js.tag + saved));
+
+    if (length < (unsigned)script_start_length)
+        return TAG_NONE;
+
+    int mid;
+    if (htmltype_search_mpse->find(js.tag, tag_end - js.tag, search_html_found, false, &mid) > 0)
+        return (mid == HTML_JS) ? TAG_JS : TAG_OTHER;
+
+    // if no type or language is found we assume it is a javascript
+    return TAG_JS;
+}
+
+// Save what could be the start of a script tag at the end of a section
+void HttpJsNorm::save_tag(const char* start, const char* end, JSState& js)
+{
+    if ((end - start) <= (int)sizeof(js.tag))
+    {
+        memcpy(js.tag, start, end - start);
+        js.tag_len = end - start;
+    }
+}
+
+// The normalizer state belongs to the flow. A script that is still open at the end of one body
+// section is resumed at the start of the next one instead of being treated as plain HTML. So is a
+// script tag that is cut off. The output buffer comes from the transaction's body arena and must
+// hold at least input.length() octets.
 void HttpJsNorm::normalize(const Field& input, Field& output, HttpInfractions* infractions,
-    HttpEventGen* events) const
+    HttpEventGen* events, JSState& js, uint8_t* buffer) const
 {
     bool js_present = false;
     int index = 0;
     const char* ptr = (const char*)input.start();
     const char* const end = ptr + input.length();
 
-    JSState js;
-    js.allowed_spaces = max_javascript_whitespaces;
-    js.allowed_levels = MAX_ALLOWED_OBFUSCATION;
     js.alerts = 0;
 
-    uint8_t* buffer = new uint8_t[input.length()];
+    if ((js.tag_len > 0) && (ptr < end))
+    {
+        const char* angle_bracket = nullptr;
+        const TagResult tag = finish_tag(ptr, end, js, angle_bracket);
+
+        if (tag == TAG_PARTIAL)
+            ptr = end;
+
+        else if (angle_bracket != nullptr)
+        {
+            memmove_s(buffer, input.length(), ptr, angle_bracket - ptr);
+            index += angle_bracket - ptr;
+            ptr = angle_bracket;
+
+            if (tag == TAG_JS)
+            {
+                int bytes_copied = 0;
+                js_present = true;
+                JSNormalizeDecode(ptr, (uint16_t)(end-ptr), (char*)buffer+index,
+                    (uint16_t)(input.length() - index), &ptr, &bytes_copied, &js,
+                    uri_param.iis_unicode ? uri_param.unicode_map : nullptr);
+                index += bytes_copied;
+            }
+        }
+    }
+    else if (js.script_open && (ptr < end))
+    {
+        int bytes_copied = 0;
+        js_present = true;
+        JSNormalizeDecode(ptr, (uint16_t)(end-ptr), (char*)buffer, (uint16_t)input.length(),
+            &ptr, &bytes_copied, &js, uri_param.iis_unicode ? uri_param.unicode_map : nullptr);
+        index += bytes_copied;
+    }
 
     while (ptr < end)
     {
@@ -95,9 +189,13 @@ void HttpJsNorm::normalize(const Field& input, Field& output, HttpInfractions* i
         if (javascript_search_mpse->find(ptr, end-ptr, search_js_found, false, &mindex) > 0)
         {
             const char* js_start = ptr + mindex;
-            const char* const angle_bracket = (const char*)SnortStrnStr(js_start, end - js_start, ">");
+            // SnortStrnStr() skips the last octet and would miss a tag that ends the section
+            const char* const angle_bracket = (const char*)memchr(js_start, '>', end - js_start);
             if (angle_bracket == nullptr)
+            {
+                save_tag(js_start, end, js);
                 break;
+            }
 
             bool type_js = false;
             if (angle_bracket > js_start)
@@ -147,7 +245,18 @@ void HttpJsNorm::normalize(const Field& input, Field& output, HttpInfractions* i
             index += bytes_copied;
         }
         else
+        {
+            // The section may end partway through "<SCRIPT"
+            for (int k = std::min((int)(end - ptr), script_start_length - 1); k > 0; k--)
+            {
+                if (strncasecmp(end - k, script_start, k) == 0)
+                {
+                    save_tag(end - k, end, js);
+                    break;
+                }
+            }
             break;
+        }
     }
 
     if (js_present)
@@ -174,13 +283,10 @@ void HttpJsNorm::normalize(const Field& input, Field& output, HttpInfractions* i
                 events->create_event(EVENT_MIXED_ENCODINGS);
             }
         }
-        output.set(index, buffer, true);
+        output.set(index, buffer);
     }
     else
-    {
-        delete[] buffer;
         output.set(input);
-    }
 }
 
 /* Returning non-zero stops search, which is okay since we only look for one at a time */
@@ -23,6 +23,7 @@
 #include <cstring>
 
 #include "search_engines/search_tool.h"
+#include "utils/util_jsnorm.h"
 
 #include "http_field.h"
 #include "http_event_gen.h"
@@ -39,11 +40,17 @@ public:
     HttpJsNorm(int max_javascript_whitespaces_, const HttpParaList::UriParam& uri_param_);
     ~HttpJsNorm();
     void normalize(const Field& input, Field& output, HttpInfractions* infractions,
-        HttpEventGen* events) const;
+        HttpEventGen* events, JSState& js, uint8_t* buffer) const;
+    void init_state(JSState& js) const;
     void configure();
 private:
     enum JsSearchId { JS_JAVASCRIPT };
     enum HtmlSearchId { HTML_JS, HTML_EMA, HTML_VB };
+    enum TagResult { TAG_NONE, TAG_PARTIAL, TAG_OTHER, TAG_JS };
+
+    TagResult finish_tag(const char* ptr, const char* end, JSState& js,
+        const char*& angle_bracket) const;
+    static void save_tag(const char* start, const char* end, JSState& js);
 
     static constexpr const char* script_start = "<SCRIPT";
     static constexpr int script_start_length = sizeof("<SCRIPT") - 1;
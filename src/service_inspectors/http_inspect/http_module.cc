@@ -88,9 +88,25 @@ const Parameter HttpModule::http_params[] =
 };
 
 THREAD_LOCAL ProfileStats HttpModule::http_profile;
+THREAD_LOCAL ProfileStats HttpModule::http_inflate_profile;
 
-ProfileStats* HttpModule::get_profile() const
-{ return &http_profile; }
+ProfileStats* HttpModule::get_profile(unsigned index, const char*& name, const char*& parent) const
+{
+    switch (index)
+    {
+    case 0:
+        name = HTTP_NAME;
+        parent = nullptr;
+        return &http_profile;
+
+    case 1:
+        // Decompression happens during reassembly, not under http_inspect eval()
+        name = "http_inspect_inflate";
+        parent = nullptr;
+        return &http_inflate_profile;
+    }
+    return nullptr;
+}
 
 THREAD_LOCAL PegCount HttpModule::peg_counts[PEG_COUNT_MAX] = { 0 };
 
@@ -106,15 +106,19 @@ public:
     PegCount* get_counts() const override { return peg_counts; }
     static void increment_peg_counts(HttpEnums::PEG_COUNT counter)
         { peg_counts[counter]++; }
+    static void increment_peg_counts(HttpEnums::PEG_COUNT counter, PegCount amount)
+        { peg_counts[counter] += amount; }
     static void decrement_peg_counts(HttpEnums::PEG_COUNT counter)
         { peg_counts[counter]--; }
     static PegCount get_peg_counts(HttpEnums::PEG_COUNT counter)
         { return peg_counts[counter]; }
 
-    snort::ProfileStats* get_profile() const override;
+    snort::ProfileStats* get_profile(unsigned, const char*&, const char*&) const override;
 
     static snort::ProfileStats& get_profile_stats()
     { return http_profile; }
+    static snort::ProfileStats& get_inflate_profile_stats()
+    { return http_inflate_profile; }
 
     Usage get_usage() const override
     { return INSPECT; }
@@ -134,6 +138,7 @@ private:
     HttpParaList* params = nullptr;
     static const PegInfo peg_names[];
     static THREAD_LOCAL snort::ProfileStats http_profile;
+    static THREAD_LOCAL snort::ProfileStats http_inflate_profile;
     static THREAD_LOCAL PegCount peg_counts[];
 };
 
@@ -83,26 +83,22 @@ void HttpMsgBody::do_utf_decoding(const Field& input, Field& output)
     {
         int bytes_copied;
         bool decoded;
-        uint8_t* buffer = new uint8_t[input.length()];
+        uint8_t* buffer = transaction->get_body_arena()->allocate(input.length());
         decoded = session_data->utf_state->decode_utf(
             input.start(), input.length(), buffer, input.length(), &bytes_copied);
 
         if (!decoded)
         {
-            delete[] buffer;
             output.set(input);
             add_infraction(INF_UTF_NORM_FAIL);
             create_event(EVENT_UTF_NORM_FAIL);
         }
         else if (bytes_copied > 0)
         {
-            output.set(bytes_copied, buffer, true);
+            output.set(bytes_copied, buffer);
         }
         else
-        {
-            delete[] buffer;
             output.set(input);
-        }
     }
 
     else
@@ -116,7 +112,7 @@ void HttpMsgBody::do_pdf_swf_decompression(const Field& input, Field& output)
         output.set(input);
         return;
     }
-    uint8_t* buffer = new uint8_t[MAX_OCTETS];
+    uint8_t* buffer = transaction->get_body_arena()->allocate(MAX_OCTETS);
     session_data->fd_alert_context.infractions = transaction->get_infractions(source_id);
     session_data->fd_alert_context.events = transaction->get_events(source_id);
     session_data->fd_state->Next_In = input.start();
@@ -133,7 +129,6 @@ void HttpMsgBody::do_pdf_swf_decompression(const Field& input, Field& output)
         // Fall through
     case File_Decomp_NoSig:
     case File_Decomp_Error:
-        delete[] buffer;
         output.set(input);
         File_Decomp_StopFree(session_data->fd_state);
         session_data->fd_state = nullptr;
@@ -143,7 +138,7 @@ void HttpMsgBody::do_pdf_swf_decompression(const Field& input, Field& output)
         create_event(EVENT_PDF_SWF_OVERRUN);
         // Fall through
     default:
-        output.set(session_data->fd_state->Next_Out - buffer, buffer, true);
+        output.set(session_data->fd_state->Next_Out - buffer, buffer);
         break;
     }
 }
@@ -192,8 +187,18 @@ void HttpMsgBody::do_js_normalization(const Field& input, Field& output)
         return;
     }
 
+    if (session_data->js_norm_state == nullptr)
+    {
+        session_data->js_norm_state = new JSState;
+        params->js_norm_param.js_norm->init_state(*session_data->js_norm_state);
+    }
+
+    // The normalized script is never longer than the input
+    uint8_t* buffer = transaction->get_body_arena()->allocate(input.length());
+
     params->js_norm_param.js_norm->normalize(input, output,
-        transaction->get_infractions(source_id), transaction->get_events(source_id));
+        transaction->get_infractions(source_id), transaction->get_events(source_id),
+        *session_data->js_norm_state, buffer);
 }
 
 void HttpMsgBody::do_file_processing(Field& file_data)
@@ -272,7 +277,8 @@ void HttpMsgBody::do_file_processing(Field& file_data)
 
 const Field& HttpMsgBody::get_classic_client_body()
 {
-    return classic_normalize(detect_data, classic_client_body, params->uri_param);
+    return classic_normalize(detect_data, classic_client_body, params->uri_param,
+        transaction->get_body_arena());
 }
 
 #ifdef REG_TEST
@@ -208,7 +208,7 @@ void HttpMsgHeadShared::derive_header_name_id(int index)
 
     // Normalize header field name to lower case and remove LWS for matching purposes
     int32_t lower_length = 0;
-    uint8_t* lower_name = new uint8_t[length];
+    uint8_t* lower_name = transaction->get_arena()->allocate(length);
     for (int32_t k=0; k < length; k++)
     {
         if (!is_sp_tab_cr_lf[buffer[k]])
@@ -228,7 +228,6 @@ void HttpMsgHeadShared::derive_header_name_id(int index)
         }
     }
     header_name_id[index] = (HeaderId)str_to_code(lower_name, lower_length, header_list);
-    delete[] lower_name;
 }
 
 HttpMsgHeadShared::NormalizedHeader* HttpMsgHeadShared::get_header_node(HeaderId header_id) const
@@ -274,7 +273,7 @@ const Field& HttpMsgHeadShared::get_classic_raw_header()
     }
 
     // Step through headers again and do the copying this time
-    uint8_t* const buffer = new uint8_t[length];
+    uint8_t* const buffer = transaction->get_arena()->allocate(length);
     int32_t current = 0;
     for (int k = 0; k < num_headers; k++)
     {
@@ -287,13 +286,14 @@ const Field& HttpMsgHeadShared::get_classic_raw_header()
     }
     assert(current == length);
 
-    classic_raw_header.set(length, buffer, true);
+    classic_raw_header.set(length, buffer);
     return classic_raw_header;
 }
 
 const Field& HttpMsgHeadShared::get_classic_norm_header()
 {
-    return classic_normalize(get_classic_raw_header(), classic_norm_header, params->uri_param);
+    return classic_normalize(get_classic_raw_header(), classic_norm_header, params->uri_param,
+        transaction->get_arena());
 }
 
 const Field& HttpMsgHeadShared::get_classic_raw_cookie()
@@ -304,7 +304,8 @@ const Field& HttpMsgHeadShared::get_classic_raw_cookie()
 
 const Field& HttpMsgHeadShared::get_classic_norm_cookie()
 {
-    return classic_normalize(get_classic_raw_cookie(), classic_norm_cookie, params->uri_param);
+    return classic_normalize(get_classic_raw_cookie(), classic_norm_cookie, params->uri_param,
+        transaction->get_arena());
 }
 
 const Field& HttpMsgHeadShared::get_header_value_raw(HeaderId header_id) const
@@ -330,7 +331,7 @@ const Field& HttpMsgHeadShared::get_header_value_norm(HeaderId header_id)
         return Field::FIELD_NULL;
     header_norms[header_id]->normalize(header_id, node->count,
         transaction->get_infractions(source_id), transaction->get_events(source_id),
-        header_name_id, header_value, num_headers, node->norm);
+        header_name_id, header_value, num_headers, node->norm, transaction->get_arena());
     return node->norm;
 }
 
@@ -100,13 +100,12 @@ const Field& HttpMsgHeader::get_true_ip_addr()
     }
 
     // Need a temporary copy so we can add null termination
-    uint8_t* addr_str = new uint8_t[true_ip.length()+1];
+    uint8_t* addr_str = transaction->get_arena()->allocate(true_ip.length()+1);
     memcpy(addr_str, true_ip.start(), true_ip.length());
     addr_str[true_ip.length()] = '\0';
 
     SfIp tmp_sfip;
     const SfIpRet status = tmp_sfip.set((char*)addr_str);
-    delete[] addr_str;
     if (status != SFIP_SUCCESS)
     {
         true_ip_addr.set(STAT_PROBLEMATIC);
@@ -114,9 +113,10 @@ const Field& HttpMsgHeader::get_true_ip_addr()
     else
     {
         const size_t addr_length = (tmp_sfip.is_ip6() ? 4 : 1);
-        uint32_t* const addr_buf = new uint32_t[addr_length];
+        uint8_t* const addr_buf =
+            transaction->get_arena()->allocate(addr_length * sizeof(uint32_t));
         memcpy(addr_buf, tmp_sfip.get_ptr(), addr_length * sizeof(uint32_t));
-        true_ip_addr.set(addr_length * sizeof(uint32_t), (uint8_t*)addr_buf, true);
+        true_ip_addr.set(addr_length * sizeof(uint32_t), addr_buf);
     }
     return true_ip_addr;
 }
@@ -416,18 +416,15 @@ void HttpMsgHeader::setup_encoding_decompression()
     if (compression == CMP_NONE)
         return;
 
-    session_data->compress_stream[source_id] = new z_stream;
-    session_data->compress_stream[source_id]->zalloc = Z_NULL;
-    session_data->compress_stream[source_id]->zfree = Z_NULL;
-    session_data->compress_stream[source_id]->next_in = Z_NULL;
-    session_data->compress_stream[source_id]->avail_in = 0;
     const int window_bits = (compression == CMP_GZIP) ? GZIP_WINDOW_BITS : DEFLATE_WINDOW_BITS;
-    if (inflateInit2(session_data->compress_stream[source_id], window_bits) != Z_OK)
+    HttpFlowData::release_compress_stream(session_data->compress_stream[source_id]);
+    session_data->compress_stream[source_id] = HttpFlowData::get_compress_stream(window_bits);
+    if (session_data->compress_stream[source_id] == nullptr)
     {
-        session_data->compression[source_id] = CMP_NONE;
-        delete session_data->compress_stream[source_id];
-        session_data->compress_stream[source_id] = nullptr;
+        compression = CMP_NONE;
+        return;
     }
+    HttpModule::increment_peg_counts(PEG_COMPRESSED_BODIES);
 }
 
 void HttpMsgHeader::setup_utf_decoding()
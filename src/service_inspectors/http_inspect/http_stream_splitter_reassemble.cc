@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include "profiler/profiler.h"
 #include "protocols/packet.h"
 
 #include "http_inspect.h"
@@ -138,11 +139,13 @@ void HttpStreamSplitter::chunk_spray(HttpFlowData* session_data, uint8_t* buffer
 }
 
 void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, const uint8_t* data,
-    uint32_t length, HttpEnums::CompressId& compression, z_stream*& compress_stream,
+    uint32_t length, HttpEnums::CompressId& compression, z_stream* compress_stream,
     bool at_start, HttpInfractions* infractions, HttpEventGen* events)
 {
     if ((compression == CMP_GZIP) || (compression == CMP_DEFLATE))
     {
+        snort::Profile profile(HttpModule::get_inflate_profile_stats());
+
         compress_stream->next_in = const_cast<Bytef*>(data);
         compress_stream->avail_in = length;
         compress_stream->next_out = buffer + offset;
@@ -151,6 +154,10 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
 
         if ((ret_val == Z_OK) || (ret_val == Z_STREAM_END))
         {
+            HttpModule::increment_peg_counts(PEG_COMPRESSED_OCTETS,
+                length - compress_stream->avail_in);
+            HttpModule::increment_peg_counts(PEG_DECOMPRESSED_OCTETS,
+                (MAX_OCTETS - compress_stream->avail_out) - offset);
             offset = MAX_OCTETS - compress_stream->avail_out;
             if (compress_stream->avail_in > 0)
             {
@@ -173,10 +180,8 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
                     *infractions += INF_GZIP_OVERRUN;
                     events->create_event(EVENT_GZIP_OVERRUN);
                 }
+                // The stream is kept for the next compressed message on this flow
                 compression = CMP_NONE;
-                inflateEnd(compress_stream);
-                delete compress_stream;
-                compress_stream = nullptr;
             }
             return;
         }
@@ -201,9 +206,6 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
             *infractions += INF_GZIP_FAILURE;
             events->create_event(EVENT_GZIP_FAILURE);
             compression = CMP_NONE;
-            inflateEnd(compress_stream);
-            delete compress_stream;
-            compress_stream = nullptr;
             // Since we failed to uncompress the data, fall through
         }
     }
@@ -417,6 +417,9 @@ const PegInfo HttpModule::peg_names[PEG_COUNT_MAX+1] =
     { CountType::SUM, "uri_coding", "URIs with character coding problems" },
     { CountType::NOW, "concurrent_sessions", "total concurrent http sessions" },
     { CountType::MAX, "max_concurrent_sessions", "maximum concurrent http sessions" },
+    { CountType::SUM, "compressed_bodies", "gzip or deflate message bodies decompressed" },
+    { CountType::SUM, "compressed_octets", "compressed message body octets fed to inflate" },
+    { CountType::SUM, "decompressed_octets", "message body octets produced by inflate" },
     { CountType::END, nullptr, nullptr }
 };
 
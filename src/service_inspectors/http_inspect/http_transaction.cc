@@ -188,6 +188,7 @@ void HttpTransaction::set_body(HttpMsgBody* latest_body_)
 {
     delete latest_body;
     latest_body = latest_body_;
+    body_arena.reset();
 }
 
 HttpInfractions* HttpTransaction::get_infractions(HttpEnums::SourceId source_id)
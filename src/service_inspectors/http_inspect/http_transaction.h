@@ -20,6 +20,7 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include "http_arena.h"
 #include "http_enum.h"
 #include "http_flow_data.h"
 
@@ -64,6 +65,11 @@ public:
     void set_one_hundred_response();
     bool final_response() const { return !second_response_expected; }
 
+    // Buffers for the start line, headers, and trailers live as long as the transaction. Body
+    // buffers only live as long as the current body section.
+    HttpArena* get_arena() { return &arena; }
+    HttpArena* get_body_arena() { return &body_arena; }
+
 private:
     HttpTransaction() = default;
     ~HttpTransaction();
@@ -75,6 +81,12 @@ private:
     HttpMsgBody* latest_body = nullptr;
     HttpInfractions* infractions[2] = { nullptr, nullptr };
     HttpEventGen* events[2] = { nullptr, nullptr };
+    HttpArena arena;
+
+    // Body normalization asks for whole MAX_OCTETS sections so body blocks are sized to hold one.
+    // A response section needs at most three of them: UTF decoding, decompression, and
+    // JavaScript normalization. A request section needs one for the normalized client body.
+    HttpArena body_arena { HttpEnums::MAX_OCTETS, 3 };
 
     bool response_seen = false;
     bool one_hundred_response = false;
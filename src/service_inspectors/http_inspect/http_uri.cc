@@ -218,7 +218,7 @@ void HttpUri::normalize()
 
     // Create a new buffer containing the normalized URI by normalizing each individual piece.
     const uint32_t total_length = uri.length() + UriNormalizer::URI_NORM_EXPANSION;
-    uint8_t* const new_buf = new uint8_t[total_length];
+    uint8_t* const new_buf = arena->allocate(total_length);
     uint8_t* current = new_buf;
     if (scheme.length() >= 0)
     {
@@ -307,7 +307,7 @@ void HttpUri::normalize()
 
     check_oversize_dir(path_norm);
 
-    classic_norm.set(current - new_buf, new_buf, true);
+    classic_norm.set(current - new_buf, new_buf);
 }
 
 size_t HttpUri::get_file_proc_hash()
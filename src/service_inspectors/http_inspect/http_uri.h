@@ -20,6 +20,7 @@
 #ifndef HTTP_URI_H
 #define HTTP_URI_H
 
+#include "http_arena.h"
 #include "http_str_to_code.h"
 #include "http_module.h"
 #include "http_uri_norm.h"
@@ -36,9 +37,9 @@ class HttpUri
 public:
     HttpUri(const uint8_t* start, int32_t length, HttpEnums::MethodId method_id_,
         const HttpParaList::UriParam& uri_param_, HttpInfractions* infractions_,
-        HttpEventGen* events_) :
+        HttpEventGen* events_, HttpArena* arena_) :
         uri(length, start), method_id(method_id_), uri_param(uri_param_),
-        infractions(infractions_), events(events_)
+        infractions(infractions_), events(events_), arena(arena_)
         { normalize(); }
     const Field& get_uri() const { return uri; }
     HttpEnums::UriType get_uri_type() { return uri_type; }
@@ -64,6 +65,7 @@ private:
     const HttpParaList::UriParam& uri_param;
     HttpInfractions* infractions;
     HttpEventGen* events;
+    HttpArena* const arena;
 
     Field scheme;
     Field authority;
@@ -448,7 +448,7 @@ int32_t UriNormalizer::norm_path_clean(uint8_t* buf, const int32_t in_length,
 
 // Provide traditional URI-style normalization for buffers that usually are not URIs
 void UriNormalizer::classic_normalize(const Field& input, Field& result,
-    const HttpParaList::UriParam& uri_param)
+    const HttpParaList::UriParam& uri_param, HttpArena* arena)
 {
     // The requirements for generating events related to these normalizations are unclear. It
     // definitely doesn't seem right to generate standard URI events. For now we won't generate
@@ -462,7 +462,7 @@ void UriNormalizer::classic_normalize(const Field& input, Field& result,
     HttpInfractions unused;
     HttpDummyEventGen dummy_ev;
 
-    uint8_t* const buffer = new uint8_t[input.length() + URI_NORM_EXPANSION];
+    uint8_t* const buffer = arena->allocate(input.length() + URI_NORM_EXPANSION);
 
     // Normalize character escape sequences
     int32_t data_length = norm_char_clean(input, buffer, uri_param, &unused, &dummy_ev);
@@ -482,7 +482,7 @@ void UriNormalizer::classic_normalize(const Field& input, Field& result,
         }
     }
 
-    result.set(data_length, buffer, true);
+    result.set(data_length, buffer);
 }
 
 bool UriNormalizer::classic_need_norm(const Field& uri_component, bool do_path,
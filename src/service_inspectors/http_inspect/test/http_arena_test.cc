@@ -0,0 +1,121 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http_arena_test.cc unit test main
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "service_inspectors/http_inspect/http_arena.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+TEST_GROUP(http_arena_test)
+{
+    HttpArena arena;
+};
+
+TEST(http_arena_test, small_allocations_share_block)
+{
+    uint8_t* const first = arena.allocate(10);
+    uint8_t* const second = arena.allocate(20);
+    CHECK(first != nullptr);
+    CHECK(second != nullptr);
+    CHECK(second >= first + 10);
+    CHECK(((uintptr_t)second % 8) == 0);
+    CHECK(arena.get_num_blocks() == 1);
+    memset(first, 'a', 10);
+    memset(second, 'b', 20);
+    CHECK(first[9] == 'a');
+}
+
+TEST(http_arena_test, large_allocation)
+{
+    uint8_t* const big = arena.allocate(100000);
+    CHECK(big != nullptr);
+    memset(big, 0, 100000);
+    CHECK(arena.get_num_blocks() == 1);
+    CHECK(arena.get_block_bytes() >= 100000);
+}
+
+TEST(http_arena_test, reset_reuses_blocks)
+{
+    uint8_t* const first = arena.allocate(6000);
+    arena.allocate(6000);
+    arena.allocate(70000);
+    const uint32_t blocks = arena.get_num_blocks();
+    const uint64_t bytes = arena.get_block_bytes();
+
+    arena.reset();
+    CHECK(arena.allocate(6000) == first);
+    arena.allocate(6000);
+    arena.allocate(70000);
+    CHECK(arena.get_num_blocks() == blocks);
+    CHECK(arena.get_block_bytes() == bytes);
+}
+
+TEST(http_arena_test, reset_frees_excess_blocks)
+{
+    for (int k = 0; k < 10; k++)
+        arena.allocate(5000);
+    arena.allocate(100000);
+    CHECK(arena.get_num_blocks() == 11);
+
+    arena.reset();
+    CHECK(arena.get_num_blocks() == 4);
+    CHECK(arena.get_block_bytes() == 4 * 8192);
+}
+
+TEST(http_arena_test, large_allocation_keeps_current_tail)
+{
+    uint8_t* const first = arena.allocate(16);
+    arena.allocate(50000);
+    uint8_t* const second = arena.allocate(16);
+    CHECK(second == first + 16);
+    CHECK(arena.get_num_blocks() == 2);
+}
+
+TEST(http_arena_test, body_sized_blocks_kept)
+{
+    HttpArena body_arena(63780, 2);
+    uint8_t* const first = body_arena.allocate(63780);
+    uint8_t* const second = body_arena.allocate(1000);
+    CHECK(body_arena.get_num_blocks() == 2);
+
+    body_arena.reset();
+    CHECK(body_arena.get_num_blocks() == 2);
+    CHECK(body_arena.allocate(63780) == first);
+    CHECK(body_arena.allocate(1000) == second);
+    CHECK(body_arena.get_num_blocks() == 2);
+}
+
+TEST(http_arena_test, zero_length)
+{
+    uint8_t* const first = arena.allocate(0);
+    uint8_t* const second = arena.allocate(0);
+    CHECK(first != second);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
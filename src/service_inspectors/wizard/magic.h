@@ -24,6 +24,7 @@
 #include <vector>
 
 class MagicBook;
+class SpellFilter;
 
 struct MagicPage
 {
@@ -54,6 +55,10 @@ public:
     virtual bool add_spell(const char* key, const char* val) = 0;
     virtual const char* find_spell(const uint8_t*, unsigned len, const MagicPage*&) const = 0;
 
+    // optional accelerator; false if not supported by this book
+    virtual bool compile()
+    { return false; }
+
     const MagicPage* page1()
     { return root; }
 
@@ -71,14 +76,20 @@ class SpellBook : public MagicBook
 {
 public:
     SpellBook();
+    ~SpellBook() override;
 
     bool add_spell(const char*, const char*) override;
     const char* find_spell(const uint8_t*, unsigned len, const MagicPage*&) const override;
 
+    bool compile() override;
+
 private:
     bool translate(const char*, HexVector&);
     void add_spell(const char*, const char*, HexVector&, unsigned, MagicPage*);
     const MagicPage* find_spell(const uint8_t*, unsigned, const MagicPage*, unsigned) const;
+
+    std::vector<HexVector> spells;
+    SpellFilter* filter = nullptr;
 };
 
 //-------------------------------------------------------------------------
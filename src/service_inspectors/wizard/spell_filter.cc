@@ -0,0 +1,161 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// spell_filter.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "spell_filter.h"
+
+#include <hs_compile.h>
+#include <hs_runtime.h>
+
+#include <cstdio>
+#include <set>
+#include <string>
+
+#include "log/messages.h"
+#include "main/thread.h"
+#include "main/thread_config.h"
+
+using namespace std;
+
+#define WILD 0x100
+
+//-------------------------------------------------------------------------
+// the trie returns a page iff the (truncated) data either starts with a
+// complete spell or is entirely consumed by a prefix of a spell.  so each
+// spell yields one pattern anchored at the start only plus one pattern
+// per proper prefix anchored at both ends.  leading whitespace is skipped
+// at the root, including leading whitespace in the spell itself.
+//-------------------------------------------------------------------------
+
+static const char* s_lead = "^[\\t\\n\\r ]*";
+
+static void add_token(string& s, uint16_t c)
+{
+    if ( c == WILD )
+    {
+        s += ".*";
+        return;
+    }
+    char buf[8];
+    snprintf(buf, sizeof(buf), "\\x%02X", c);
+    s += buf;
+}
+
+static bool is_space(uint16_t c)
+{ return c == ' ' or c == '\t' or c == '\r' or c == '\n'; }
+
+SpellFilter::~SpellFilter()
+{
+    for ( auto* ss : scratch )
+    {
+        if ( ss )
+            hs_free_scratch(ss);
+    }
+
+    if ( db )
+        hs_free_database(db);
+}
+
+bool SpellFilter::compile(const vector<HexVector>& spells)
+{
+    if ( spells.empty() or hs_valid_platform() != HS_SUCCESS )
+        return false;
+
+    set<string> pats;
+    pats.insert(string("^[\\t\\n\\r ]+\\z"));
+
+    for ( const auto& hv : spells )
+    {
+        unsigned i = 0;
+
+        while ( i < hv.size() and is_space(hv[i]) )
+            ++i;
+
+        // anything could lead to a page so there is nothing to filter
+        if ( i == hv.size() or hv[i] == WILD )
+            return false;
+
+        string s = s_lead;
+
+        for ( ; i < hv.size(); ++i )
+        {
+            add_token(s, hv[i]);
+            pats.insert(s + (i + 1 < hv.size() ? "\\z" : ""));
+        }
+    }
+
+    vector<const char*> exprs;
+    vector<unsigned> flags;
+
+    for ( const auto& p : pats )
+    {
+        exprs.push_back(p.c_str());
+        flags.push_back(HS_FLAG_CASELESS | HS_FLAG_DOTALL | HS_FLAG_SINGLEMATCH);
+    }
+
+    hs_compile_error_t* err = nullptr;
+
+    if ( hs_compile_multi(&exprs[0], &flags[0], nullptr, exprs.size(), HS_MODE_BLOCK,
+        nullptr, &db, &err) or !db )
+    {
+        ParseWarning(WARN_CONF, "wizard: can't compile spell filter (%s); using trie",
+            err ? err->message : "unknown");
+        hs_free_compile_error(err);
+        db = nullptr;
+        return false;
+    }
+
+    // like hyperscan mpse, the prototype is only used to make the clones
+    hs_scratch_t* proto = nullptr;
+
+    if ( hs_alloc_scratch(db, &proto) != HS_SUCCESS )
+    {
+        ParseWarning(WARN_CONF, "wizard: can't allocate spell filter scratch; using trie");
+        return false;
+    }
+
+    scratch.resize(ThreadConfig::get_instance_max(), nullptr);
+
+    for ( auto& ss : scratch )
+    {
+        if ( hs_clone_scratch(proto, &ss) != HS_SUCCESS )
+            ss = nullptr;
+    }
+
+    hs_free_scratch(proto);
+    return true;
+}
+
+static int hs_hit(unsigned, unsigned long long, unsigned long long, unsigned, void*)
+{ return 1; }
+
+bool SpellFilter::match(const uint8_t* data, unsigned len) const
+{
+    // when in doubt defer to the trie
+    hs_scratch_t* ss = scratch.empty() ? nullptr : scratch[get_instance_id()];
+
+    if ( !db or !ss or !len )
+        return true;
+
+    hs_error_t rc = hs_scan(db, (const char*)data, len, 0, ss, hs_hit, nullptr);
+    return rc != HS_SUCCESS;
+}
@@ -0,0 +1,57 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2018-2018 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// spell_filter.h
+
+#ifndef SPELL_FILTER_H
+#define SPELL_FILTER_H
+
+// SpellFilter is a hyperscan prefilter for a SpellBook.  It answers one
+// question for the first segment of a flow: could the trie produce any
+// page at all?  If not, the trie walk (and its wild card backtracking)
+// is skipped.  The trie remains authoritative for all positive results.
+
+#include <vector>
+
+#include "magic.h"
+
+struct hs_database;
+
+class SpellFilter
+{
+public:
+    SpellFilter() = default;
+    ~SpellFilter();
+
+    SpellFilter(const SpellFilter&) = delete;
+    SpellFilter& operator=(const SpellFilter&) = delete;
+
+    // returns false if the spells can't be usefully prefiltered
+    bool compile(const std::vector<HexVector>&);
+
+    // returns false only if the trie would return nullptr from page1
+    bool match(const uint8_t*, unsigned len) const;
+
+private:
+    struct hs_database* db = nullptr;
+
+    // cloned for each packet thread from a prototype sized for db so a
+    // reload that builds a new database also builds new scratch
+    std::vector<struct hs_scratch*> scratch;
+};
+
+#endif
@@ -25,6 +25,16 @@
 
 #include "magic.h"
 
+#ifdef HAVE_HYPERSCAN
+#include "spell_filter.h"
+#endif
+
+#if defined(UNIT_TEST) && defined(HAVE_HYPERSCAN)
+#include <cstring>
+
+#include "catch/snort_catch.h"
+#endif
+
 using namespace std;
 
 #define WILD 0x100
@@ -38,6 +48,13 @@ SpellBook::SpellBook()
     root->next[(int)'\n'] = root;
 }
 
+SpellBook::~SpellBook()
+{
+#ifdef HAVE_HYPERSCAN
+    delete filter;
+#endif
+}
+
 bool SpellBook::translate(const char* in, HexVector& out)
 {
     bool wild = false;
@@ -91,6 +108,8 @@ bool SpellBook::add_spell(const char* key, const char* val)
     if ( !translate(key, hv) )
         return false;
 
+    spells.push_back(hv);
+
     unsigned i = 0;
     MagicPage* p = root;
 
@@ -163,6 +182,15 @@ const char* SpellBook::find_spell(
     if ( len > max )
         len = max;
 
+#ifdef HAVE_HYPERSCAN
+    // a miss here means the trie can't match this flow at all
+    if ( filter and p == root and !filter->match(data, len) )
+    {
+        p = nullptr;
+        return nullptr;
+    }
+#endif
+
     p = find_spell(data, len, p, 0);
 
     if ( p and !p->value.empty() )
@@ -171,3 +199,85 @@ const char* SpellBook::find_spell(
     return nullptr;
 }
 
+
+bool SpellBook::compile()
+{
+#ifdef HAVE_HYPERSCAN
+    SpellFilter* f = new SpellFilter;
+
+    if ( f->compile(spells) )
+    {
+        delete filter;
+        filter = f;
+        return true;
+    }
+    delete f;
+#endif
+    return false;
+}
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#if defined(UNIT_TEST) && defined(HAVE_HYPERSCAN)
+
+static const char* s_spells[][2] =
+{
+    { "GET", "http" },
+    { "HTTP/", "http" },
+    { "SSH-", "ssh" },
+    { "220-*FTP", "ftp" },
+    { "220*SMTP", "smtp" },
+    { "+OK*POP", "pop3" },
+    { "  RFB *.*", "vnc" },
+};
+
+static const char* s_data[] =
+{
+    "", "\r\n", "G", "ge", "GET / HTTP/1.1", "  get /", "xGET", "POST /",
+    "HTTP/1.1 200 OK", "HTTP", "ht", "hello", "SSH-2.0-OpenSSH", "SSH", "ssh2",
+    "220", "220-", "220-welcome", "220-welcome to FTP", "220-welcome to ftp server",
+    "220 mail.example.com ESMTP", "220 ready", "221 bye", "+OK", "+OK dovecot",
+    "+OK POP3 server ready", "-ERR", "RFB 003.008", "rfb 003", "RFB", "RF 003.008",
+    "\t\tGET", "220-*FTP", "*", "ok",
+};
+
+TEST_CASE("spell filter matches trie", "[wizard]")
+{
+    SpellBook plain;
+    SpellBook filtered;
+
+    for ( const auto& s : s_spells )
+    {
+        plain.add_spell(s[0], s[1]);
+        filtered.add_spell(s[0], s[1]);
+    }
+    REQUIRE(filtered.compile());
+
+    for ( const char* d : s_data )
+    {
+        INFO(d);
+        const uint8_t* data = (const uint8_t*)d;
+        unsigned len = strlen(d);
+
+        const MagicPage* p = plain.page1();
+        const MagicPage* q = filtered.page1();
+
+        const char* a = plain.find_spell(data, len, p);
+        const char* b = filtered.find_spell(data, len, q);
+
+        // same service and the same choice to keep looking
+        CHECK(string(a ? a : "") == string(b ? b : ""));
+        CHECK((p == nullptr) == (q == nullptr));
+    }
+}
+
+TEST_CASE("spell filter declines leading wild card", "[wizard]")
+{
+    SpellBook book;
+    book.add_spell("*IMAP", "imap");
+    CHECK_FALSE(book.compile());
+}
+
+#endif
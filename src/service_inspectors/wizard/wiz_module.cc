@@ -24,6 +24,8 @@
 
 #include "wiz_module.h"
 
+#include "log/messages.h"
+
 #include "curses.h"
 #include "magic.h"
 
@@ -101,6 +103,9 @@ static const Parameter s_params[] =
     { "curses", Parameter::PT_MULTI, "dce_smb | dce_udp | dce_tcp", nullptr,
       "enable service identification based on internal algorithm" },
 
+    { "engine", Parameter::PT_SELECT, "trie | hyperscan", "trie",
+      "spell matcher; hyperscan rejects unknown flows with one scan" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -111,6 +116,7 @@ WizardModule::WizardModule() : Module(WIZ_NAME, WIZ_HELP, s_params)
     c2s_spells = nullptr;
     s2c_spells = nullptr;
     curses = nullptr;
+    hyperscan = false;
 }
 
 WizardModule::~WizardModule()
@@ -148,6 +154,9 @@ bool WizardModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("curses") )
         curses->add_curse(v.get_string());
 
+    else if ( v.is("engine") )
+        hyperscan = v.get_long() == 1;
+
     else
         return false;
 
@@ -165,6 +174,7 @@ bool WizardModule::begin(const char* fqn, int, SnortConfig*)
         s2c_spells = new SpellBook;
 
         curses = new CurseBook;
+        hyperscan = false;
     }
     else if ( !strcmp(fqn, "wizard.hexes") )
         hex = true;
@@ -195,6 +205,19 @@ void WizardModule::add_spells(MagicBook* b, string& service)
 
 bool WizardModule::end(const char* fqn, int idx, SnortConfig*)
 {
+    if ( !strcmp(fqn, "wizard") )
+    {
+        if ( hyperscan )
+        {
+#ifdef HAVE_HYPERSCAN
+            c2s_spells->compile();
+            s2c_spells->compile();
+#else
+            ParseWarning(WARN_CONF, "wizard: hyperscan engine not available; using trie");
+#endif
+        }
+        return true;
+    }
     if ( idx )
     {
         service.clear();
@@ -61,6 +61,7 @@ private:
 private:
     bool hex;
     bool c2s;
+    bool hyperscan;
     std::string service;
     std::vector<std::string> spells;
 
@@ -401,6 +401,14 @@ uint32_t sfrt_flat_usage(table_flat_t* table)
  * For performance reason, we use this simplified version instead of sfrt_lookup
  * Note: this only applied to table setting: DIR_8x16 (DIR_16_8_4x2 for IPV4), DIR_8x4*/
 GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table)
+{
+    int length;
+    return sfrt_flat_dir8x_lookup(ip, table, length);
+}
+
+/* As above but also sets length to the prefix length of the match in the form
+ * used by SfCidr::get_bits(), ie IPv4 lengths are offset by 96 */
+GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table, int& length)
 {
     dir_sub_table_flat_t* subtable;
     DIR_Entry* entry;
@@ -419,6 +427,7 @@ GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table)
         entry = (DIR_Entry*)(&base[subtable->entries]);
         if ( !entry[index].value || entry[index].length)
         {
+            length = 96 + entry[index].length;
             if (data[entry[index].value])
                 return (GENERIC)&base[data[entry[index].value]];
             else
@@ -431,6 +440,7 @@ GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table)
         entry = (DIR_Entry*)(&base[subtable->entries]);
         if ( !entry[index].value || entry[index].length)
         {
+            length = 96 + entry[index].length;
             if (data[entry[index].value])
                 return (GENERIC)&base[data[entry[index].value]];
             else
@@ -443,6 +453,7 @@ GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table)
         entry = (DIR_Entry*)(&base[subtable->entries]);
         if ( !entry[index].value || entry[index].length)
         {
+            length = 96 + entry[index].length;
             if (data[entry[index].value])
                 return (GENERIC)&base[data[entry[index].value]];
             else
@@ -455,6 +466,7 @@ GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table)
         entry = (DIR_Entry*)(&base[subtable->entries]);
         if ( !entry[index].value || entry[index].length)
         {
+            length = 96 + entry[index].length;
             if (data[entry[index].value])
                 return (GENERIC)&base[data[entry[index].value]];
             else
@@ -471,6 +483,7 @@ GENERIC sfrt_flat_dir8x_lookup(const SfIp* ip, table_flat_t* table)
             entry = (DIR_Entry*)(&base[subtable->entries]);
             if ( !entry[index].value || entry[index].length)
             {
+                length = entry[index].length;
                 if (data[entry[index].value])
                     return (GENERIC)&base[data[entry[index].value]];
                 else
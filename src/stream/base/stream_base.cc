@@ -22,6 +22,7 @@
 
 #include <functional>
 
+#include "flow/expect_cache.h"
 #include "flow/flow_control.h"
 #include "flow/prune_stats.h"
 #include "main/snort_config.h"
@@ -81,6 +82,12 @@ const PegInfo base_pegs[] =
     PROTO_PEGS("udp"),
     PROTO_PEGS("user"),
     PROTO_PEGS("file"),
+    { CountType::SUM, "expected_flows", "total expected flows created within snort" },
+    { CountType::SUM, "expected_realized", "number of expected flows realized" },
+    { CountType::SUM, "expected_pruned", "number of expected flows pruned" },
+    { CountType::SUM, "expected_overflows", "number of expected cache overflows" },
+    { CountType::SUM, "expected_exact_hits", "expected flows found by exact key" },
+    { CountType::SUM, "expected_wild_hits", "expected flows found by wild card port key" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -97,6 +104,16 @@ void base_sum()
     SET_PROTO_COUNTS(user, PDU);
     SET_PROTO_COUNTS(file, FILE);
 
+    if ( const ExpectCache* exp_cache = flow_con->get_exp_cache() )
+    {
+        stream_base_stats.expected_flows = exp_cache->get_expects();
+        stream_base_stats.expected_realized = exp_cache->get_realized();
+        stream_base_stats.expected_pruned = exp_cache->get_prunes();
+        stream_base_stats.expected_overflows = exp_cache->get_overflows();
+        stream_base_stats.expected_exact_hits = exp_cache->get_exact_hits();
+        stream_base_stats.expected_wild_hits = exp_cache->get_wild_hits();
+    }
+
     sum_stats((PegCount*)&g_stats, (PegCount*)&stream_base_stats,
         array_size(base_pegs)-1);
 }
@@ -273,15 +290,6 @@ void StreamBase::eval(Packet* p)
     };
 }
 
-#if 0
-// FIXIT-L add method to get exp cache?
-LogMessage("            Expected Flows\n");
-LogMessage("                  Expected: %lu\n", exp_cache->get_expects());
-LogMessage("                  Realized: %lu\n", exp_cache->get_realized());
-LogMessage("                    Pruned: %lu\n", exp_cache->get_prunes());
-LogMessage("                 Overflows: %lu\n", exp_cache->get_overflows());
-#endif
-
 //-------------------------------------------------------------------------
 // api stuff
 //-------------------------------------------------------------------------
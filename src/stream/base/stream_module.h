@@ -57,6 +57,12 @@ struct BaseStats
     PROTO_FIELDS(udp);
     PROTO_FIELDS(user);
     PROTO_FIELDS(file);
+    PegCount expected_flows;
+    PegCount expected_realized;
+    PegCount expected_pruned;
+    PegCount expected_overflows;
+    PegCount expected_exact_hits;
+    PegCount expected_wild_hits;
 };
 
 extern const PegInfo base_pegs[];
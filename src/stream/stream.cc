@@ -363,10 +363,17 @@ void Stream::timeout_flows(time_t cur_time)
     if ( !flow_con )
         return;
 
-    // FIXIT-M batch here or loop vs looping over idle?
     flow_con->timeout_flows(cur_time);
 }
 
+void Stream::idle_timeout_flows(time_t wall_time)
+{
+    if ( !flow_con )
+        return;
+
+    flow_con->idle_timeout_flows(wall_time);
+}
+
 void Stream::prune_flows()
 {
     if ( !flow_con )
@@ -73,6 +73,7 @@ public:
     static void purge_flows();
 
     static void timeout_flows(time_t cur_time);
+    static void idle_timeout_flows(time_t wall_time);
     static void prune_flows();
     static bool expected_flow(Flow*, Packet*);
     static Flow* new_flow(FlowKey*);
@@ -40,8 +40,8 @@ public:
     StreamTcp(TcpStreamConfig*);
     ~StreamTcp() override;
 
+    void apply(SnortConfig*) override;
     void show(SnortConfig*) override;
-    bool configure(SnortConfig*) override;
 
     void tinit() override;
     void tterm() override;
@@ -67,10 +67,9 @@ void StreamTcp::show(SnortConfig*)
     TcpStreamConfig::show_config(config);
 }
 
-bool StreamTcp::configure(SnortConfig* sc)
+void StreamTcp::apply(SnortConfig* sc)
 {
     sc->max_pdu = config->paf_max;
-    return true;
 }
 
 void StreamTcp::tinit()
@@ -158,6 +158,12 @@ static void timing_stats()
 
     uint64_t pps = (num_pkts / total_secs);
     LogMessage("%25.25s: " STDu64 "\n", "pkts/sec", pps);
+
+    PegCount num_bytes = ModuleManager::get_module("daq")->get_global_count("rx_bytes");
+    LogMessage("%25.25s: " STDu64 "\n", "bytes", num_bytes);
+
+    uint64_t mbps = (num_bytes * 8 / total_secs) / 1000000;
+    LogMessage("%25.25s: " STDu64 "\n", "Mbits/sec", mbps);
 }
 
 //-------------------------------------------------------------------------
@@ -29,6 +29,10 @@
 
 #include "main/thread.h"
 
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
 #define INVALID_HEX_VAL (-1)
 #define MAX_BUF 8
 #define NON_ASCII_CHAR 0xff
@@ -1251,14 +1255,15 @@ int JSNormalizeDecode(const char* src, uint16_t srclen, char* dst, uint16_t dest
     start = src;
     end = src + srclen;
 
-    s.fsm = 0;
+    // overwrite points into the previous destination buffer so it is never resumed
+    s.fsm = js->fsm;
     s.overwrite = nullptr;
     s.dest.data = dst;
     s.dest.size = destlen;
     s.dest.len = 0;
-    s.prev_event = 0;
+    s.prev_event = js->prev_event;
     s.unicode_map = iis_unicode_map;
-    s.num_spaces = 0;
+    s.num_spaces = js->num_spaces;
 
     while (!outBounds(start, end, *ptr))
     {
@@ -1275,6 +1280,22 @@ int JSNormalizeDecode(const char* src, uint16_t srclen, char* dst, uint16_t dest
         (*ptr)++;
     }
 
+    if (iRet == RET_QUIT)
+    {
+        // end of script tag seen, the next script starts from scratch
+        js->fsm = 0;
+        js->prev_event = 0;
+        js->num_spaces = 0;
+        js->script_open = false;
+    }
+    else
+    {
+        js->fsm = s.fsm;
+        js->prev_event = s.prev_event;
+        js->num_spaces = s.num_spaces;
+        js->script_open = true;
+    }
+
     //dst = s.dest.data; FIXIT-L dead store; should be?
     *bytes_copied = s.dest.len;
 
@@ -1330,3 +1351,58 @@ int main(int argc, char *argv[])
 
 }*/
 
+#ifdef UNIT_TEST
+static int js_norm_test(const char* src, char* dst, uint16_t dst_len, JSState& js,
+    const char** ptr)
+{
+    int bytes_copied = 0;
+    *ptr = src;
+    JSNormalizeDecode(src, strlen(src), dst, dst_len, ptr, &bytes_copied, &js, nullptr);
+    return bytes_copied;
+}
+
+TEST_CASE("js norm single buffer", "[jsnorm]")
+{
+    JSState js;
+    js.allowed_spaces = 0;
+    js.allowed_levels = MAX_ALLOWED_OBFUSCATION;
+    js.alerts = 0;
+
+    const char* src = ">var a  =  1;</script>tail";
+    char dst[64];
+    const char* ptr;
+    const int len = js_norm_test(src, dst, sizeof(dst), js, &ptr);
+
+    CHECK(std::string(dst, len) == ">var a = 1;</script>");
+    CHECK(std::string(ptr) == "tail");
+    CHECK(!js.script_open);
+    CHECK(js.fsm == 0);
+}
+
+TEST_CASE("js norm resumes across buffers", "[jsnorm]")
+{
+    JSState js;
+    js.allowed_spaces = 0;
+    js.allowed_levels = MAX_ALLOWED_OBFUSCATION;
+    js.alerts = 0;
+
+    char dst[64];
+    const char* ptr;
+
+    int len = js_norm_test(">var a  ", dst, sizeof(dst), js, &ptr);
+    CHECK(std::string(dst, len) == ">var a ");
+    CHECK(js.script_open);
+
+    // whitespace run and closing tag both straddle the buffer boundary
+    len = js_norm_test("  =  1;</scr", dst, sizeof(dst), js, &ptr);
+    CHECK(std::string(dst, len) == "= 1;</scr");
+    CHECK(js.script_open);
+
+    len = js_norm_test("ipt>tail", dst, sizeof(dst), js, &ptr);
+    CHECK(std::string(dst, len) == "ipt>");
+    CHECK(std::string(ptr) == "tail");
+    CHECK(!js.script_open);
+    CHECK(js.fsm == 0);
+}
+#endif
+
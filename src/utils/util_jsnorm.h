@@ -36,6 +36,18 @@ struct JSState
     int allowed_spaces;
     int allowed_levels;
     uint16_t alerts;
+
+    // scanner position carried from one call to the next so that a script
+    // split across several buffers is resumed rather than restarted
+    uint8_t fsm = 0;
+    uint8_t prev_event = 0;
+    uint16_t num_spaces = 0;
+    bool script_open = false;
+
+    // the start of a script tag cut off at the end of the last buffer, kept
+    // by callers that look for tags across buffers
+    uint16_t tag_len = 0;
+    char tag[256];
 };
 
 SO_PUBLIC int JSNormalizeDecode(